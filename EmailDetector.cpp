@@ -2,14 +2,28 @@
 #include <array>
 #include <atomic>
 #include <cassert>
+#include <cerrno>
 #include <chrono>
 #include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <new>
 #include <optional>
+#include <random>
+#include <regex>
 #include <shared_mutex>
+#include <sstream>
 #include <span>
 #include <stdexcept>
 #include <string>
@@ -18,6 +32,40 @@
 #include <unordered_set>
 #include <vector>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define EMAIL_DETECTOR_HAS_IO_URING 1
+#endif
+
+#ifdef EMAIL_DETECTOR_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef EMAIL_DETECTOR_WITH_ZSTD
+#include <zstd.h>
+#endif
+
 // ====================================================================================================
 // SECURITY & SAFETY MACROS (COMPILER & PLATFORM DETECTION)
 // ====================================================================================================
@@ -51,10 +99,18 @@ private:
         return counter;
     }
 
+    // Per-thread mirror of the global counter so services can attribute failures to a single call
+    static uint64_t &getThreadCounter() noexcept
+    {
+        thread_local uint64_t counter = 0;
+        return counter;
+    }
+
 public:
     static void recordError() noexcept
     {
         getCounter().fetch_add(1, std::memory_order_relaxed);
+        ++getThreadCounter();
     }
 
     static uint64_t getCount() noexcept
@@ -62,6 +118,11 @@ public:
         return getCounter().load(std::memory_order_relaxed);
     }
 
+    static uint64_t getThreadCount() noexcept
+    {
+        return getThreadCounter();
+    }
+
     static void reset() noexcept
     {
         getCounter().store(0, std::memory_order_relaxed);
@@ -134,6 +195,72 @@ public:
         }                                                            \
     } while (0)
 
+// ====================================================================================================
+// SCAN OUTCOME REPORTING
+// ====================================================================================================
+
+// Every guard that can stop a scan before the end of the input
+enum class ScanLimit : uint8_t
+{
+    NONE = 0,
+    TOTAL_OPERATIONS,
+    TOTAL_CHARS_SCANNED,
+    SCAN_ITERATIONS,
+    AT_SYMBOLS,
+    EMAILS_EXTRACT,
+    SEEN_SET_SIZE,
+    MEMORY_BUDGET,
+    COUNT
+};
+
+inline constexpr size_t SCAN_LIMIT_COUNT = static_cast<size_t>(ScanLimit::COUNT);
+
+[[nodiscard]] constexpr const char *scanLimitName(ScanLimit limit) noexcept
+{
+    switch (limit)
+    {
+    case ScanLimit::NONE:
+        return "none";
+    case ScanLimit::TOTAL_OPERATIONS:
+        return "MAX_TOTAL_OPERATIONS";
+    case ScanLimit::TOTAL_CHARS_SCANNED:
+        return "MAX_TOTAL_CHARS_SCANNED";
+    case ScanLimit::SCAN_ITERATIONS:
+        return "MAX_SCAN_ITERATIONS";
+    case ScanLimit::AT_SYMBOLS:
+        return "MAX_AT_SYMBOLS";
+    case ScanLimit::EMAILS_EXTRACT:
+        return "MAX_EMAILS_EXTRACT";
+    case ScanLimit::SEEN_SET_SIZE:
+        return "MAX_SEEN_SET_SIZE";
+    case ScanLimit::MEMORY_BUDGET:
+        return "MAX_MEMORY_BUDGET";
+    case ScanLimit::COUNT:
+        break;
+    }
+    return "unknown";
+}
+
+// Filled in by the scanner for a single contains()/extract() call
+struct ScanReport
+{
+    size_t bytesScanned = 0;
+    size_t emailsFound = 0;
+    bool rejectedOversize = false;
+    ScanLimit truncatedBy = ScanLimit::NONE;
+
+    [[nodiscard]] bool wasTruncated() const noexcept
+    {
+        return truncatedBy != ScanLimit::NONE;
+    }
+
+    void truncate(ScanLimit limit) noexcept
+    {
+        if (truncatedBy == ScanLimit::NONE)
+            truncatedBy = limit;
+    }
+};
+
 // ====================================================================================================
 // STATISTICS TRACKER
 // ====================================================================================================
@@ -144,7 +271,13 @@ private:
     mutable std::atomic<uint64_t> validationCount{0};
     mutable std::atomic<uint64_t> scanCount{0};
     mutable std::atomic<uint64_t> extractCount{0};
+    mutable std::atomic<uint64_t> matchCount{0};
+    mutable std::atomic<uint64_t> noMatchCount{0};
+    mutable std::atomic<uint64_t> oversizeCount{0};
     mutable std::atomic<uint64_t> errorCount{0};
+    mutable std::atomic<uint64_t> bytesScanned{0};
+    mutable std::atomic<uint64_t> emailsFound{0};
+    mutable std::array<std::atomic<uint64_t>, SCAN_LIMIT_COUNT> truncationCounts{};
 
 public:
     void recordValidation() noexcept
@@ -159,9 +292,53 @@ public:
     {
         extractCount.fetch_add(1, std::memory_order_relaxed);
     }
-    void recordError() noexcept
+    void recordMatch() noexcept
+    {
+        matchCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    void recordNoMatch() noexcept
+    {
+        noMatchCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    void recordOversize() noexcept
+    {
+        oversizeCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Internal consistency check failures (PRODUCTION_CHECK_* or unexpected exceptions)
+    void recordError(uint64_t count = 1) noexcept
+    {
+        errorCount.fetch_add(count, std::memory_order_relaxed);
+    }
+    void recordTruncation(ScanLimit limit) noexcept
+    {
+        if (limit == ScanLimit::NONE || limit == ScanLimit::COUNT)
+            return;
+        truncationCounts[static_cast<size_t>(limit)].fetch_add(1, std::memory_order_relaxed);
+    }
+    void recordBytesScanned(uint64_t bytes) noexcept
     {
-        errorCount.fetch_add(1, std::memory_order_relaxed);
+        bytesScanned.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    void recordEmailsFound(uint64_t count) noexcept
+    {
+        emailsFound.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void recordScanReport(const ScanReport &report) noexcept
+    {
+        if (report.rejectedOversize)
+            recordOversize();
+        else if (report.emailsFound > 0)
+            recordMatch();
+        else
+            recordNoMatch();
+
+        recordTruncation(report.truncatedBy);
+
+        if (report.bytesScanned > 0)
+            recordBytesScanned(report.bytesScanned);
+        if (report.emailsFound > 0)
+            recordEmailsFound(report.emailsFound);
     }
 
     [[nodiscard]] uint64_t getValidationCount() const noexcept
@@ -176,17 +353,50 @@ public:
     {
         return extractCount.load(std::memory_order_relaxed);
     }
+    [[nodiscard]] uint64_t getMatchCount() const noexcept
+    {
+        return matchCount.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t getNoMatchCount() const noexcept
+    {
+        return noMatchCount.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t getOversizeCount() const noexcept
+    {
+        return oversizeCount.load(std::memory_order_relaxed);
+    }
     [[nodiscard]] uint64_t getErrorCount() const noexcept
     {
         return errorCount.load(std::memory_order_relaxed);
     }
+    [[nodiscard]] uint64_t getTruncationCount(ScanLimit limit) const noexcept
+    {
+        if (limit == ScanLimit::NONE || limit == ScanLimit::COUNT)
+            return 0;
+        return truncationCounts[static_cast<size_t>(limit)].load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t getBytesScanned() const noexcept
+    {
+        return bytesScanned.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t getEmailsFound() const noexcept
+    {
+        return emailsFound.load(std::memory_order_relaxed);
+    }
 
     void reset() noexcept
     {
         validationCount.store(0, std::memory_order_relaxed);
         scanCount.store(0, std::memory_order_relaxed);
         extractCount.store(0, std::memory_order_relaxed);
+        matchCount.store(0, std::memory_order_relaxed);
+        noMatchCount.store(0, std::memory_order_relaxed);
+        oversizeCount.store(0, std::memory_order_relaxed);
         errorCount.store(0, std::memory_order_relaxed);
+        bytesScanned.store(0, std::memory_order_relaxed);
+        emailsFound.store(0, std::memory_order_relaxed);
+        for (auto &count : truncationCounts)
+            count.store(0, std::memory_order_relaxed);
     }
 
     struct StatsSnapshot
@@ -194,18 +404,53 @@ public:
         uint64_t validations;
         uint64_t scans;
         uint64_t extracts;
+        uint64_t matches;
+        uint64_t noMatches;
+        uint64_t oversize;
         uint64_t errors;
+        uint64_t bytesScanned;
+        uint64_t emailsFound;
+        std::array<uint64_t, SCAN_LIMIT_COUNT> truncations;
+
+        [[nodiscard]] uint64_t getOperationCount() const noexcept
+        {
+            return validations + scans + extracts;
+        }
 
         [[nodiscard]] double getErrorRate() const noexcept
         {
-            return validations > 0
-                       ? static_cast<double>(errors) / validations
+            const uint64_t operations = getOperationCount();
+            return operations > 0
+                       ? static_cast<double>(errors) / operations
+                       : 0.0;
+        }
+
+        [[nodiscard]] double getMatchRate() const noexcept
+        {
+            const uint64_t operations = getOperationCount();
+            return operations > 0
+                       ? static_cast<double>(matches) / operations
                        : 0.0;
         }
 
         [[nodiscard]] uint64_t getSuccessCount() const noexcept
         {
-            return validations > errors ? validations - errors : 0;
+            return matches;
+        }
+
+        [[nodiscard]] uint64_t getTruncationCount(ScanLimit limit) const noexcept
+        {
+            if (limit == ScanLimit::NONE || limit == ScanLimit::COUNT)
+                return 0;
+            return truncations[static_cast<size_t>(limit)];
+        }
+
+        [[nodiscard]] uint64_t getTotalTruncations() const noexcept
+        {
+            uint64_t total = 0;
+            for (uint64_t count : truncations)
+                total += count;
+            return total;
         }
 
         [[nodiscard]] bool hasErrors() const noexcept
@@ -216,11 +461,91 @@ public:
 
     [[nodiscard]] StatsSnapshot getSnapshot() const noexcept
     {
-        return {
+        StatsSnapshot snapshot{
             validationCount.load(std::memory_order_relaxed),
             scanCount.load(std::memory_order_relaxed),
             extractCount.load(std::memory_order_relaxed),
-            errorCount.load(std::memory_order_relaxed)};
+            matchCount.load(std::memory_order_relaxed),
+            noMatchCount.load(std::memory_order_relaxed),
+            oversizeCount.load(std::memory_order_relaxed),
+            errorCount.load(std::memory_order_relaxed),
+            bytesScanned.load(std::memory_order_relaxed),
+            emailsFound.load(std::memory_order_relaxed),
+            {}};
+
+        for (size_t i = 0; i < SCAN_LIMIT_COUNT; ++i)
+            snapshot.truncations[i] = truncationCounts[i].load(std::memory_order_relaxed);
+
+        return snapshot;
+    }
+};
+
+// Hit, miss and bypass counters of a cache shared by many threads, striped per thread rather than
+// per slot: the hottest entries are exactly the ones every thread reads, and one counter next to
+// them would turn each hit into a contended write.
+class CacheCounters
+{
+public:
+    static constexpr size_t STRIPES = 16;
+
+    struct Totals
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t bypassed = 0;
+    };
+
+private:
+    struct alignas(64) Stripe
+    {
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> bypassed{0};
+    };
+
+    std::array<Stripe, STRIPES> stripes_;
+
+    [[nodiscard]] Stripe &local() noexcept
+    {
+        static std::atomic<size_t> nextStripe{0};
+        thread_local const size_t stripe = nextStripe.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+        return stripes_[stripe];
+    }
+
+public:
+    void hit() noexcept
+    {
+        local().hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    void miss() noexcept
+    {
+        local().misses.fetch_add(1, std::memory_order_relaxed);
+    }
+    void bypass() noexcept
+    {
+        local().bypassed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] Totals getTotals() const noexcept
+    {
+        Totals totals;
+        for (const Stripe &stripe : stripes_)
+        {
+            totals.hits += stripe.hits.load(std::memory_order_relaxed);
+            totals.misses += stripe.misses.load(std::memory_order_relaxed);
+            totals.bypassed += stripe.bypassed.load(std::memory_order_relaxed);
+        }
+        return totals;
+    }
+
+    void reset() noexcept
+    {
+        for (Stripe &stripe : stripes_)
+        {
+            stripe.hits.store(0, std::memory_order_relaxed);
+            stripe.misses.store(0, std::memory_order_relaxed);
+            stripe.bypassed.store(0, std::memory_order_relaxed);
+        }
     }
 };
 
@@ -321,6 +646,146 @@ public:
     {
         return c >= 33 && c <= 126 && c != '\\' && c != '"';
     }
+
+    [[nodiscard]] static FORCE_INLINE int popcount32(uint32_t x) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcount(x);
+#else
+        int count = 0;
+        for (; x != 0; x &= x - 1)
+            ++count;
+        return count;
+#endif
+    }
+
+    [[nodiscard]] static FORCE_INLINE int countTrailingZeros64(uint64_t x) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(x);
+#else
+        int count = 0;
+        for (; (x & 1) == 0; x >>= 1)
+            ++count;
+        return count;
+#endif
+    }
+
+    [[nodiscard]] static FORCE_INLINE int countLeadingZeros64(uint64_t x) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(x);
+#else
+        int count = 0;
+        for (; (x & (uint64_t{1} << 63)) == 0; x <<= 1)
+            ++count;
+        return count;
+#endif
+    }
+
+    // Printable ASCII plus tab and line breaks: the bytes strings(1) would keep
+    [[nodiscard]] static FORCE_INLINE bool isPrintableText(unsigned char c) noexcept
+    {
+        return (c >= 32 && c <= 126) || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    // Bit i of printable: data[i] is printable text (isPrintableText); bit i of at: data[i] is '@'.
+    // Reads 64 bytes.
+    static void textMasks64(const char *data, uint64_t &printable, uint64_t &at) noexcept
+    {
+        printable = 0;
+        at = 0;
+#if defined(__AVX2__)
+        for (size_t half = 0; half < 2; ++half)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + 32 * half));
+            // Signed compares: bytes >= 0x80 are negative and fall outside ' '..'~'
+            const __m256i visible = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(31)),
+                                                     _mm256_cmpgt_epi8(_mm256_set1_epi8(127), v));
+            const __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')),
+                                                  _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                                                                  _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+            printable |= uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(visible, space)))}
+                         << (32 * half);
+            at |= uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('@'))))}
+                  << (32 * half);
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        for (size_t quarter = 0; quarter < 4; ++quarter)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16 * quarter));
+            // Signed compares: bytes >= 0x80 are negative and fall outside ' '..'~'
+            const __m128i visible = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(31)),
+                                                  _mm_cmplt_epi8(v, _mm_set1_epi8(127)));
+            const __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')),
+                                               _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                                                            _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+            printable |= uint64_t{static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(visible, space)))}
+                         << (16 * quarter);
+            at |= uint64_t{static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('@'))))}
+                  << (16 * quarter);
+        }
+#else
+        for (size_t i = 0; i < 64; ++i)
+        {
+            const auto c = static_cast<unsigned char>(data[i]);
+            printable |= uint64_t{isPrintableText(c)} << i;
+            at |= uint64_t{c == '@'} << i;
+        }
+#endif
+    }
+
+    // Number of bytes in [data, data + len) that charTable marks CHAR_INVALID_LOCAL: around a fifth
+    // of prose or log text, two thirds of random binary. The set is everything outside '!'..'~'
+    // plus the twelve specials " ( ) , : ; < > @ [ \\ ], which the SIMD paths test directly.
+    [[nodiscard]] static size_t countInvalidLocal(const char *data, size_t len) noexcept
+    {
+        size_t count = 0;
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        // Nibble lookup: a byte is in the set when the bits for its low and high nibble overlap.
+        // Bit 0 is "every low nibble" for high nibbles 0, 1 and 8-F; bits 1-5 hold the specials
+        // and DEL for high nibbles 2, 3, 4, 5 and 7.
+        const __m256i lowTable = _mm256_setr_epi8(
+            0x0B, 0x01, 0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x03, 0x03, 0x05, 0x15, 0x17, 0x11, 0x05, 0x21,
+            0x0B, 0x01, 0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x03, 0x03, 0x05, 0x15, 0x17, 0x11, 0x05, 0x21);
+        const __m256i highTable = _mm256_setr_epi8(
+            0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x20, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+            0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x20, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01);
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+        for (; i + 32 <= len; i += 32)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            const __m256i low = _mm256_shuffle_epi8(lowTable, _mm256_and_si256(v, nibble));
+            const __m256i high = _mm256_shuffle_epi8(highTable, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+            const __m256i valid = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256());
+            count += 32 - static_cast<size_t>(popcount32(static_cast<uint32_t>(_mm256_movemask_epi8(valid))));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128i space = _mm_set1_epi8(32);
+        const __m128i del = _mm_set1_epi8(127);
+        const __m128i specials[] = {
+            _mm_set1_epi8('"'), _mm_set1_epi8('('), _mm_set1_epi8(')'), _mm_set1_epi8(','),
+            _mm_set1_epi8(':'), _mm_set1_epi8(';'), _mm_set1_epi8('<'), _mm_set1_epi8('>'),
+            _mm_set1_epi8('@'), _mm_set1_epi8('['), _mm_set1_epi8('\\'), _mm_set1_epi8(']')};
+        for (; i + 16 <= len; i += 16)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            // Signed compares: bytes >= 0x80 are negative and fall outside '!'..'~'
+            __m128i special = _mm_setzero_si128();
+            for (const __m128i &c : specials)
+                special = _mm_or_si128(special, _mm_cmpeq_epi8(v, c));
+            const __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(v, space), _mm_cmplt_epi8(v, del));
+            const __m128i valid = _mm_andnot_si128(special, printable);
+            count += 16 - static_cast<size_t>(popcount32(static_cast<uint32_t>(_mm_movemask_epi8(valid))));
+        }
+#endif
+
+        for (; i < len; ++i)
+            count += isInvalidLocalChar(static_cast<unsigned char>(data[i])) ? 1 : 0;
+        return count;
+    }
 };
 
 // ====================================================================================================
@@ -819,1098 +1284,9491 @@ public:
 };
 
 // ====================================================================================================
-// EMAIL VALIDATOR (Open/Closed Principle - extensible through composition)
+// DOMAIN VALIDATION CACHE (Direct-mapped seqlock memo of DomainPartValidator results)
 // ====================================================================================================
 
-class EmailValidator final
+// Most matches in real traffic share a few thousand domains, so the label checks of
+// DomainPartValidator::validate mostly recompute answers already known. This cache keeps the
+// latest result per slot, keyed by the domain bytes themselves (a slot is picked by their hash and
+// confirmed by comparing all of them), so a hit returns exactly what validation would. Valid and
+// invalid results are both kept. One entry is one cache line; readers take no lock and a writer
+// claims an entry by moving its version from even to odd, skipping the store if another writer
+// holds it.
+class DomainValidationCache final
 {
-private:
-    static constexpr size_t MIN_EMAIL_SIZE = 5;
-    static constexpr size_t MAX_EMAIL_SIZE = 320;
-
 public:
-    [[nodiscard]] static bool isValid(std::string_view email) noexcept
+    // Longer domains are validated directly and counted as bypassed
+    static constexpr size_t MAX_CACHED_LENGTH = 56;
+
+    struct Stats
     {
-        try
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t bypassed = 0;
+        size_t capacity = 0;
+
+        [[nodiscard]] double getHitRate() const noexcept
         {
-            const size_t len = email.length();
+            const uint64_t lookups = hits + misses + bypassed;
+            return lookups > 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+        }
+    };
 
-            if (UNLIKELY(len < MIN_EMAIL_SIZE || len > MAX_EMAIL_SIZE))
-                return false;
+private:
+    static constexpr size_t ENTRY_WORDS = MAX_CACHED_LENGTH / 8;
 
-            if (UNLIKELY(email.data() == nullptr))
-                return false;
+    struct alignas(64) CacheEntry
+    {
+        std::atomic<uint32_t> version{0};
+        // length << 1 | valid; 0 while the entry is empty
+        std::atomic<uint32_t> state{0};
+        std::array<std::atomic<uint64_t>, ENTRY_WORDS> words{};
+    };
+    static_assert(sizeof(CacheEntry) == 64, "one entry per cache line");
 
-            size_t atPos = SIZE_MAX;
-            bool inQuotes = false;
-            bool escaped = false;
+    std::unique_ptr<CacheEntry[]> entries_;
+    size_t mask_;
+    CacheCounters counters_;
 
-            const char *data = email.data();
-            for (size_t i = 0; i < len; ++i)
-            {
-                PRODUCTION_CHECK_BOOL(i < len, "EmailValidator loop bounds");
-                char c = data[i];
+public:
+    // entries is rounded up to a power of two; a few thousand cover the hot domains of most traffic
+    explicit DomainValidationCache(size_t entries = 4096)
+    {
+        size_t capacity = 1;
+        while (capacity < entries)
+            capacity <<= 1;
+        entries_ = std::make_unique<CacheEntry[]>(capacity);
+        mask_ = capacity - 1;
+    }
 
-                if (escaped)
-                {
-                    escaped = false;
-                    continue;
-                }
+    DomainValidationCache(const DomainValidationCache &) = delete;
+    DomainValidationCache &operator=(const DomainValidationCache &) = delete;
 
-                if (c == '\\' && inQuotes)
-                {
-                    escaped = true;
-                    continue;
-                }
+    // Same result as DomainPartValidator::validate(domain, 0, domain.size())
+    [[nodiscard]] bool validate(std::string_view domain) noexcept
+    {
+        if (domain.empty() || domain.size() > MAX_CACHED_LENGTH)
+        {
+            counters_.bypass();
+            return DomainPartValidator::validate(domain, 0, domain.size());
+        }
 
-                if (c == '"')
-                {
-                    inQuotes = !inQuotes;
-                    continue;
-                }
+        uint64_t key[ENTRY_WORDS] = {};
+        std::memcpy(key, domain.data(), domain.size());
+        const size_t words = (domain.size() + 7) / 8;
 
-                if (c == '@' && !inQuotes)
-                {
-                    if (UNLIKELY(atPos != SIZE_MAX))
-                        return false;
-                    atPos = i;
-                }
-            }
+        uint64_t h = domain.size() * 0x9e3779b97f4a7c15ULL;
+        for (size_t w = 0; w < words; ++w)
+        {
+            h = (h ^ key[w]) * 0xff51afd7ed558ccdULL;
+            h = (h << 31) | (h >> 33);
+        }
+        CacheEntry &entry = entries_[(h ^ (h >> 29)) & mask_];
 
-            if (UNLIKELY(atPos == SIZE_MAX || atPos == 0 || atPos >= len - 1))
-                return false;
+        const uint32_t before = entry.version.load(std::memory_order_acquire);
+        const uint32_t state = entry.state.load(std::memory_order_relaxed);
+        if ((before & 1) == 0 && (state >> 1) == domain.size())
+        {
+            bool same = true;
+            for (size_t w = 0; w < words; ++w)
+                same &= entry.words[w].load(std::memory_order_relaxed) == key[w];
 
-            return LocalPartValidator::validate(email, 0, atPos,
-                                                LocalPartValidator::ValidationMode::EXACT) &&
-                   DomainPartValidator::validate(email, atPos + 1, len);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (same && entry.version.load(std::memory_order_relaxed) == before)
+            {
+                counters_.hit();
+                return (state & 1) != 0;
+            }
         }
-        catch (...)
+
+        const bool valid = DomainPartValidator::validate(domain, 0, domain.size());
+        counters_.miss();
+
+        uint32_t version = before;
+        if ((version & 1) == 0 &&
+            entry.version.compare_exchange_strong(version, version + 1, std::memory_order_relaxed))
         {
-            return false;
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t w = 0; w < ENTRY_WORDS; ++w)
+                entry.words[w].store(key[w], std::memory_order_relaxed);
+            entry.state.store(static_cast<uint32_t>(domain.size() << 1) | (valid ? 1u : 0u),
+                              std::memory_order_relaxed);
+            entry.version.store(version + 2, std::memory_order_release);
         }
+        return valid;
+    }
+
+    [[nodiscard]] Stats getStats() const noexcept
+    {
+        const CacheCounters::Totals totals = counters_.getTotals();
+        Stats stats;
+        stats.hits = totals.hits;
+        stats.misses = totals.misses;
+        stats.bypassed = totals.bypassed;
+        stats.capacity = mask_ + 1;
+        return stats;
+    }
+
+    // Zeroes the counters, keeping the cached results
+    void resetStats() noexcept
+    {
+        counters_.reset();
     }
 };
 
 // ====================================================================================================
-// EMAIL VALIDATION SERVICE (With Statistics)
+// TLD TABLE (Compile-time perfect hash of the root zone, for ScanOptions::strictTld)
 // ====================================================================================================
 
-class EmailValidationService final
+// Hash-and-displace perfect hash over a fixed list of lowercase names, built by the compiler: the
+// first hash picks a bucket, the bucket's displacement and the second hash pick a slot, and no two
+// names share a slot. TldTable is its only user.
+struct TldPerfectHash
 {
-private:
-    ValidationStats stats_;
-
-public:
-    EmailValidationService() = default;
-
-    EmailValidationService(const EmailValidationService &) = delete;
-    EmailValidationService &operator=(const EmailValidationService &) = delete;
+    // About three names per bucket and a slot array at most three-quarters full keep displacements small
+    static constexpr size_t BUCKETS = 512;
+    static constexpr size_t SLOTS = 2048;
+    static constexpr uint16_t EMPTY = 0xffff;
+    static constexpr uint32_t SLOT_SEED = 0x5bd1e995u;
 
-    EmailValidationService(EmailValidationService &&) noexcept = default;
-    EmailValidationService &operator=(EmailValidationService &&) noexcept = default;
-
-    [[nodiscard]] bool validate(std::string_view email) noexcept
+    [[nodiscard]] static constexpr unsigned char lower(char c) noexcept
     {
-        stats_.recordValidation();
-
-        bool result = EmailValidator::isValid(email);
-
-        if (!result)
-            stats_.recordError();
-
-        return result;
+        const auto byte = static_cast<unsigned char>(c);
+        return static_cast<unsigned char>(byte - 'A') < 26 ? static_cast<unsigned char>(byte | 0x20) : byte;
     }
 
-    [[nodiscard]] const ValidationStats &getStats() const noexcept
+    // FNV-1a over the lowercased bytes, seeded for the second of the two hashes
+    [[nodiscard]] static constexpr uint32_t hash(const char *data, size_t len, uint32_t seed) noexcept
     {
-        return stats_;
+        uint32_t h = 2166136261u ^ seed;
+        for (size_t i = 0; i < len; ++i)
+            h = (h ^ lower(data[i])) * 16777619u;
+        return h;
     }
 
-    void resetStats() noexcept
+    [[nodiscard]] static constexpr size_t slotOf(uint32_t h2, uint16_t displacement) noexcept
     {
-        stats_.reset();
+        uint32_t x = h2 ^ (displacement * 0x9e3779b9u);
+        x ^= x >> 16;
+        x *= 0x85ebca6bu;
+        x ^= x >> 13;
+        return x & (SLOTS - 1);
     }
-};
-
-// ====================================================================================================
-// EMAIL SCANNER WITH HEURISTIC EXTRACTION - STATELESS (Pure Functions)
-// ====================================================================================================
-
-class EmailScanner final
-{
-private:
-    static constexpr size_t MAX_INPUT_SIZE = 10 * 1024 * 1024;
-    static constexpr size_t MAX_LEFT_SCAN = 4096;
-    static constexpr size_t MAX_EMAILS_EXTRACT = 10000;
-    static constexpr size_t MAX_BACKTRACK_PER_AT = 330;
-    static constexpr size_t MAX_BACKWARD_SCAN_CHARS = 200;
-    static constexpr size_t MAX_QUOTE_SCAN = 100;
-    static constexpr size_t MAX_MEMORY_BUDGET = 5 * 1024 * 1024;
-    static constexpr size_t MAX_INITIAL_RESERVE = 100;
-    static constexpr size_t MAX_AT_SYMBOLS = 1000;
-    static constexpr size_t MAX_SEEN_SET_SIZE = 5000;
-    static constexpr size_t MAX_TOTAL_OPERATIONS = 100'000'000;
 
-    struct EmailBoundaries
+    struct Tables
     {
-        size_t start;
-        size_t end;
-        bool validBoundaries;
-        size_t skipTo;
-        bool didTrimDomain;
+        uint16_t displacement[BUCKETS]{};
+        uint16_t slot[SLOTS]{};
     };
 
-    struct OperationBatcher
+    // Buckets are placed largest first, each with the smallest displacement that sends all of its
+    // names to free, distinct slots
+    template <size_t COUNT>
+    [[nodiscard]] static constexpr Tables build(const std::string_view (&names)[COUNT]) noexcept
     {
-        size_t local_count = 0;
-        static constexpr size_t BATCH_SIZE = 1000;
+        static_assert(COUNT < EMPTY && COUNT * 4 <= SLOTS * 3, "grow BUCKETS and SLOTS with the list");
 
-        inline void recordOperation(std::atomic<size_t> &counter) noexcept
+        Tables tables{};
+        for (size_t s = 0; s < SLOTS; ++s)
+            tables.slot[s] = EMPTY;
+
+        uint32_t h2[COUNT]{};
+        uint16_t bucketOf[COUNT]{};
+        uint16_t bucketSize[BUCKETS]{};
+        for (size_t i = 0; i < COUNT; ++i)
         {
-            if (++local_count >= BATCH_SIZE)
-            {
-                counter.fetch_add(BATCH_SIZE, std::memory_order_relaxed);
-                local_count = 0;
-            }
+            bucketOf[i] = static_cast<uint16_t>(hash(names[i].data(), names[i].size(), 0) & (BUCKETS - 1));
+            h2[i] = hash(names[i].data(), names[i].size(), SLOT_SEED);
+            ++bucketSize[bucketOf[i]];
         }
 
-        inline bool checkLimit(std::atomic<size_t> &counter, size_t max_ops) noexcept
+        // Names grouped by bucket (counting sort)
+        uint16_t first[BUCKETS + 1]{};
+        for (size_t b = 0; b < BUCKETS; ++b)
+            first[b + 1] = static_cast<uint16_t>(first[b] + bucketSize[b]);
+        uint16_t members[COUNT]{};
+        uint16_t filled[BUCKETS]{};
+        for (size_t i = 0; i < COUNT; ++i)
+            members[first[bucketOf[i]] + filled[bucketOf[i]]++] = static_cast<uint16_t>(i);
+
+        uint16_t largest = 0;
+        for (size_t b = 0; b < BUCKETS; ++b)
+            largest = bucketSize[b] > largest ? bucketSize[b] : largest;
+
+        for (uint16_t size = largest; size > 0; --size)
         {
-            recordOperation(counter);
-            return counter.load(std::memory_order_relaxed) > max_ops;
+            for (size_t b = 0; b < BUCKETS; ++b)
+            {
+                if (bucketSize[b] != size)
+                    continue;
+
+                for (uint16_t d = 0;; ++d)
+                {
+                    bool fits = true;
+                    for (size_t m = first[b]; m < first[b + 1] && fits; ++m)
+                    {
+                        const size_t s = slotOf(h2[members[m]], d);
+                        fits = tables.slot[s] == EMPTY;
+                        for (size_t other = first[b]; other < m && fits; ++other)
+                            fits = slotOf(h2[members[other]], d) != s;
+                    }
+                    if (!fits)
+                        continue;
+
+                    tables.displacement[b] = d;
+                    for (size_t m = first[b]; m < first[b + 1]; ++m)
+                        tables.slot[slotOf(h2[members[m]], d)] = members[m];
+                    break;
+                }
+            }
         }
+        return tables;
+    }
+};
+
+// Every top-level domain delegated in the root zone, lowercase, IDN TLDs in their xn-- form. Taken
+// from the ICANN section of the Public Suffix List (single-label entries); refresh it when the root
+// zone changes. A new TLD is one more string in NAMES: the compiler rebuilds the perfect hash.
+class TldTable
+{
+public:
+    static constexpr size_t MAX_TLD_LENGTH = 24;
+
+private:
+    static constexpr std::string_view NAMES[] = {
+        "aaa", "aarp", "abarth", "abb", "abbott", "abbvie", "abc", "able", "abogado", "abudhabi", "ac",
+        "academy", "accenture", "accountant", "accountants", "aco", "actor", "ad", "ads", "adult", "ae",
+        "aeg", "aero", "aetna", "af", "afl", "africa", "ag", "agakhan", "agency", "ai", "aig", "airbus",
+        "airforce", "airtel", "akdn", "al", "alfaromeo", "alibaba", "alipay", "allfinanz", "allstate", "ally",
+        "alsace", "alstom", "am", "amazon", "americanexpress", "americanfamily", "amex", "amfam", "amica",
+        "amsterdam", "analytics", "android", "anquan", "anz", "ao", "aol", "apartments", "app", "apple", "aq",
+        "aquarelle", "ar", "arab", "aramco", "archi", "army", "arpa", "art", "arte", "as", "asda", "asia",
+        "associates", "at", "athleta", "attorney", "au", "auction", "audi", "audible", "audio", "auspost",
+        "author", "auto", "autos", "avianca", "aw", "aws", "ax", "axa", "az", "azure", "ba", "baby", "baidu",
+        "banamex", "bananarepublic", "band", "bank", "bar", "barcelona", "barclaycard", "barclays",
+        "barefoot", "bargains", "baseball", "basketball", "bauhaus", "bayern", "bb", "bbc", "bbt", "bbva",
+        "bcg", "bcn", "be", "beats", "beauty", "beer", "bentley", "berlin", "best", "bestbuy", "bet", "bf",
+        "bg", "bh", "bharti", "bi", "bible", "bid", "bike", "bing", "bingo", "bio", "biz", "bj", "black",
+        "blackfriday", "blockbuster", "blog", "bloomberg", "blue", "bm", "bms", "bmw", "bn", "bnpparibas",
+        "bo", "boats", "boehringer", "bofa", "bom", "bond", "boo", "book", "booking", "bosch", "bostik",
+        "boston", "bot", "boutique", "box", "br", "bradesco", "bridgestone", "broadway", "broker", "brother",
+        "brussels", "bs", "bt", "build", "builders", "business", "buy", "buzz", "bv", "bw", "by", "bz", "bzh",
+        "ca", "cab", "cafe", "cal", "call", "calvinklein", "cam", "camera", "camp", "canon", "capetown",
+        "capital", "capitalone", "car", "caravan", "cards", "care", "career", "careers", "cars", "casa",
+        "case", "cash", "casino", "cat", "catering", "catholic", "cba", "cbn", "cbre", "cbs", "cc", "cd",
+        "center", "ceo", "cern", "cf", "cfa", "cfd", "cg", "ch", "chanel", "channel", "charity", "chase",
+        "chat", "cheap", "chintai", "christmas", "chrome", "church", "ci", "cipriani", "circle", "cisco",
+        "citadel", "citi", "citic", "city", "cityeats", "cl", "claims", "cleaning", "click", "clinic",
+        "clinique", "clothing", "cloud", "club", "clubmed", "cm", "cn", "co", "coach", "codes", "coffee",
+        "college", "cologne", "com", "comcast", "commbank", "community", "company", "compare", "computer",
+        "comsec", "condos", "construction", "consulting", "contact", "contractors", "cooking",
+        "cookingchannel", "cool", "coop", "corsica", "country", "coupon", "coupons", "courses", "cpa", "cr",
+        "credit", "creditcard", "creditunion", "cricket", "crown", "crs", "cruise", "cruises", "cu",
+        "cuisinella", "cv", "cw", "cx", "cy", "cymru", "cyou", "cz", "dabur", "dad", "dance", "data", "date",
+        "dating", "datsun", "day", "dclk", "dds", "de", "deal", "dealer", "deals", "degree", "delivery",
+        "dell", "deloitte", "delta", "democrat", "dental", "dentist", "desi", "design", "dev", "dhl",
+        "diamonds", "diet", "digital", "direct", "directory", "discount", "discover", "dish", "diy", "dj",
+        "dk", "dm", "dnp", "do", "docs", "doctor", "dog", "domains", "dot", "download", "drive", "dtv",
+        "dubai", "dunlop", "dupont", "durban", "dvag", "dvr", "dz", "earth", "eat", "ec", "eco", "edeka",
+        "edu", "education", "ee", "eg", "email", "emerck", "energy", "engineer", "engineering", "enterprises",
+        "epson", "equipment", "ericsson", "erni", "es", "esq", "estate", "et", "etisalat", "eu", "eurovision",
+        "eus", "events", "exchange", "expert", "exposed", "express", "extraspace", "fage", "fail",
+        "fairwinds", "faith", "family", "fan", "fans", "farm", "farmers", "fashion", "fast", "fedex",
+        "feedback", "ferrari", "ferrero", "fi", "fiat", "fidelity", "fido", "film", "final", "finance",
+        "financial", "fire", "firestone", "firmdale", "fish", "fishing", "fit", "fitness", "fj", "flickr",
+        "flights", "flir", "florist", "flowers", "fly", "fm", "fo", "foo", "food", "foodnetwork", "football",
+        "ford", "forex", "forsale", "forum", "foundation", "fox", "fr", "free", "fresenius", "frl", "frogans",
+        "frontdoor", "frontier", "ftr", "fujitsu", "fun", "fund", "furniture", "futbol", "fyi", "ga", "gal",
+        "gallery", "gallo", "gallup", "game", "games", "gap", "garden", "gay", "gb", "gbiz", "gd", "gdn",
+        "ge", "gea", "gent", "genting", "george", "gf", "gg", "ggee", "gh", "gi", "gift", "gifts", "gives",
+        "giving", "gl", "glass", "gle", "global", "globo", "gm", "gmail", "gmbh", "gmo", "gmx", "gn",
+        "godaddy", "gold", "goldpoint", "golf", "goo", "goodyear", "goog", "google", "gop", "got", "gov",
+        "gp", "gq", "gr", "grainger", "graphics", "gratis", "green", "gripe", "grocery", "group", "gs", "gt",
+        "gu", "guardian", "gucci", "guge", "guide", "guitars", "guru", "gw", "gy", "hair", "hamburg",
+        "hangout", "haus", "hbo", "hdfc", "hdfcbank", "health", "healthcare", "help", "helsinki", "here",
+        "hermes", "hgtv", "hiphop", "hisamitsu", "hitachi", "hiv", "hk", "hkt", "hm", "hn", "hockey",
+        "holdings", "holiday", "homedepot", "homegoods", "homes", "homesense", "honda", "horse", "hospital",
+        "host", "hosting", "hot", "hoteles", "hotels", "hotmail", "house", "how", "hr", "hsbc", "ht", "hu",
+        "hughes", "hyatt", "hyundai", "ibm", "icbc", "ice", "icu", "id", "ie", "ieee", "ifm", "ikano", "il",
+        "im", "imamat", "imdb", "immo", "immobilien", "in", "inc", "industries", "infiniti", "info", "ing",
+        "ink", "institute", "insurance", "insure", "int", "international", "intuit", "investments", "io",
+        "ipiranga", "iq", "ir", "irish", "is", "ismaili", "ist", "istanbul", "it", "itau", "itv", "jaguar",
+        "java", "jcb", "je", "jeep", "jetzt", "jewelry", "jio", "jll", "jmp", "jnj", "jo", "jobs", "joburg",
+        "jot", "joy", "jp", "jpmorgan", "jprs", "juegos", "juniper", "kaufen", "kddi", "ke", "kerryhotels",
+        "kerrylogistics", "kerryproperties", "kfh", "kg", "ki", "kia", "kids", "kim", "kinder", "kindle",
+        "kitchen", "kiwi", "km", "kn", "koeln", "komatsu", "kosher", "kp", "kpmg", "kpn", "kr", "krd", "kred",
+        "kuokgroup", "kw", "ky", "kyoto", "kz", "la", "lacaixa", "lamborghini", "lamer", "lancaster",
+        "lancia", "land", "landrover", "lanxess", "lasalle", "lat", "latino", "latrobe", "law", "lawyer",
+        "lb", "lc", "lds", "lease", "leclerc", "lefrak", "legal", "lego", "lexus", "lgbt", "li", "lidl",
+        "life", "lifeinsurance", "lifestyle", "lighting", "like", "lilly", "limited", "limo", "lincoln",
+        "linde", "link", "lipsy", "live", "living", "lk", "llc", "llp", "loan", "loans", "locker", "locus",
+        "lol", "london", "lotte", "lotto", "love", "lpl", "lplfinancial", "lr", "ls", "lt", "ltd", "ltda",
+        "lu", "lundbeck", "luxe", "luxury", "lv", "ly", "ma", "macys", "madrid", "maif", "maison", "makeup",
+        "man", "management", "mango", "map", "market", "marketing", "markets", "marriott", "marshalls",
+        "maserati", "mattel", "mba", "mc", "mckinsey", "md", "me", "med", "media", "meet", "melbourne",
+        "meme", "memorial", "men", "menu", "merckmsd", "mg", "mh", "miami", "microsoft", "mil", "mini",
+        "mint", "mit", "mitsubishi", "mk", "ml", "mlb", "mls", "mma", "mn", "mo", "mobi", "mobile", "moda",
+        "moe", "moi", "mom", "monash", "money", "monster", "mormon", "mortgage", "moscow", "moto",
+        "motorcycles", "mov", "movie", "mp", "mq", "mr", "ms", "msd", "mt", "mtn", "mtr", "mu", "museum",
+        "music", "mutual", "mv", "mw", "mx", "my", "mz", "na", "nab", "nagoya", "name", "natura", "navy",
+        "nba", "nc", "ne", "nec", "net", "netbank", "netflix", "network", "neustar", "new", "news", "next",
+        "nextdirect", "nexus", "nf", "nfl", "ng", "ngo", "nhk", "ni", "nico", "nike", "nikon", "ninja",
+        "nissan", "nissay", "nl", "no", "nokia", "northwesternmutual", "norton", "now", "nowruz", "nowtv",
+        "nr", "nra", "nrw", "ntt", "nu", "nyc", "nz", "obi", "observer", "office", "okinawa", "olayan",
+        "olayangroup", "oldnavy", "ollo", "om", "omega", "one", "ong", "onion", "onl", "online", "ooo",
+        "open", "oracle", "orange", "org", "organic", "origins", "osaka", "otsuka", "ott", "ovh", "pa",
+        "page", "panasonic", "paris", "pars", "partners", "parts", "party", "passagens", "pay", "pccw", "pe",
+        "pet", "pf", "pfizer", "ph", "pharmacy", "phd", "philips", "phone", "photo", "photography", "photos",
+        "physio", "pics", "pictet", "pictures", "pid", "pin", "ping", "pink", "pioneer", "pizza", "pk", "pl",
+        "place", "play", "playstation", "plumbing", "plus", "pm", "pn", "pnc", "pohl", "poker", "politie",
+        "porn", "post", "pr", "pramerica", "praxi", "press", "prime", "pro", "prod", "productions", "prof",
+        "progressive", "promo", "properties", "property", "protection", "pru", "prudential", "ps", "pt",
+        "pub", "pw", "pwc", "py", "qa", "qpon", "quebec", "quest", "racing", "radio", "re", "read",
+        "realestate", "realtor", "realty", "recipes", "red", "redstone", "redumbrella", "rehab", "reise",
+        "reisen", "reit", "reliance", "ren", "rent", "rentals", "repair", "report", "republican", "rest",
+        "restaurant", "review", "reviews", "rexroth", "rich", "richardli", "ricoh", "ril", "rio", "rip", "ro",
+        "rocher", "rocks", "rodeo", "rogers", "room", "rs", "rsvp", "ru", "rugby", "ruhr", "run", "rw", "rwe",
+        "ryukyu", "sa", "saarland", "safe", "safety", "sakura", "sale", "salon", "samsclub", "samsung",
+        "sandvik", "sandvikcoromant", "sanofi", "sap", "sarl", "sas", "save", "saxo", "sb", "sbi", "sbs",
+        "sc", "sca", "scb", "schaeffler", "schmidt", "scholarships", "school", "schule", "schwarz", "science",
+        "scot", "sd", "se", "search", "seat", "secure", "security", "seek", "select", "sener", "services",
+        "seven", "sew", "sex", "sexy", "sfr", "sg", "sh", "shangrila", "sharp", "shaw", "shell", "shia",
+        "shiksha", "shoes", "shop", "shopping", "shouji", "show", "showtime", "si", "silk", "sina", "singles",
+        "site", "sj", "sk", "ski", "skin", "sky", "skype", "sl", "sling", "sm", "smart", "smile", "sn",
+        "sncf", "so", "soccer", "social", "softbank", "software", "sohu", "solar", "solutions", "song",
+        "sony", "soy", "spa", "space", "sport", "spot", "sr", "srl", "ss", "st", "stada", "staples", "star",
+        "statebank", "statefarm", "stc", "stcgroup", "stockholm", "storage", "store", "stream", "studio",
+        "study", "style", "su", "sucks", "supplies", "supply", "support", "surf", "surgery", "suzuki", "sv",
+        "swatch", "swiss", "sx", "sy", "sydney", "systems", "sz", "tab", "taipei", "talk", "taobao", "target",
+        "tatamotors", "tatar", "tattoo", "tax", "taxi", "tc", "tci", "td", "tdk", "team", "tech",
+        "technology", "tel", "temasek", "tennis", "teva", "tf", "tg", "th", "thd", "theater", "theatre",
+        "tiaa", "tickets", "tienda", "tiffany", "tips", "tires", "tirol", "tj", "tjmaxx", "tjx", "tk",
+        "tkmaxx", "tl", "tm", "tmall", "tn", "to", "today", "tokyo", "tools", "top", "toray", "toshiba",
+        "total", "tours", "town", "toyota", "toys", "tr", "trade", "trading", "training", "travel",
+        "travelchannel", "travelers", "travelersinsurance", "trust", "trv", "tt", "tube", "tui", "tunes",
+        "tushu", "tv", "tvs", "tw", "tz", "ua", "ubank", "ubs", "ug", "uk", "unicom", "university", "uno",
+        "uol", "ups", "us", "uy", "uz", "va", "vacations", "vana", "vanguard", "vc", "ve", "vegas",
+        "ventures", "verisign", "versicherung", "vet", "vg", "vi", "viajes", "video", "vig", "viking",
+        "villas", "vin", "vip", "virgin", "visa", "vision", "viva", "vivo", "vlaanderen", "vn", "vodka",
+        "volkswagen", "volvo", "vote", "voting", "voto", "voyage", "vu", "vuelos", "wales", "walmart",
+        "walter", "wang", "wanggou", "watch", "watches", "weather", "weatherchannel", "webcam", "weber",
+        "website", "wedding", "weibo", "weir", "wf", "whoswho", "wien", "wiki", "williamhill", "win",
+        "windows", "wine", "winners", "wme", "wolterskluwer", "woodside", "work", "works", "world", "wow",
+        "ws", "wtc", "wtf", "xbox", "xerox", "xfinity", "xihuan", "xin", "xn--11b4c3d", "xn--1ck2e1b",
+        "xn--1qqw23a", "xn--2scrj9c", "xn--30rr7y", "xn--3bst00m", "xn--3ds443g", "xn--3e0b707e",
+        "xn--3hcrj9c", "xn--3pxu8k", "xn--42c2d9a", "xn--45br5cyl", "xn--45brj9c", "xn--45q11c",
+        "xn--4dbrk0ce", "xn--4gbrim", "xn--54b7fta0cc", "xn--55qw42g", "xn--55qx5d", "xn--5su34j936bgsg",
+        "xn--5tzm5g", "xn--6frz82g", "xn--6qq986b3xl", "xn--80adxhks", "xn--80ao21a", "xn--80aqecdr1a",
+        "xn--80asehdb", "xn--80aswg", "xn--8y0a063a", "xn--90a3ac", "xn--90ae", "xn--90ais", "xn--9dbq2a",
+        "xn--9et52u", "xn--9krt00a", "xn--b4w605ferd", "xn--bck1b9a5dre4c", "xn--c1avg", "xn--c2br7g",
+        "xn--cck2b3b", "xn--cckwcxetd", "xn--cg4bki", "xn--clchc0ea0b2g2a9gcd", "xn--czr694b", "xn--czrs0t",
+        "xn--czru2d", "xn--d1acj3b", "xn--d1alf", "xn--e1a4c", "xn--eckvdtc9d", "xn--efvy88h", "xn--fct429k",
+        "xn--fhbei", "xn--fiq228c5hs", "xn--fiq64b", "xn--fiqs8s", "xn--fiqz9s", "xn--fjq720a", "xn--flw351e",
+        "xn--fpcrj9c3d", "xn--fzc2c9e2c", "xn--fzys8d69uvgm", "xn--g2xx48c", "xn--gckr3f0f", "xn--gecrj9c",
+        "xn--gk3at1e", "xn--h2breg3eve", "xn--h2brj9c", "xn--h2brj9c8c", "xn--hxt814e", "xn--i1b6b1a6a2e",
+        "xn--imr513n", "xn--io0a7i", "xn--j1aef", "xn--j1amh", "xn--j6w193g", "xn--jlq480n2rg", "xn--jvr189m",
+        "xn--kcrx77d1x4a", "xn--kprw13d", "xn--kpry57d", "xn--kput3i", "xn--l1acc", "xn--lgbbat1ad8j",
+        "xn--mgb2ddes", "xn--mgb9awbf", "xn--mgba3a3ejt", "xn--mgba3a4f16a", "xn--mgba3a4fra",
+        "xn--mgba7c0bbn0a", "xn--mgbaakc7dvf", "xn--mgbaam7a8h", "xn--mgbab2bd", "xn--mgbah1a3hjkrd",
+        "xn--mgbai9a5eva00b", "xn--mgbai9azgqp6j", "xn--mgbayh7gpa", "xn--mgbbh1a", "xn--mgbbh1a71e",
+        "xn--mgbc0a9azcg", "xn--mgbca7dzdo", "xn--mgbcpq6gpa1a", "xn--mgberp4a5d4a87g", "xn--mgberp4a5d4ar",
+        "xn--mgbgu82a", "xn--mgbi4ecexp", "xn--mgbpl2fh", "xn--mgbqly7c0a67fbc", "xn--mgbqly7cvafr",
+        "xn--mgbt3dhd", "xn--mgbtf8fl", "xn--mgbtx2b", "xn--mgbx4cd0ab", "xn--mix082f", "xn--mix891f",
+        "xn--mk1bu44c", "xn--mxtq1m", "xn--ngbc5azd", "xn--ngbe9e0a", "xn--ngbrx", "xn--nnx388a", "xn--node",
+        "xn--nqv7f", "xn--nqv7fs00ema", "xn--nyqy26a", "xn--o3cw4h", "xn--ogbpf8fl", "xn--otu796d",
+        "xn--p1acf", "xn--p1ai", "xn--pgbs0dh", "xn--pssy2u", "xn--q7ce6a", "xn--q9jyb4c", "xn--qcka1pmc",
+        "xn--qxa6a", "xn--qxam", "xn--rhqv96g", "xn--rovu88b", "xn--rvc1e0am3e", "xn--s9brj9c", "xn--ses554g",
+        "xn--t60b56a", "xn--tckwe", "xn--tiq49xqyj", "xn--unup4y", "xn--vermgensberater-ctb",
+        "xn--vermgensberatung-pwb", "xn--vhquv", "xn--vuq861b", "xn--w4r85el8fhu5dnra", "xn--w4rs40l",
+        "xn--wgbh1c", "xn--wgbl6a", "xn--xhq521b", "xn--xkc2al3hye2a", "xn--xkc2dl3a5ee0h", "xn--y9a3aq",
+        "xn--yfro4i67o", "xn--ygbi2ammx", "xn--zfr164b", "xxx", "xyz", "yachts", "yahoo", "yamaxun", "yandex",
+        "ye", "yodobashi", "yoga", "yokohama", "you", "youtube", "yt", "yun", "zappos", "zara", "zero", "zip",
+        "zm", "zone", "zuerich", "zw",
     };
 
-    [[nodiscard]] static FORCE_INLINE size_t findFirstAlnum(const char *data, size_t dataLen,
-                                                            size_t pos, size_t limit) noexcept
+    static constexpr size_t COUNT = sizeof(NAMES) / sizeof(NAMES[0]);
+    static constexpr TldPerfectHash::Tables TABLES = TldPerfectHash::build(NAMES);
+
+    // One bucket read, one slot read and one compare against the only name that can match
+    [[nodiscard]] static bool lookup(const char *data, size_t len) noexcept
     {
-        limit = std::min(limit, dataLen);
+        if (len == 0 || len > MAX_TLD_LENGTH)
+            return false;
 
-        while (pos < limit)
+        const uint32_t bucket = TldPerfectHash::hash(data, len, 0) & (TldPerfectHash::BUCKETS - 1);
+        const uint16_t index = TABLES.slot[TldPerfectHash::slotOf(TldPerfectHash::hash(data, len, TldPerfectHash::SLOT_SEED),
+                                                                  TABLES.displacement[bucket])];
+        if (index == TldPerfectHash::EMPTY || NAMES[index].size() != len)
+            return false;
+
+        for (size_t i = 0; i < len; ++i)
         {
-            PRODUCTION_CHECK_BOOL(pos < dataLen, "findFirstAlnum bounds");
-            unsigned char uc = static_cast<unsigned char>(data[pos]);
-            if (CharacterClassifier::isAlphaNum(uc))
-                return pos;
-            ++pos;
+            if (TldPerfectHash::lower(data[i]) != static_cast<unsigned char>(NAMES[index][i]))
+                return false;
         }
-        return SIZE_MAX;
+        return true;
     }
 
-    [[nodiscard]] static FORCE_INLINE size_t findFirstAtext(const char *data, size_t dataLen,
-                                                            size_t pos, size_t limit) noexcept
+public:
+    // Case-insensitive; tld without the leading dot
+    [[nodiscard]] static bool contains(std::string_view tld) noexcept
     {
-        limit = std::min(limit, dataLen);
+        return lookup(tld.data(), tld.size());
+    }
 
-        while (pos < limit)
-        {
-            PRODUCTION_CHECK_BOOL(pos < dataLen, "findFirstAtext bounds");
-            unsigned char uc = static_cast<unsigned char>(data[pos]);
-            if (LIKELY(CharacterClassifier::isAtext(uc)))
-                return pos;
-            ++pos;
-        }
-        return SIZE_MAX;
+    // Whether data[start, end) ends in a dot and a known TLD; reads at most MAX_TLD_LENGTH + 1 bytes
+    [[nodiscard]] static bool hasKnownTld(const char *data, size_t start, size_t end) noexcept
+    {
+        size_t dot = end;
+        while (dot > start && end - dot <= MAX_TLD_LENGTH && data[dot - 1] != '.')
+            --dot;
+        if (dot <= start || data[dot - 1] != '.')
+            return false;
+        return lookup(data + dot, end - dot);
     }
 
-    [[nodiscard]] static inline std::optional<size_t> safe_memchr_index(
-        const char *data, size_t start, size_t len, char ch) noexcept
+    [[nodiscard]] static constexpr size_t size() noexcept
     {
-        if (start >= len || !data)
-            return std::nullopt;
+        return COUNT;
+    }
+};
 
-        const char *ptr = static_cast<const char *>(
-            std::memchr(data + start, ch, len - start));
+// ====================================================================================================
+// EMAIL VALIDATOR (Open/Closed Principle - extensible through composition)
+// ====================================================================================================
 
-        if (!ptr)
-            return std::nullopt;
+class EmailValidator final
+{
+private:
+    static constexpr size_t MIN_EMAIL_SIZE = 5;
+    static constexpr size_t MAX_EMAIL_SIZE = 320;
 
-        if (ptr < data || ptr >= data + len)
-            return std::nullopt;
+public:
+    [[nodiscard]] static bool isValid(std::string_view email) noexcept
+    {
+        try
+        {
+            const size_t len = email.length();
 
-        return static_cast<size_t>(ptr - data);
+            if (UNLIKELY(len < MIN_EMAIL_SIZE || len > MAX_EMAIL_SIZE))
+                return false;
+
+            if (UNLIKELY(email.data() == nullptr))
+                return false;
+
+            size_t atPos = SIZE_MAX;
+            bool inQuotes = false;
+            bool escaped = false;
+
+            const char *data = email.data();
+            for (size_t i = 0; i < len; ++i)
+            {
+                PRODUCTION_CHECK_BOOL(i < len, "EmailValidator loop bounds");
+                char c = data[i];
+
+                if (escaped)
+                {
+                    escaped = false;
+                    continue;
+                }
+
+                if (c == '\\' && inQuotes)
+                {
+                    escaped = true;
+                    continue;
+                }
+
+                if (c == '"')
+                {
+                    inQuotes = !inQuotes;
+                    continue;
+                }
+
+                if (c == '@' && !inQuotes)
+                {
+                    if (UNLIKELY(atPos != SIZE_MAX))
+                        return false;
+                    atPos = i;
+                }
+            }
+
+            if (UNLIKELY(atPos == SIZE_MAX || atPos == 0 || atPos >= len - 1))
+                return false;
+
+            return LocalPartValidator::validate(email, 0, atPos,
+                                                LocalPartValidator::ValidationMode::EXACT) &&
+                   DomainPartValidator::validate(email, atPos + 1, len);
+        }
+        catch (...)
+        {
+            return false;
+        }
     }
+};
 
-    [[nodiscard]] static EmailBoundaries findEmailBoundaries(std::string_view text, size_t atPos,
-                                                             size_t minScannedIndex,
-                                                             std::atomic<size_t> &opCounter,
-                                                             OperationBatcher &batcher) noexcept
+// ====================================================================================================
+// VALIDATION RESULT CACHE (Set-associative CLOCK cache of isValid results, lock-free reads)
+// ====================================================================================================
+
+// Remembers EmailValidator::isValid results for addresses seen before. Only a 64-bit fingerprint of
+// each address is kept (a seeded hash of its bytes, one bit traded for the result), so the cache
+// holds no address text and a wrong answer needs a 63-bit collision under a seed chosen at random
+// per cache. The bucket comes from a separate hash lane, so sharing a bucket costs none of those
+// bits. Fingerprints live in 7-way buckets of one cache line; a lookup reads one line without
+// locking. A miss stores its result under the lock of the bucket's shard, taken with try_lock so a
+// busy shard skips the store rather than wait, and a full bucket evicts by CLOCK: a hit marks its
+// way referenced, and the hand clears marks until it reaches an unmarked way. New entries start
+// unmarked, so addresses seen once leave before the ones that repeat.
+//
+// A hit is five to eight times faster than isValid at any length, while a miss adds the hash and the
+// store (17-30 ns); the cache pays off above a hit rate of about 40%, nearer 50% for addresses
+// shorter than 16 bytes, which are therefore validated directly by default. Quoted local parts and
+// IP literals are cached at any length.
+class ValidationResultCache final
+{
+public:
+    static constexpr size_t WAYS = 7;
+    static constexpr size_t SHARDS = 16;
+    static constexpr size_t MAX_CACHED_LENGTH = 320;
+    static constexpr size_t DEFAULT_MIN_LENGTH = 16;
+
+    struct Stats
     {
-        const size_t len = text.length();
-        const char *data = text.data();
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t bypassed = 0;
+        uint64_t evictions = 0;
+        size_t capacity = 0;
 
-        if (batcher.checkLimit(opCounter, MAX_TOTAL_OPERATIONS))
+        [[nodiscard]] double getHitRate() const noexcept
         {
-            return {atPos, atPos, false, atPos, false};
+            const uint64_t lookups = hits + misses + bypassed;
+            return lookups > 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
         }
+    };
 
-        if (atPos >= len) [[unlikely]]
-            return {atPos, atPos, false, atPos, false};
+private:
+    struct alignas(64) Bucket
+    {
+        // fingerprint with the low bit replaced by the result; 0 while the way is empty
+        std::array<std::atomic<uint64_t>, WAYS> tags{};
+        std::atomic<uint8_t> referenced{0};
+        // next way the CLOCK hand inspects; only touched under the shard lock
+        uint8_t hand = 0;
+    };
+    static_assert(sizeof(Bucket) == 64, "one bucket per cache line");
 
-        size_t end = atPos + 1;
+    struct alignas(64) Shard
+    {
+        std::mutex mutex;
+    };
 
-        if (end < len && data[end] == '[') [[unlikely]]
+    std::unique_ptr<Bucket[]> buckets_;
+    size_t mask_;
+    size_t minLength_;
+    uint64_t seed_;
+    std::array<Shard, SHARDS> shards_;
+    CacheCounters counters_;
+    std::atomic<uint64_t> evictions_{0};
+
+    struct Fingerprint
+    {
+        uint64_t tag;
+        uint64_t bucket;
+    };
+
+    // Two lanes over the same words: one gives the tag, the other picks the bucket, so entries that
+    // share a bucket still differ in all 63 tag bits. The second multiply runs alongside the first.
+    [[nodiscard]] Fingerprint fingerprint(std::string_view email) const noexcept
+    {
+        const auto *bytes = reinterpret_cast<const unsigned char *>(email.data());
+        const size_t len = email.size();
+
+        uint64_t h = seed_ ^ (len * 0x9e3779b97f4a7c15ULL);
+        uint64_t b = ~seed_ ^ (len * 0xd6e8feb86659fd93ULL);
+        for (size_t i = 0; i + 8 <= len; i += 8)
         {
-            return {atPos, atPos, false, atPos + 1, false};
+            uint64_t word;
+            std::memcpy(&word, bytes + i, 8);
+            h = (h ^ word) * 0xff51afd7ed558ccdULL;
+            h = (h << 31) | (h >> 33);
+            b = (b ^ word) * 0x9fb21c651e98df25ULL;
+            b = (b << 27) | (b >> 37);
         }
+        // The last word overlaps the previous one rather than being copied byte by byte
+        uint64_t tail = 0;
+        if (len >= 8)
+            std::memcpy(&tail, bytes + len - 8, 8);
+        else
+            for (size_t k = 0; k < len; ++k)
+                tail |= uint64_t{bytes[k]} << (8 * k);
+        h = (h ^ tail) * 0xc4ceb9fe1a85ec53ULL;
+        b = (b ^ tail) * 0xff51afd7ed558ccdULL;
+
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        b ^= b >> 32;
+        return {h, b};
+    }
 
-        static constexpr size_t MAX_DOMAIN_PART = 255;
-        static constexpr size_t MAX_LABEL_LENGTH = 63;
-        size_t domain_chars = 0;
-        bool didTrimDomain = false;
-        size_t current_label_length = 0;
+    void store(Bucket &bucket, size_t index, uint64_t tag) noexcept
+    {
+        std::unique_lock<std::mutex> lock(shards_[index % SHARDS].mutex, std::try_to_lock);
+        if (!lock.owns_lock())
+            return;
 
-        while (end < len && CharacterClassifier::isDomainChar(static_cast<unsigned char>(data[end])))
+        size_t way = WAYS;
+        for (size_t w = 0; w < WAYS; ++w)
         {
-            if (domain_chars >= MAX_DOMAIN_PART)
-            {
-                end = atPos + 1 + MAX_DOMAIN_PART;
-                didTrimDomain = true;
-                break;
-            }
+            const uint64_t current = bucket.tags[w].load(std::memory_order_relaxed);
+            if ((current | 1) == (tag | 1))
+                return;
+            if (current == 0 && way == WAYS)
+                way = w;
+        }
 
-            if (data[end] == '.')
-            {
-                current_label_length = 0;
-            }
-            else
+        if (way == WAYS)
+        {
+            size_t hand = bucket.hand;
+            while ((bucket.referenced.load(std::memory_order_relaxed) >> hand) & 1)
             {
-                ++current_label_length;
-                if (current_label_length > MAX_LABEL_LENGTH)
-                {
-                    didTrimDomain = true;
-                }
+                bucket.referenced.fetch_and(static_cast<uint8_t>(~(1u << hand)), std::memory_order_relaxed);
+                hand = (hand + 1) % WAYS;
             }
+            way = hand;
+            bucket.hand = static_cast<uint8_t>((hand + 1) % WAYS);
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
 
-            ++end;
-            ++domain_chars;
+        bucket.referenced.fetch_and(static_cast<uint8_t>(~(1u << way)), std::memory_order_relaxed);
+        bucket.tags[way].store(tag, std::memory_order_relaxed);
+    }
 
-            batcher.recordOperation(opCounter);
-            if (opCounter.load(std::memory_order_relaxed) > MAX_TOTAL_OPERATIONS) [[unlikely]]
-            {
-                return {atPos, atPos, false, atPos, false};
-            }
-        }
+public:
+    // entries is rounded up to a power-of-two number of buckets
+    explicit ValidationResultCache(size_t entries = 65536, size_t minLength = DEFAULT_MIN_LENGTH)
+        : minLength_(minLength), seed_((uint64_t{std::random_device{}()} << 32) ^ std::random_device{}())
+    {
+        size_t buckets = 1;
+        while (buckets * WAYS < entries)
+            buckets <<= 1;
+        buckets_ = std::make_unique<Bucket[]>(buckets);
+        mask_ = buckets - 1;
+    }
 
-        while (end > atPos + 1 && data[end - 1] == '.')
+    ValidationResultCache(const ValidationResultCache &) = delete;
+    ValidationResultCache &operator=(const ValidationResultCache &) = delete;
+
+    // Same result as EmailValidator::isValid(email)
+    [[nodiscard]] bool isValid(std::string_view email) noexcept
+    {
+        const size_t len = email.size();
+        const bool slowForm = len > 0 && (email.front() == '"' || email.back() == ']');
+        if ((len < minLength_ && !slowForm) || len > MAX_CACHED_LENGTH || email.data() == nullptr)
         {
-            PRODUCTION_CHECK_BOUNDARIES(end > 0 && end - 1 < len, "findEmailBoundaries trailing dot removal", atPos);
-            --end;
+            counters_.bypass();
+            return EmailValidator::isValid(email);
         }
 
-        if (end < len && data[end] == '@')
+        const Fingerprint fp = fingerprint(email);
+        const size_t index = static_cast<size_t>(fp.bucket) & mask_;
+        Bucket &bucket = buckets_[index];
+        const uint64_t key = (fp.tag & ~uint64_t{1}) == 0 ? 2 : fp.tag & ~uint64_t{1};
+
+        for (size_t w = 0; w < WAYS; ++w)
         {
-            while (end > atPos + 1 && data[end - 1] == '-')
+            const uint64_t tag = bucket.tags[w].load(std::memory_order_relaxed);
+            if ((tag | 1) == (key | 1))
             {
-                PRODUCTION_CHECK_BOUNDARIES(end > 0 && end - 1 < len, "findEmailBoundaries hyphen removal", atPos);
-                --end;
+                const auto bit = static_cast<uint8_t>(1u << w);
+                if ((bucket.referenced.load(std::memory_order_relaxed) & bit) == 0)
+                    bucket.referenced.fetch_or(bit, std::memory_order_relaxed);
+                counters_.hit();
+                return (tag & 1) != 0;
             }
         }
 
-        size_t absoluteMin = safe_subtract(atPos, MAX_LEFT_SCAN);
+        const bool valid = EmailValidator::isValid(email);
+        counters_.miss();
+        store(bucket, index, key | (valid ? 1 : 0));
+        return valid;
+    }
 
-        if (atPos > 0 && (data[atPos - 1] == '"' || data[atPos - 1] == '\'' || data[atPos - 1] == '`'))
+    [[nodiscard]] size_t getMinLength() const noexcept
+    {
+        return minLength_;
+    }
+
+    [[nodiscard]] Stats getStats() const noexcept
+    {
+        const CacheCounters::Totals totals = counters_.getTotals();
+        Stats stats;
+        stats.hits = totals.hits;
+        stats.misses = totals.misses;
+        stats.bypassed = totals.bypassed;
+        stats.evictions = evictions_.load(std::memory_order_relaxed);
+        stats.capacity = (mask_ + 1) * WAYS;
+        return stats;
+    }
+
+    // Zeroes the counters, keeping the cached results
+    void resetStats() noexcept
+    {
+        counters_.reset();
+        evictions_.store(0, std::memory_order_relaxed);
+    }
+};
+
+// ====================================================================================================
+// EMAIL VALIDATION SERVICE (With Statistics)
+// ====================================================================================================
+
+class EmailValidationService final
+{
+private:
+    ValidationStats stats_;
+    // Optional, and may be shared with other services
+    std::shared_ptr<ValidationResultCache> cache_;
+
+public:
+    EmailValidationService() = default;
+
+    explicit EmailValidationService(std::shared_ptr<ValidationResultCache> cache) : cache_(std::move(cache))
+    {
+    }
+
+    EmailValidationService(const EmailValidationService &) = delete;
+    EmailValidationService &operator=(const EmailValidationService &) = delete;
+
+    EmailValidationService(EmailValidationService &&) noexcept = default;
+    EmailValidationService &operator=(EmailValidationService &&) noexcept = default;
+
+    [[nodiscard]] bool validate(std::string_view email) noexcept
+    {
+        stats_.recordValidation();
+
+        const uint64_t checkFailuresBefore = ThreadSafeErrorCounter::getThreadCount();
+        bool result = cache_ ? cache_->isValid(email) : EmailValidator::isValid(email);
+        const uint64_t checkFailures = ThreadSafeErrorCounter::getThreadCount() - checkFailuresBefore;
+
+        if (UNLIKELY(checkFailures > 0))
+            stats_.recordError(checkFailures);
+
+        if (result)
+            stats_.recordMatch();
+        else
+            stats_.recordNoMatch();
+
+        return result;
+    }
+
+    [[nodiscard]] const ValidationStats &getStats() const noexcept
+    {
+        return stats_;
+    }
+
+    void resetStats() noexcept
+    {
+        stats_.reset();
+    }
+
+    [[nodiscard]] const ValidationResultCache *getCache() const noexcept
+    {
+        return cache_.get();
+    }
+};
+
+// ====================================================================================================
+// EMAIL PSEUDONYMIZER (Keyed SipHash-2-4, per-tenant key, optional shared cache)
+// ====================================================================================================
+
+// 128-bit secret of one tenant: under one key an address always maps to the same pseudonym, and
+// without the key pseudonyms can be neither reversed nor recomputed from a list of candidates
+struct PseudonymKey
+{
+    uint64_t k0 = 0;
+    uint64_t k1 = 0;
+
+    // 32 hex digits for the 16 key bytes, in the byte order of the SipHash reference key
+    [[nodiscard]] static PseudonymKey fromHex(std::string_view hex)
+    {
+        if (hex.size() != 32)
+            throw std::invalid_argument("pseudonym key must be 32 hex digits");
+
+        PseudonymKey key;
+        for (size_t i = 0; i < 16; ++i)
+        {
+            uint64_t byte = 0;
+            for (size_t j = 0; j < 2; ++j)
+            {
+                const auto c = static_cast<unsigned char>(hex[2 * i + j]);
+                if (!CharacterClassifier::isHexDigit(c))
+                    throw std::invalid_argument("pseudonym key must be 32 hex digits");
+                byte = byte * 16 + static_cast<uint64_t>(c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+            }
+            (i < 8 ? key.k0 : key.k1) |= byte << (8 * (i % 8));
+        }
+        return key;
+    }
+};
+
+class EmailPseudonymizer final
+{
+public:
+    static constexpr size_t CACHE_SHARDS = 16;
+    // Longer addresses are always hashed; the bound keeps a cache entry at 80 bytes
+    static constexpr size_t MAX_CACHED_LENGTH = 64;
+
+    struct CacheStats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t capacity = 0;
+    };
+
+private:
+    static constexpr size_t ENTRY_WORDS = MAX_CACHED_LENGTH / 8;
+
+    // Direct-mapped slot under a seqlock: a new address replaces whatever shared its slot, so the
+    // cache keeps the most recent address per slot with no eviction list. Readers take no lock;
+    // the version is odd while a writer fills the slot, and a reader that sees it change retries
+    // as a miss. Addresses are stored as zero-padded little-endian words.
+    struct CacheEntry
+    {
+        std::atomic<uint32_t> version{0};
+        std::atomic<uint32_t> length{0};
+        std::atomic<uint64_t> digest{0};
+        std::array<std::atomic<uint64_t>, ENTRY_WORDS> words{};
+    };
+
+    // Writers of the slots that map to a shard take its lock; the counters are per shard too
+    struct alignas(64) CacheShard
+    {
+        std::mutex writer;
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+    };
+
+    PseudonymKey key_;
+    std::string prefix_;
+    std::unique_ptr<CacheEntry[]> entries_;
+    std::unique_ptr<CacheShard[]> shards_;
+    size_t entryCount_ = 0;
+
+    [[nodiscard]] static FORCE_INLINE uint64_t wordAt(std::string_view email, size_t word) noexcept
+    {
+        const auto *bytes = reinterpret_cast<const unsigned char *>(email.data()) + 8 * word;
+        const size_t count = std::min<size_t>(email.size() - 8 * word, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if (count == 8)
+        {
+            uint64_t value;
+            std::memcpy(&value, bytes, 8);
+            return value;
+        }
+#endif
+        return loadLittleEndian(bytes, count);
+    }
+
+    // Slot selector, not a security boundary: one multiply-mix per 8-byte word, far cheaper than SipHash.
+    // Every word counts, since addresses often share long prefixes and suffixes.
+    [[nodiscard]] static uint64_t slotHash(std::string_view email) noexcept
+    {
+        uint64_t h = email.size() * 0x9e3779b97f4a7c15ULL;
+        const size_t words = (email.size() + 7) / 8;
+        for (size_t w = 0; w < words; ++w)
+            h = rotl((h ^ wordAt(email, w)) * 0xff51afd7ed558ccdULL, 31);
+        return h ^ (h >> 29);
+    }
+
+    [[nodiscard]] static FORCE_INLINE uint64_t rotl(uint64_t x, int bits) noexcept
+    {
+        return (x << bits) | (x >> (64 - bits));
+    }
+
+    [[nodiscard]] static FORCE_INLINE uint64_t loadLittleEndian(const unsigned char *bytes, size_t count) noexcept
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < count; ++i)
+            value |= uint64_t{bytes[i]} << (8 * i);
+        return value;
+    }
+
+    // ASCII-lowercases the bytes of x selected by the 0x80 bits of lanes, eight at a time
+    [[nodiscard]] static FORCE_INLINE uint64_t foldUpper(uint64_t x, uint64_t lanes) noexcept
+    {
+        constexpr uint64_t ONES = 0x0101010101010101ULL;
+        const uint64_t low = x & (0x7f * ONES);
+        const uint64_t atLeastA = low + (0x80 - 'A') * ONES;
+        const uint64_t aboveZ = low + (0x80 - 'Z' - 1) * ONES;
+        const uint64_t upper = (atLeastA ^ aboveZ) & ~x & lanes;
+        return x | (upper >> 2);
+    }
+
+    // Little-endian load of count bytes starting at index i, ASCII-lowercasing indices from lowerFrom on
+    [[nodiscard]] static FORCE_INLINE uint64_t loadFolded(const unsigned char *bytes, size_t i, size_t count,
+                                                          size_t lowerFrom) noexcept
+    {
+        uint64_t value = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if (count == 8)
+            std::memcpy(&value, bytes + i, 8);
+        else
+#endif
+            value = loadLittleEndian(bytes + i, count);
+
+        if (i + count <= lowerFrom)
+            return value;
+        const size_t skip = lowerFrom > i ? lowerFrom - i : 0;
+        return foldUpper(value, 0x8080808080808080ULL << (8 * skip));
+    }
+
+    // SipHash-2-4 of data[0, len) with the bytes from lowerFrom on lowercased as they are read
+    [[nodiscard]] static uint64_t siphash24Folded(const PseudonymKey &key, const char *data, size_t len,
+                                                  size_t lowerFrom) noexcept
+    {
+        uint64_t v0 = 0x736f6d6570736575ULL ^ key.k0;
+        uint64_t v1 = 0x646f72616e646f6dULL ^ key.k1;
+        uint64_t v2 = 0x6c7967656e657261ULL ^ key.k0;
+        uint64_t v3 = 0x7465646279746573ULL ^ key.k1;
+
+        auto round = [&]()
+        {
+            v0 += v1;
+            v1 = rotl(v1, 13);
+            v1 ^= v0;
+            v0 = rotl(v0, 32);
+            v2 += v3;
+            v3 = rotl(v3, 16);
+            v3 ^= v2;
+            v0 += v3;
+            v3 = rotl(v3, 21);
+            v3 ^= v0;
+            v2 += v1;
+            v1 = rotl(v1, 17);
+            v1 ^= v2;
+            v2 = rotl(v2, 32);
+        };
+
+        const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+        const size_t whole = len & ~size_t{7};
+        for (size_t i = 0; i < whole; i += 8)
+        {
+            const uint64_t m = loadFolded(bytes, i, 8, lowerFrom);
+            v3 ^= m;
+            round();
+            round();
+            v0 ^= m;
+        }
+
+        const uint64_t last = loadFolded(bytes, whole, len - whole, lowerFrom) | (uint64_t{len & 0xff} << 56);
+        v3 ^= last;
+        round();
+        round();
+        v0 ^= last;
+
+        v2 ^= 0xff;
+        round();
+        round();
+        round();
+        round();
+        return v0 ^ v1 ^ v2 ^ v3;
+    }
+
+    [[nodiscard]] uint64_t computeDigest(std::string_view email) const noexcept
+    {
+        return addressDigest(key_, email);
+    }
+
+public:
+    // cacheEntries of 0 hashes every address; otherwise that many recent addresses are kept in a
+    // cache shared by every thread using this pseudonymizer
+    explicit EmailPseudonymizer(const PseudonymKey &key, std::string prefix = "user:", size_t cacheEntries = 0)
+        : key_(key), prefix_(std::move(prefix)), entryCount_(cacheEntries)
+    {
+        if (entryCount_ > 0)
+        {
+            entries_ = std::make_unique<CacheEntry[]>(entryCount_);
+            shards_ = std::make_unique<CacheShard[]>(CACHE_SHARDS);
+        }
+    }
+
+    // SipHash-2-4 (Aumasson and Bernstein) of data under key
+    [[nodiscard]] static uint64_t siphash24(const PseudonymKey &key, const char *data, size_t len) noexcept
+    {
+        return siphash24Folded(key, data, len, len);
+    }
+
+    // Keyed hash of the address with its domain lowercased, like EmailScanner::hashAddress
+    [[nodiscard]] static uint64_t addressDigest(const PseudonymKey &key, std::string_view email) noexcept
+    {
+        const size_t at = email.rfind('@');
+        return siphash24Folded(key, email.data(), email.size(), at == std::string_view::npos ? email.size() : at + 1);
+    }
+
+    // Sixteen lowercase hex digits, most significant first
+    static void formatHex(uint64_t value, char *out) noexcept
+    {
+        static constexpr char HEX[] = "0123456789abcdef";
+        for (int i = 0; i < 16; ++i)
+            out[i] = HEX[(value >> (60 - 4 * i)) & 0xF];
+    }
+
+    // Keyed digest of the address, from the cache when it holds the address
+    [[nodiscard]] uint64_t digest(std::string_view email) const noexcept
+    {
+        if (!entries_ || email.empty() || email.size() > MAX_CACHED_LENGTH)
+            return computeDigest(email);
+
+        const size_t slot = static_cast<size_t>(slotHash(email) % entryCount_);
+        CacheEntry &entry = entries_[slot];
+        CacheShard &shard = shards_[slot % CACHE_SHARDS];
+        const size_t words = (email.size() + 7) / 8;
+
+        const uint32_t before = entry.version.load(std::memory_order_acquire);
+        if ((before & 1) == 0 && entry.length.load(std::memory_order_relaxed) == email.size())
+        {
+            bool same = true;
+            for (size_t w = 0; w < words; ++w)
+                same &= entry.words[w].load(std::memory_order_relaxed) == wordAt(email, w);
+            const uint64_t cached = entry.digest.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (same && entry.version.load(std::memory_order_relaxed) == before)
+            {
+                shard.hits.fetch_add(1, std::memory_order_relaxed);
+                return cached;
+            }
+        }
+
+        const uint64_t value = computeDigest(email);
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+
+        try
+        {
+            std::lock_guard<std::mutex> lock(shard.writer);
+            const uint32_t version = entry.version.load(std::memory_order_relaxed);
+            entry.version.store(version + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            entry.length.store(static_cast<uint32_t>(email.size()), std::memory_order_relaxed);
+            for (size_t w = 0; w < ENTRY_WORDS; ++w)
+                entry.words[w].store(w < words ? wordAt(email, w) : 0, std::memory_order_relaxed);
+            entry.digest.store(value, std::memory_order_relaxed);
+
+            entry.version.store(version + 2, std::memory_order_release);
+        }
+        catch (...)
+        {
+            ThreadSafeErrorCounter::recordError();
+        }
+        return value;
+    }
+
+    // prefix + 16 hex digits
+    [[nodiscard]] std::string pseudonym(std::string_view email) const
+    {
+        char digits[16];
+        formatHex(digest(email), digits);
+        std::string result(prefix_);
+        result.append(digits, sizeof(digits));
+        return result;
+    }
+
+    [[nodiscard]] const std::string &prefix() const noexcept
+    {
+        return prefix_;
+    }
+
+    [[nodiscard]] CacheStats getCacheStats() const noexcept
+    {
+        CacheStats stats;
+        if (!shards_)
+            return stats;
+
+        stats.capacity = entryCount_;
+        for (size_t i = 0; i < CACHE_SHARDS; ++i)
+        {
+            stats.hits += shards_[i].hits.load(std::memory_order_relaxed);
+            stats.misses += shards_[i].misses.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+};
+
+// ====================================================================================================
+// KNOWN EMAIL INDEX (Read-only fingerprint set, memory-mapped, two buckets per lookup)
+// ====================================================================================================
+
+// On-disk format shared by KnownEmailIndexBuilder and KnownEmailFilter, in host byte order: a 64-byte
+// header, then bucketCount buckets of SLOTS 64-bit fingerprints, one cache line each. A fingerprint
+// is the SipHash-2-4 of the address under the file's seed with the domain lowercased (0 is stored as
+// 1, since 0 marks an empty slot). Its low and high 32 bits each pick a bucket, and the builder puts
+// it in one of the two, so a lookup reads at most two cache lines and a miss is wrong about 16 in
+// 2^64 times.
+struct KnownEmailIndex
+{
+    static constexpr char MAGIC[8] = {'E', 'M', 'L', 'I', 'D', 'X', '\r', '\n'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t SLOTS = 8;
+    static constexpr size_t BUCKET_BYTES = SLOTS * sizeof(uint64_t);
+    // Seeds are not secret: anyone holding the file can test candidate addresses against it anyway
+    static constexpr PseudonymKey DEFAULT_SEED{0x6b6e6f776e2d656dULL, 0x61696c2d696e6478ULL};
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t slots;
+        uint64_t seedK0;
+        uint64_t seedK1;
+        uint64_t bucketCount;
+        uint64_t entryCount;
+        uint64_t reserved[2];
+    };
+    static_assert(sizeof(Header) == BUCKET_BYTES, "the buckets after the header stay cache-line aligned");
+
+    [[nodiscard]] static uint64_t fingerprint(const PseudonymKey &seed, std::string_view email) noexcept
+    {
+        const uint64_t digest = EmailPseudonymizer::addressDigest(seed, email);
+        return digest != 0 ? digest : 1;
+    }
+
+    // Maps 32 hash bits onto [0, bucketCount) with a multiply instead of a modulo
+    [[nodiscard]] static FORCE_INLINE size_t bucketOf(uint64_t bits, uint64_t bucketCount) noexcept
+    {
+        return static_cast<size_t>(((bits & 0xffffffffULL) * bucketCount) >> 32);
+    }
+
+    [[nodiscard]] static FORCE_INLINE size_t firstBucket(uint64_t fp, uint64_t bucketCount) noexcept
+    {
+        return bucketOf(fp, bucketCount);
+    }
+
+    [[nodiscard]] static FORCE_INLINE size_t secondBucket(uint64_t fp, uint64_t bucketCount) noexcept
+    {
+        return bucketOf(fp >> 32, bucketCount);
+    }
+
+    [[nodiscard]] static FORCE_INLINE bool bucketHolds(const uint64_t *bucket, uint64_t fp) noexcept
+    {
+        bool found = false;
+        for (size_t i = 0; i < SLOTS; ++i)
+            found |= bucket[i] == fp;
+        return found;
+    }
+};
+
+// Compiles a list of addresses into a KnownEmailIndex file. Fingerprints are collected, sorted and
+// deduplicated, then placed by bucketized cuckoo hashing: into the emptier of its two buckets, or,
+// when both are full, in place of a resident that moves to its own other bucket. Tables start at
+// 90% load and grow by an eighth whenever a chain of moves runs too long.
+class KnownEmailIndexBuilder
+{
+public:
+    struct Summary
+    {
+        uint64_t lines = 0;
+        uint64_t entries = 0;
+        uint64_t duplicates = 0;
+        uint64_t invalid = 0;
+        uint64_t bucketCount = 0;
+        uint64_t fileBytes = 0;
+    };
+
+private:
+    static constexpr double TARGET_LOAD = 0.9;
+    static constexpr size_t MAX_KICKS = 500;
+
+    PseudonymKey seed_;
+    bool validate_;
+    std::vector<uint64_t> fingerprints_;
+    Summary summary_;
+
+    [[nodiscard]] static bool placeAll(const std::vector<uint64_t> &fingerprints, uint64_t bucketCount,
+                                       std::vector<uint64_t> &table)
+    {
+        table.assign(bucketCount * KnownEmailIndex::SLOTS, 0);
+        uint64_t rng = 0x9e3779b97f4a7c15ULL;
+
+        auto freeSlot = [&](size_t bucket) -> uint64_t *
+        {
+            uint64_t *slots = table.data() + bucket * KnownEmailIndex::SLOTS;
+            for (size_t i = 0; i < KnownEmailIndex::SLOTS; ++i)
+            {
+                if (slots[i] == 0)
+                    return slots + i;
+            }
+            return nullptr;
+        };
+
+        for (uint64_t fp : fingerprints)
+        {
+            size_t bucket = KnownEmailIndex::firstBucket(fp, bucketCount);
+            uint64_t *slot = freeSlot(bucket);
+            if (slot == nullptr)
+            {
+                bucket = KnownEmailIndex::secondBucket(fp, bucketCount);
+                slot = freeSlot(bucket);
+            }
+
+            for (size_t kick = 0; slot == nullptr; ++kick)
+            {
+                if (kick == MAX_KICKS)
+                    return false;
+
+                rng ^= rng << 13;
+                rng ^= rng >> 7;
+                rng ^= rng << 17;
+                uint64_t &victim = table[bucket * KnownEmailIndex::SLOTS + rng % KnownEmailIndex::SLOTS];
+                std::swap(fp, victim);
+
+                const size_t first = KnownEmailIndex::firstBucket(fp, bucketCount);
+                bucket = bucket == first ? KnownEmailIndex::secondBucket(fp, bucketCount) : first;
+                slot = freeSlot(bucket);
+            }
+            *slot = fp;
+        }
+        return true;
+    }
+
+public:
+    explicit KnownEmailIndexBuilder(const PseudonymKey &seed = KnownEmailIndex::DEFAULT_SEED, bool validate = true)
+        : seed_(seed), validate_(validate)
+    {
+    }
+
+    // Returns false, and skips the address, when validation is on and it is not a valid address
+    bool add(std::string_view email)
+    {
+        ++summary_.lines;
+        if (validate_ && !EmailValidator::isValid(email))
+        {
+            ++summary_.invalid;
+            return false;
+        }
+        fingerprints_.push_back(KnownEmailIndex::fingerprint(seed_, email));
+        return true;
+    }
+
+    // One address per line; blank lines and surrounding whitespace are ignored
+    void addLines(std::istream &in)
+    {
+        std::string line;
+        while (std::getline(in, line))
+        {
+            const size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos)
+                continue;
+            const size_t last = line.find_last_not_of(" \t\r");
+            add(std::string_view(line).substr(first, last - first + 1));
+        }
+    }
+
+    // Writes the index to path through a temporary file renamed over it, so readers mapping the
+    // old index never see a half-written one
+    Summary write(const std::string &path)
+    {
+        std::sort(fingerprints_.begin(), fingerprints_.end());
+        const auto unique = std::unique(fingerprints_.begin(), fingerprints_.end());
+        summary_.duplicates += static_cast<uint64_t>(fingerprints_.end() - unique);
+        fingerprints_.erase(unique, fingerprints_.end());
+
+        const auto entries = static_cast<uint64_t>(fingerprints_.size());
+        uint64_t bucketCount = std::max<uint64_t>(
+            1, static_cast<uint64_t>(std::ceil(static_cast<double>(entries) / (KnownEmailIndex::SLOTS * TARGET_LOAD))));
+
+        std::vector<uint64_t> table;
+        while (!placeAll(fingerprints_, bucketCount, table))
+            bucketCount += bucketCount / 8 + 1;
+        if (bucketCount > (uint64_t{1} << 32))
+            throw std::runtime_error("too many addresses for one known-email index");
+
+        KnownEmailIndex::Header header{};
+        std::memcpy(header.magic, KnownEmailIndex::MAGIC, sizeof(header.magic));
+        header.version = KnownEmailIndex::VERSION;
+        header.slots = static_cast<uint32_t>(KnownEmailIndex::SLOTS);
+        header.seedK0 = seed_.k0;
+        header.seedK1 = seed_.k1;
+        header.bucketCount = bucketCount;
+        header.entryCount = entries;
+
+        const std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char *>(table.data()),
+                      static_cast<std::streamsize>(table.size() * sizeof(uint64_t)));
+            out.close();
+            if (!out)
+            {
+                std::remove(temporary.c_str());
+                throw std::runtime_error("cannot write known-email index " + temporary);
+            }
+        }
+        if (std::rename(temporary.c_str(), path.c_str()) != 0)
+        {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("cannot replace known-email index " + path);
+        }
+
+        summary_.entries = entries;
+        summary_.bucketCount = bucketCount;
+        summary_.fileBytes = sizeof(header) + table.size() * sizeof(uint64_t);
+        return summary_;
+    }
+};
+
+// Generation stamps for the filters ScanOptions points at (KnownEmailFilter, DomainRuleSet): unique
+// per object and per change, never reused, so a result cached under one stamp is never served for
+// another filter that happens to sit at the same address
+[[nodiscard]] inline uint64_t nextFilterGeneration() noexcept
+{
+    static std::atomic<uint64_t> generation{0};
+    return generation.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// Membership test against a KnownEmailIndex file. Opening maps the file read-only and checks its
+// header; nothing is parsed or copied, so startup takes the same time for ten addresses or 200M, and
+// pages come in as lookups touch them (shared with every other process mapping the same file).
+// Lookups are lock-free and safe from any number of threads.
+class KnownEmailFilter final
+{
+private:
+    const uint64_t *buckets_ = nullptr;
+    uint64_t bucketCount_ = 0;
+    uint64_t entryCount_ = 0;
+    PseudonymKey seed_;
+    void *mapping_ = nullptr;
+    size_t mappingSize_ = 0;
+    std::unique_ptr<uint64_t[]> copy_;
+    std::string error_;
+    uint64_t generation_ = nextFilterGeneration();
+
+    [[nodiscard]] bool fail(std::string message)
+    {
+        error_ = std::move(message);
+        return false;
+    }
+
+    // Checks the header of a file of size bytes and points buckets_ past it
+    [[nodiscard]] bool attach(const void *data, size_t size, const std::string &path)
+    {
+        if (size < sizeof(KnownEmailIndex::Header))
+            return fail(path + " is too short for a known-email index");
+
+        KnownEmailIndex::Header header;
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, KnownEmailIndex::MAGIC, sizeof(header.magic)) != 0)
+            return fail(path + " is not a known-email index");
+        if (header.version != KnownEmailIndex::VERSION || header.slots != KnownEmailIndex::SLOTS)
+            return fail(path + " has an unsupported index version or byte order");
+        if (header.bucketCount == 0 || header.bucketCount > (uint64_t{1} << 32) ||
+            size - sizeof(header) != header.bucketCount * KnownEmailIndex::BUCKET_BYTES)
+            return fail(path + " is truncated or corrupt");
+
+        buckets_ = reinterpret_cast<const uint64_t *>(static_cast<const char *>(data) + sizeof(header));
+        bucketCount_ = header.bucketCount;
+        entryCount_ = header.entryCount;
+        seed_ = {header.seedK0, header.seedK1};
+        return true;
+    }
+
+    bool open(const std::string &path)
+    {
+#if defined(__linux__)
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return fail("cannot open " + path + ": " + std::strerror(errno));
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size <= 0)
+        {
+            ::close(fd);
+            return fail(path + " is empty or unreadable");
+        }
+
+        const auto size = static_cast<size_t>(info.st_size);
+        void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+            return fail("cannot map " + path + ": " + std::strerror(errno));
+
+        mapping_ = mapped;
+        mappingSize_ = size;
+        // Lookups land on random buckets: read-ahead would only pull in pages nobody asked for
+        ::madvise(mapped, size, MADV_RANDOM);
+        return attach(mapped, size, path);
+#else
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in)
+            return fail("cannot open " + path);
+
+        const auto size = static_cast<size_t>(in.tellg());
+        copy_ = std::make_unique<uint64_t[]>((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+        in.seekg(0);
+        if (!in.read(reinterpret_cast<char *>(copy_.get()), static_cast<std::streamsize>(size)))
+            return fail("cannot read " + path);
+        return attach(copy_.get(), size, path);
+#endif
+    }
+
+public:
+    // Check isOpen() and error() afterwards
+    explicit KnownEmailFilter(const std::string &path)
+    {
+        open(path);
+    }
+
+    ~KnownEmailFilter()
+    {
+#if defined(__linux__)
+        if (mapping_ != nullptr)
+            ::munmap(mapping_, mappingSize_);
+#endif
+    }
+
+    KnownEmailFilter(const KnownEmailFilter &) = delete;
+    KnownEmailFilter &operator=(const KnownEmailFilter &) = delete;
+
+    // For command lines: an index that does not open is an error
+    [[nodiscard]] static std::shared_ptr<const KnownEmailFilter> load(const std::string &path)
+    {
+        auto filter = std::make_shared<const KnownEmailFilter>(path);
+        if (!filter->isOpen())
+            throw std::runtime_error(filter->error());
+        return filter;
+    }
+
+    [[nodiscard]] bool isOpen() const noexcept
+    {
+        return buckets_ != nullptr;
+    }
+
+    [[nodiscard]] const std::string &error() const noexcept
+    {
+        return error_;
+    }
+
+    [[nodiscard]] uint64_t size() const noexcept
+    {
+        return entryCount_;
+    }
+
+    // Unique to this filter; the mapped index is read-only, so it never changes
+    [[nodiscard]] uint64_t generation() const noexcept
+    {
+        return generation_;
+    }
+
+    // True for listed addresses (domain compared case-insensitively); false for everything else
+    // but about one address in 2^60, and always false when the index failed to open. The second
+    // bucket is prefetched while the first is compared, so the two cache misses overlap.
+    [[nodiscard]] bool contains(std::string_view email) const noexcept
+    {
+        if (buckets_ == nullptr)
+            return false;
+
+        const uint64_t fp = KnownEmailIndex::fingerprint(seed_, email);
+        const uint64_t *first = buckets_ + KnownEmailIndex::firstBucket(fp, bucketCount_) * KnownEmailIndex::SLOTS;
+        const uint64_t *second = buckets_ + KnownEmailIndex::secondBucket(fp, bucketCount_) * KnownEmailIndex::SLOTS;
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(second);
+#endif
+        return KnownEmailIndex::bucketHolds(first, fp) || KnownEmailIndex::bucketHolds(second, fp);
+    }
+};
+
+// ====================================================================================================
+// DOMAIN RULES (Reversed-label trie, most specific rule wins)
+// ====================================================================================================
+
+enum class DomainAction : uint8_t
+{
+    NONE,   // no rule covers the domain
+    IGNORE, // matches are dropped
+    REPORT  // matches are reported
+};
+
+// Domain allow/deny rules, matched label by label from the TLD inwards. Patterns:
+//   example.com     example.com and every subdomain
+//   *.example.com   subdomains of example.com only
+//   competitor.*    competitor under any suffix (competitor.com, eu.competitor.co.uk), subdomains too
+// The rule that names the most labels wins, so "ignore example.com" and "report leaks.example.com"
+// combine as expected; on a tie a fully literal rule beats a suffix wildcard. Labels compare
+// ASCII-case-insensitively. Without any REPORT rule, addresses no rule covers are reported; with
+// one, only what REPORT rules cover is.
+//
+// The trie has no node arrays: each edge (parent node, label) is one 16-byte slot of an
+// open-addressing table keyed by a mix of the parent id and a seeded label hash, and carries the
+// child's actions. A lookup costs one probe per label whatever the number of rules, and never
+// allocates. Labels are not stored, so two labels whose 64-bit hashes collide are confused; the
+// seed is random per rule set, so such labels cannot be prepared in advance.
+class DomainRuleSet final
+{
+public:
+    // Labels of a domain of at most 255 bytes
+    static constexpr size_t MAX_LABELS = 128;
+
+private:
+    struct Slot
+    {
+        uint64_t key = 0;
+        uint32_t node = 0;
+        DomainAction self = DomainAction::NONE; // the domain ends at this label
+        DomainAction sub = DomainAction::NONE;  // more labels follow
+    };
+
+    static constexpr uint32_t ROOT = 0;
+    // Root of the rules with a wildcard suffix, walked from every label but the last
+    static constexpr uint32_t WILDCARD_ROOT = 1;
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    size_t used_ = 0;
+    uint32_t nodeCount_ = 2;
+    uint64_t seed_;
+    size_t ruleCount_ = 0;
+    bool hasReportRules_ = false;
+    bool hasWildcardRules_ = false;
+    uint64_t generation_ = nextFilterGeneration();
+
+    [[nodiscard]] static FORCE_INLINE uint64_t lowerByte(char c) noexcept
+    {
+        const auto byte = static_cast<unsigned char>(c);
+        return static_cast<unsigned char>(byte - 'A') < 26 ? byte | 0x20 : byte;
+    }
+
+    [[nodiscard]] FORCE_INLINE uint64_t labelHash(const char *label, size_t len) const noexcept
+    {
+        uint64_t h = seed_ ^ (len * 0x9e3779b97f4a7c15ULL);
+        for (size_t i = 0; i < len; i += 8)
+        {
+            uint64_t word = 0;
+            const size_t count = std::min<size_t>(len - i, 8);
+            for (size_t j = 0; j < count; ++j)
+                word |= lowerByte(label[i + j]) << (8 * j);
+            h ^= word;
+            h *= 0xff51afd7ed558ccdULL;
+            h = (h << 31) | (h >> 33);
+        }
+        return h;
+    }
+
+    [[nodiscard]] static FORCE_INLINE uint64_t edgeKey(uint32_t parent, uint64_t label) noexcept
+    {
+        uint64_t k = label ^ (uint64_t{parent} * 0xc4ceb9fe1a85ec53ULL);
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        return k != 0 ? k : 1;
+    }
+
+    [[nodiscard]] FORCE_INLINE const Slot *find(uint64_t key) const noexcept
+    {
+        for (size_t i = key & mask_;; i = (i + 1) & mask_)
+        {
+            const Slot &slot = slots_[i];
+            if (slot.key == key)
+                return &slot;
+            if (slot.key == 0)
+                return nullptr;
+        }
+    }
+
+    // Keeps the table at most 70% full
+    void reserveOne()
+    {
+        if ((used_ + 1) * 10 <= slots_.size() * 7)
+            return;
+
+        std::vector<Slot> old = std::move(slots_);
+        slots_.assign(std::max<size_t>(old.size() * 2, 1024), Slot{});
+        mask_ = slots_.size() - 1;
+        for (const Slot &slot : old)
+        {
+            if (slot.key == 0)
+                continue;
+            size_t i = slot.key & mask_;
+            while (slots_[i].key != 0)
+                i = (i + 1) & mask_;
+            slots_[i] = slot;
+        }
+    }
+
+    Slot &child(uint32_t parent, uint64_t label)
+    {
+        reserveOne();
+        const uint64_t key = edgeKey(parent, label);
+        size_t i = key & mask_;
+        while (slots_[i].key != 0 && slots_[i].key != key)
+            i = (i + 1) & mask_;
+        if (slots_[i].key == 0)
+        {
+            slots_[i].key = key;
+            slots_[i].node = nodeCount_++;
+            ++used_;
+        }
+        return slots_[i];
+    }
+
+    // Hashes of the labels of domain, TLD first; 0 labels when it is not a dotted name
+    [[nodiscard]] size_t splitLabels(std::string_view domain, uint64_t *hashes) const noexcept
+    {
+        size_t count = 0;
+        size_t end = domain.size();
+        while (true)
+        {
+            const size_t dot = end == 0 ? std::string_view::npos : domain.rfind('.', end - 1);
+            const size_t start = dot == std::string_view::npos ? 0 : dot + 1;
+            if (start == end || count == MAX_LABELS)
+                return 0;
+            hashes[count++] = labelHash(domain.data() + start, end - start);
+            if (dot == std::string_view::npos)
+                return count;
+            end = dot;
+        }
+    }
+
+public:
+    DomainRuleSet() : seed_((uint64_t{std::random_device{}()} << 32) ^ std::random_device{}())
+    {
+        slots_.assign(1024, Slot{});
+        mask_ = slots_.size() - 1;
+    }
+
+    // Throws std::invalid_argument for empty labels or a '*' anywhere but a whole first or last label
+    void addRule(std::string_view pattern, DomainAction action)
+    {
+        const size_t first = pattern.find_first_not_of(" \t\r");
+        const size_t last = pattern.find_last_not_of(" \t\r");
+        std::string_view domain = first == std::string_view::npos ? std::string_view()
+                                                                  : pattern.substr(first, last - first + 1);
+        if (!domain.empty() && domain.front() == '@')
+            domain.remove_prefix(1);
+
+        const bool subdomainsOnly = domain.substr(0, 2) == "*.";
+        if (subdomainsOnly)
+            domain.remove_prefix(2);
+        const bool anySuffix = domain.size() >= 2 && domain.substr(domain.size() - 2) == ".*";
+        if (anySuffix)
+            domain.remove_suffix(2);
+
+        uint64_t hashes[MAX_LABELS];
+        const size_t count = domain.find('*') == std::string_view::npos ? splitLabels(domain, hashes) : 0;
+        if (count == 0 || action == DomainAction::NONE)
+            throw std::invalid_argument("invalid domain rule '" + std::string(pattern) + "'");
+
+        uint32_t node = anySuffix ? WILDCARD_ROOT : ROOT;
+        Slot *slot = nullptr;
+        for (size_t i = 0; i < count; ++i)
+        {
+            slot = &child(node, hashes[i]);
+            node = slot->node;
+        }
+        if (!subdomainsOnly)
+            slot->self = action;
+        slot->sub = action;
+
+        ++ruleCount_;
+        hasReportRules_ |= action == DomainAction::REPORT;
+        hasWildcardRules_ |= anySuffix;
+        generation_ = nextFilterGeneration();
+    }
+
+    // One pattern per line; blank lines and lines starting with '#' are skipped
+    void addRules(std::istream &in, DomainAction action)
+    {
+        std::string line;
+        while (std::getline(in, line))
+        {
+            const size_t first = line.find_first_not_of(" \t\r");
+            if (first != std::string::npos && line[first] != '#')
+                addRule(line, action);
+        }
+    }
+
+    // Action of the most specific rule covering domain, or NONE
+    [[nodiscard]] DomainAction match(std::string_view domain) const noexcept
+    {
+        uint64_t hashes[MAX_LABELS];
+        const size_t count = splitLabels(domain, hashes);
+
+        DomainAction best = DomainAction::NONE;
+        size_t bestDepth = 0;
+        uint32_t node = ROOT;
+        for (size_t d = 0; d < count; ++d)
+        {
+            const Slot *slot = find(edgeKey(node, hashes[d]));
+            if (slot == nullptr)
+                break;
+            node = slot->node;
+            const DomainAction action = d + 1 == count ? slot->self : slot->sub;
+            if (action != DomainAction::NONE)
+            {
+                best = action;
+                bestDepth = d + 1;
+            }
+        }
+
+        if (!hasWildcardRules_)
+            return best;
+
+        // name.* rules: the wildcard takes the last `skip` labels, the rest walk the second trie
+        for (size_t skip = 1; skip < count; ++skip)
+        {
+            node = WILDCARD_ROOT;
+            for (size_t d = skip; d < count; ++d)
+            {
+                const Slot *slot = find(edgeKey(node, hashes[d]));
+                if (slot == nullptr)
+                    break;
+                node = slot->node;
+                const DomainAction action = d + 1 == count ? slot->self : slot->sub;
+                if (action != DomainAction::NONE && d + 1 - skip > bestDepth)
+                {
+                    best = action;
+                    bestDepth = d + 1 - skip;
+                }
+            }
+        }
+        return best;
+    }
+
+    // Whether an address in domain should be reported under these rules
+    [[nodiscard]] bool shouldReport(std::string_view domain) const noexcept
+    {
+        const DomainAction action = match(domain);
+        return action == DomainAction::NONE ? !hasReportRules_ : action == DomainAction::REPORT;
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return ruleCount_;
+    }
+
+    [[nodiscard]] size_t memoryBytes() const noexcept
+    {
+        return slots_.size() * sizeof(Slot);
+    }
+
+    // Unique to this rule set, renewed by every addRule(); DocumentResultCache keys on it
+    [[nodiscard]] uint64_t generation() const noexcept
+    {
+        return generation_;
+    }
+};
+
+// ====================================================================================================
+// EMAIL SCANNER WITH HEURISTIC EXTRACTION - STATELESS (Pure Functions)
+// ====================================================================================================
+
+// Optional scanner behaviour; the defaults examine every '@'
+struct ScanOptions
+{
+    // Skip '@'s in blocks that look binary (core dumps, attachments, database pages) unless they sit
+    // in a printable run of at least minPrintableRun bytes. Cheaper and fewer junk matches on mixed
+    // data; a match shorter than the run length next to binary bytes can be missed.
+    bool skipBinary = false;
+    size_t minPrintableRun = 6;
+    // Report only addresses in this index; the others are still consumed, so no part of an unlisted
+    // address is reported instead. Not owned; must outlive the scan.
+    const KnownEmailFilter *knownEmails = nullptr;
+    // Report only addresses whose domain these rules let through; consumed like unlisted ones.
+    // Not owned; must outlive the scan.
+    const DomainRuleSet *domainRules = nullptr;
+    // Reject candidates whose TLD is not in the root zone (TldTable), right after the domain scan
+    // and before any local-part work: drops user@host.local1 and a@b.c0 along with single-label
+    // domains such as user@localhost.
+    bool strictTld = false;
+    // Memo of domain validation results shared by the threads scanning with these options; results
+    // are identical with or without it. Not owned; must outlive the scan.
+    DomainValidationCache *domainCache = nullptr;
+};
+
+// What EmailScanner::redact writes in place of each address
+enum class RedactionMode : uint8_t
+{
+    MASK,      // every byte of the address becomes maskChar, so lengths and offsets are kept
+    TOKEN,     // the address becomes token
+    HASH,      // the address becomes hashPrefix + 16 hex digits of EmailScanner::hashAddress
+    PSEUDONYM, // the address becomes pseudonymizer->pseudonym(address), or is masked without one
+    SHAPE      // john.doe@example.com becomes j***.d**@e******.com: length, '.', '@', '"', the first
+               // byte of each local-part segment and domain label longer than one byte, and the TLD
+               // are kept; a@b.co becomes *@*.co
+};
+
+struct RedactionPolicy
+{
+    RedactionMode mode = RedactionMode::TOKEN;
+    char maskChar = '*';
+    std::string_view token = "[EMAIL]";
+    std::string_view hashPrefix = "email:";
+    // Tenant key and cache for PSEUDONYM; must outlive every scan using the policy
+    const EmailPseudonymizer *pseudonymizer = nullptr;
+};
+
+class EmailScanner final
+{
+private:
+    static constexpr size_t MAX_INPUT_SIZE = 10 * 1024 * 1024;
+    static constexpr size_t MAX_LEFT_SCAN = 4096;
+    static constexpr size_t MAX_EMAILS_EXTRACT = 10000;
+    static constexpr size_t MAX_BACKTRACK_PER_AT = 330;
+    static constexpr size_t MAX_BACKWARD_SCAN_CHARS = 200;
+    static constexpr size_t MAX_QUOTE_SCAN = 100;
+    static constexpr size_t MAX_MEMORY_BUDGET = 5 * 1024 * 1024;
+    static constexpr size_t MAX_INITIAL_RESERVE = 100;
+    static constexpr size_t MAX_AT_SYMBOLS = 1000;
+    static constexpr size_t MAX_SEEN_SET_SIZE = 5000;
+    static constexpr size_t MAX_TOTAL_OPERATIONS = 100'000'000;
+    // Redaction scans text in windows of this size, each under fresh limits, so the cumulative caps
+    // (MAX_TOTAL_CHARS_SCANNED, MAX_SCAN_ITERATIONS) are out of reach of ordinary text
+    static constexpr size_t REDACT_WINDOW = 256 * 1024;
+    // Matches ending inside a window's last REDACT_HOLDBACK bytes are left to the next window
+    static constexpr size_t REDACT_HOLDBACK = 512;
+
+    struct EmailBoundaries
+    {
+        size_t start;
+        size_t end;
+        bool validBoundaries;
+        size_t skipTo;
+        bool didTrimDomain;
+    };
+
+    struct OperationBatcher
+    {
+        size_t local_count = 0;
+        static constexpr size_t BATCH_SIZE = 1000;
+
+        inline void recordOperation(std::atomic<size_t> &counter) noexcept
+        {
+            if (++local_count >= BATCH_SIZE)
+            {
+                counter.fetch_add(BATCH_SIZE, std::memory_order_relaxed);
+                local_count = 0;
+            }
+        }
+
+        inline bool checkLimit(std::atomic<size_t> &counter, size_t max_ops) noexcept
+        {
+            recordOperation(counter);
+            return counter.load(std::memory_order_relaxed) > max_ops;
+        }
+    };
+
+    [[nodiscard]] static FORCE_INLINE size_t findFirstAlnum(const char *data, size_t dataLen,
+                                                            size_t pos, size_t limit) noexcept
+    {
+        limit = std::min(limit, dataLen);
+
+        while (pos < limit)
+        {
+            PRODUCTION_CHECK_BOOL(pos < dataLen, "findFirstAlnum bounds");
+            unsigned char uc = static_cast<unsigned char>(data[pos]);
+            if (CharacterClassifier::isAlphaNum(uc))
+                return pos;
+            ++pos;
+        }
+        return SIZE_MAX;
+    }
+
+    [[nodiscard]] static FORCE_INLINE size_t findFirstAtext(const char *data, size_t dataLen,
+                                                            size_t pos, size_t limit) noexcept
+    {
+        limit = std::min(limit, dataLen);
+
+        while (pos < limit)
+        {
+            PRODUCTION_CHECK_BOOL(pos < dataLen, "findFirstAtext bounds");
+            unsigned char uc = static_cast<unsigned char>(data[pos]);
+            if (LIKELY(CharacterClassifier::isAtext(uc)))
+                return pos;
+            ++pos;
+        }
+        return SIZE_MAX;
+    }
+
+    [[nodiscard]] static inline std::optional<size_t> safe_memchr_index(
+        const char *data, size_t start, size_t len, char ch) noexcept
+    {
+        if (start >= len || !data)
+            return std::nullopt;
+
+        const char *ptr = static_cast<const char *>(
+            std::memchr(data + start, ch, len - start));
+
+        if (!ptr)
+            return std::nullopt;
+
+        if (ptr < data || ptr >= data + len)
+            return std::nullopt;
+
+        return static_cast<size_t>(ptr - data);
+    }
+
+    [[nodiscard]] static EmailBoundaries findEmailBoundaries(std::string_view text, size_t atPos,
+                                                             size_t minScannedIndex,
+                                                             std::atomic<size_t> &opCounter,
+                                                             OperationBatcher &batcher,
+                                                             bool strictTld) noexcept
+    {
+        const size_t len = text.length();
+        const char *data = text.data();
+
+        if (batcher.checkLimit(opCounter, MAX_TOTAL_OPERATIONS))
+        {
+            return {atPos, atPos, false, atPos, false};
+        }
+
+        if (atPos >= len) [[unlikely]]
+            return {atPos, atPos, false, atPos, false};
+
+        size_t end = atPos + 1;
+
+        if (end < len && data[end] == '[') [[unlikely]]
+        {
+            return {atPos, atPos, false, atPos + 1, false};
+        }
+
+        static constexpr size_t MAX_DOMAIN_PART = 255;
+        static constexpr size_t MAX_LABEL_LENGTH = 63;
+        size_t domain_chars = 0;
+        bool didTrimDomain = false;
+        size_t current_label_length = 0;
+
+        while (end < len && CharacterClassifier::isDomainChar(static_cast<unsigned char>(data[end])))
+        {
+            if (domain_chars >= MAX_DOMAIN_PART)
+            {
+                end = atPos + 1 + MAX_DOMAIN_PART;
+                didTrimDomain = true;
+                break;
+            }
+
+            if (data[end] == '.')
+            {
+                current_label_length = 0;
+            }
+            else
+            {
+                ++current_label_length;
+                if (current_label_length > MAX_LABEL_LENGTH)
+                {
+                    didTrimDomain = true;
+                }
+            }
+
+            ++end;
+            ++domain_chars;
+
+            batcher.recordOperation(opCounter);
+            if (opCounter.load(std::memory_order_relaxed) > MAX_TOTAL_OPERATIONS) [[unlikely]]
+            {
+                return {atPos, atPos, false, atPos, false};
+            }
+        }
+
+        while (end > atPos + 1 && data[end - 1] == '.')
+        {
+            PRODUCTION_CHECK_BOUNDARIES(end > 0 && end - 1 < len, "findEmailBoundaries trailing dot removal", atPos);
+            --end;
+        }
+
+        if (end < len && data[end] == '@')
+        {
+            while (end > atPos + 1 && data[end - 1] == '-')
+            {
+                PRODUCTION_CHECK_BOUNDARIES(end > 0 && end - 1 < len, "findEmailBoundaries hyphen removal", atPos);
+                --end;
+            }
+        }
+
+        if (strictTld && !TldTable::hasKnownTld(data, atPos + 1, end))
+        {
+            return {atPos, atPos, false, std::max(end, atPos + 1), false};
+        }
+
+        size_t absoluteMin = safe_subtract(atPos, MAX_LEFT_SCAN);
+
+        if (atPos > 0 && (data[atPos - 1] == '"' || data[atPos - 1] == '\'' || data[atPos - 1] == '`'))
+        {
+            unsigned char closingQuote = static_cast<unsigned char>(data[atPos - 1]);
+            size_t quotesSeen = 0;
+
+            if (atPos >= 2)
+            {
+                for (size_t i = atPos; i > absoluteMin + 1 && i > 1;)
+                {
+                    --i;
+                    ++quotesSeen;
+
+                    batcher.recordOperation(opCounter);
+                    if (opCounter.load(std::memory_order_relaxed) > MAX_TOTAL_OPERATIONS) [[unlikely]]
+                    {
+                        return {atPos, atPos, false, atPos, false};
+                    }
+
+                    if (quotesSeen > MAX_QUOTE_SCAN)
+                        break;
+
+                    if (data[i] == closingQuote)
+                    {
+                        bool validBoundary = (i == 0 || i == absoluteMin);
+
+                        if (!validBoundary && i > 0)
+                        {
+                            unsigned char prevChar = static_cast<unsigned char>(data[i - 1]);
+                            validBoundary = CharacterClassifier::isScanBoundary(prevChar) ||
+                                            prevChar == ' ' ||
+                                            prevChar == '=' ||
+                                            prevChar == ':' ||
+                                            prevChar == ',' ||
+                                            prevChar == '<' ||
+                                            prevChar == '(' ||
+                                            prevChar == '[' ||
+                                            prevChar == '\r' ||
+                                            prevChar == '\n' ||
+                                            CharacterClassifier::isInvalidLocalChar(prevChar);
+                        }
+
+                        if (validBoundary && (atPos - i) >= 3)
+                        {
+                            bool rightBoundaryValid = true;
+                            if (end < len)
+                            {
+                                unsigned char nextChar = static_cast<unsigned char>(data[end]);
+                                if (!CharacterClassifier::isScanRightBoundary(nextChar) &&
+                                    nextChar != '\'' && nextChar != '`' && nextChar != '"' &&
+                                    nextChar != '@' && nextChar != '\\' &&
+                                    nextChar != ',' && nextChar != ';' && nextChar != '.' &&
+                                    nextChar != '!' && nextChar != '?' &&
+                                    !CharacterClassifier::isAtext(nextChar))
+                                {
+                                    rightBoundaryValid = false;
+                                }
+                            }
+
+                            if (rightBoundaryValid)
+                            {
+                                return {i, end, true, 0, false};
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        size_t effectiveMin = std::max(minScannedIndex, absoluteMin);
+        size_t start = atPos;
+        bool hitInvalidChar = false;
+        size_t invalidCharPos = atPos;
+        bool didRecovery = false;
+        bool didTrim = false;
+        size_t charsScanned = 0;
+
+        while (start > effectiveMin && start > 0 && charsScanned < MAX_BACKWARD_SCAN_CHARS)
+        {
+            batcher.recordOperation(opCounter);
+            if (opCounter.load(std::memory_order_relaxed) > MAX_TOTAL_OPERATIONS) [[unlikely]]
+            {
+                return {atPos, atPos, false, atPos, false};
+            }
+
+            PRODUCTION_CHECK_BOUNDARIES(start > 0, "findEmailBoundaries backward scan start > 0", atPos);
+            unsigned char prevChar = static_cast<unsigned char>(data[start - 1]);
+
+            if (prevChar == '@')
+            {
+                break;
+            }
+
+            if (prevChar == '.' && start > 1 && start > effectiveMin + 1)
+            {
+                if (data[start - 2] == '.')
+                {
+                    hitInvalidChar = true;
+                    invalidCharPos = start - 1;
+                    break;
+                }
+            }
+
+            if (CharacterClassifier::isInvalidLocalChar(prevChar))
+            {
+                if (prevChar == '@' && start > 1 && start > effectiveMin + 1)
+                {
+                    size_t lookback = start - 2;
+                    size_t validStart = start - 1;
+                    bool foundValid = false;
+                    const size_t lookbackLimit = effectiveMin;
+                    size_t lookbackIterations = 0;
+                    static constexpr size_t MAX_LOOKBACK_ITERATIONS = 100;
+
+                    while (lookback >= lookbackLimit && lookback < atPos &&
+                           lookback < len && lookbackIterations++ < MAX_LOOKBACK_ITERATIONS)
+                    {
+                        PRODUCTION_CHECK_BOUNDARIES(lookback < len, "findEmailBoundaries lookback", atPos);
+
+                        batcher.recordOperation(opCounter);
+                        if (opCounter.load(std::memory_order_relaxed) > MAX_TOTAL_OPERATIONS) [[unlikely]]
+                        {
+                            return {atPos, atPos, false, atPos, false};
+                        }
+
+                        unsigned char c = static_cast<unsigned char>(data[lookback]);
+                        if (CharacterClassifier::isAtext(c) && c != '.')
+                        {
+                            foundValid = true;
+                            validStart = lookback;
+                            if (lookback == lookbackLimit || lookback == 0)
+                                break;
+                            --lookback;
+                            continue;
+                        }
+                        break;
+                    }
+
+                    if (foundValid)
+                    {
+                        start = validStart;
+                        ++charsScanned;
+                        continue;
+                    }
+                }
+
+                hitInvalidChar = true;
+                invalidCharPos = start;
+                break;
+            }
+
+            if (CharacterClassifier::isQuoteChar(prevChar))
+            {
+                bool hasMatchingQuote = false;
+
+                if (start > 1 && start > effectiveMin + 1)
+                {
+                    if (data[start - 2] == prevChar)
+                    {
+                        --start;
+                        ++charsScanned;
+                        continue;
+                    }
+                }
+
+                if (end < len && data[end] == prevChar)
+                {
+                    if (end + 1 < len && data[end + 1] == prevChar)
+                    {
+                        --start;
+                        ++charsScanned;
+                        continue;
+                    }
+                    hasMatchingQuote = true;
+                }
+
+                if (hasMatchingQuote)
+                {
+                    break;
+                }
+                else
+                {
+                    if (start > 1 && start > effectiveMin + 1)
+                    {
+                        unsigned char prevPrevChar = static_cast<unsigned char>(data[start - 2]);
+                        if (prevPrevChar == '=' || prevPrevChar == ':' ||
+                            CharacterClassifier::isScanBoundary(prevPrevChar) ||
+                            CharacterClassifier::isQuoteChar(prevPrevChar))
+                        {
+                            --start;
+                            ++charsScanned;
+                            continue;
+                        }
+                    }
+                    else if (start == effectiveMin + 1)
+                    {
+                        --start;
+                        ++charsScanned;
+                        break;
+                    }
+                    --start;
+                    ++charsScanned;
+                    continue;
+                }
+            }
+
+            if (prevChar == '.')
+            {
+                --start;
+            }
+            else if (CharacterClassifier::isAtext(prevChar))
+            {
+                --start;
+            }
+            else
+            {
+                break;
+            }
+
+            ++charsScanned;
+        }
+
+        if (hitInvalidChar)
+        {
+            size_t recoveryPos = findFirstAlnum(data, len, std::max(invalidCharPos, effectiveMin), atPos);
+
+            if (recoveryPos != SIZE_MAX)
+            {
+                start = recoveryPos;
+                didRecovery = true;
+            }
+            else
+            {
+                recoveryPos = findFirstAtext(data, len, std::max(invalidCharPos, effectiveMin), atPos);
+                if (recoveryPos != SIZE_MAX)
+                {
+                    start = recoveryPos;
+                    didRecovery = true;
+                }
+                else
+                {
+                    size_t skip = std::min(invalidCharPos + 1, len);
+                    return {atPos, atPos, false, skip, false};
+                }
+            }
+        }
+
+        while (start < atPos && data[start] == '.')
+        {
+            PRODUCTION_CHECK_BOUNDARIES(start < len, "findEmailBoundaries leading dot removal", atPos);
+            ++start;
+        }
+
+        if (start < atPos && start > effectiveMin && start > 0)
+        {
+            unsigned char charBeforeStart = static_cast<unsigned char>(data[start - 1]);
+            if (CharacterClassifier::isInvalidLocalChar(charBeforeStart))
+            {
+                size_t firstAlnum = findFirstAlnum(data, len, start, atPos);
+                if (firstAlnum != SIZE_MAX)
+                {
+                    start = firstAlnum;
+                }
+            }
+        }
+
+        if (UNLIKELY(start >= atPos))
+        {
+            size_t skip = std::min(atPos + 1, len);
+            return {atPos, atPos, false, skip, false};
+        }
+
+        static constexpr size_t MAX_LOCAL_PART = 64;
+        if ((atPos - start) > MAX_LOCAL_PART)
+        {
+            didTrim = true;
+            start = atPos - MAX_LOCAL_PART;
+
+            while (start < atPos && data[start] == '.')
+            {
+                PRODUCTION_CHECK_BOUNDARIES(start < len, "findEmailBoundaries trimming dot removal", atPos);
+                ++start;
+            }
+
+            if (start > effectiveMin && start > 0)
+            {
+                unsigned char prevChar = static_cast<unsigned char>(data[start - 1]);
+
+                if (!CharacterClassifier::isScanBoundary(prevChar) &&
+                    !CharacterClassifier::isInvalidLocalChar(prevChar) &&
+                    prevChar != '@' && prevChar != '.' && prevChar != '=' &&
+                    prevChar != '\'' && prevChar != '`' && prevChar != '"' &&
+                    prevChar != '/')
+                {
+                    size_t firstValid = findFirstAlnum(data, len, start, atPos);
+                    if (firstValid != SIZE_MAX && firstValid < atPos)
+                    {
+                        start = firstValid;
+                    }
+                    else
+                    {
+                        firstValid = findFirstAtext(data, len, start, atPos);
+                        if (firstValid != SIZE_MAX && firstValid < atPos)
+                        {
+                            start = firstValid;
+                        }
+                    }
+                }
+            }
+
+            if ((atPos - start) > MAX_LOCAL_PART)
+            {
+                start = atPos - MAX_LOCAL_PART;
+            }
+
+            while (start < atPos && data[start] == '.')
+            {
+                ++start;
+            }
+        }
+
+        bool validBoundaries = true;
+
+        if (start > effectiveMin && start > 0)
+        {
+            PRODUCTION_CHECK_BOUNDARIES(start - 1 < len, "findEmailBoundaries boundary validation", atPos);
+            unsigned char prevChar = static_cast<unsigned char>(data[start - 1]);
+
+            if (didTrim)
+            {
+                validBoundaries = true;
+            }
+            else if (didRecovery)
+            {
+                validBoundaries = !CharacterClassifier::isAlphaNum(prevChar);
+            }
+            else if (CharacterClassifier::isInvalidLocalChar(prevChar))
+            {
+                validBoundaries = true;
+            }
+            else if (!CharacterClassifier::isScanBoundary(prevChar) &&
+                     prevChar != '@' && prevChar != '.' && prevChar != '=' &&
+                     prevChar != '\'' && prevChar != '`' && prevChar != '"' &&
+                     prevChar != '/')
+            {
+                validBoundaries = false;
+            }
+
+            if (!didTrim && CharacterClassifier::isQuoteChar(prevChar) && start > effectiveMin + 1 && start >= 2)
+            {
+                unsigned char prevPrevChar = static_cast<unsigned char>(data[start - 2]);
+                if (CharacterClassifier::isScanBoundary(prevPrevChar) ||
+                    prevPrevChar == '=' || prevPrevChar == ':' ||
+                    CharacterClassifier::isQuoteChar(prevPrevChar))
+                {
+                    validBoundaries = true;
+                }
+            }
+
+            if (!didTrim && prevChar == '/' && start > effectiveMin + 1 && start >= 2)
+            {
+                if (data[start - 2] == '/')
+                {
+                    validBoundaries = true;
+                }
+            }
+        }
+
+        if (end < len && validBoundaries && !didTrimDomain)
+        {
+            PRODUCTION_CHECK_BOUNDARIES(end < len, "findEmailBoundaries right boundary", atPos);
+            unsigned char nextChar = static_cast<unsigned char>(data[end]);
+            if (!CharacterClassifier::isScanRightBoundary(nextChar) &&
+                nextChar != '\'' && nextChar != '`' && nextChar != '"' &&
+                nextChar != '@' && nextChar != '\\' && !CharacterClassifier::isAtext(nextChar))
+            {
+                validBoundaries = false;
+            }
+        }
+
+        return {start, end, validBoundaries, 0, didTrimDomain};
+    }
+
+    enum class MatchAction
+    {
+        CONTINUE,
+        STOP
+    };
+
+    struct LoopLimits
+    {
+        bool capIterations;
+        bool capAtSymbols;
+    };
+
+    // For skip-binary scans: which '@'s deserve a boundary search. Every '@' in a block that reads
+    // as text does; in a binary block only one inside a run of at least minRun printable bytes.
+    // A block is classified when the first '@' lands in it. The run test reads the 64 bytes on
+    // either side of the '@' as SIMD masks, so it costs no per-byte branches; the right-hand mask
+    // also locates the next '@', and rejected '@'s never reach the scan loop and its guards.
+    class BinaryRegionFilter
+    {
+    private:
+        static constexpr size_t BLOCK_BYTES = 4096;
+        // A block is binary when more than this share of its bytes could not be in a local part
+        static constexpr size_t BINARY_PERCENT = 50;
+        // The share is estimated from SAMPLE_BYTES at every SAMPLE_STRIDE bytes of the block
+        static constexpr size_t SAMPLE_STRIDE = 1024;
+        static constexpr size_t SAMPLE_BYTES = 64;
+        static constexpr size_t MAX_MIN_RUN = 64;
+
+        const char *data_;
+        size_t len_;
+        size_t minRun_;
+        size_t block_ = SIZE_MAX;
+        bool binary_ = false;
+
+        // Masks of the 64 bytes at start; bytes outside the text count as neither printable nor '@'
+        void masksAt(ptrdiff_t start, uint64_t &printable, uint64_t &at) const noexcept
+        {
+            const auto len = static_cast<ptrdiff_t>(len_);
+            if (start >= 0 && start + 64 <= len)
+            {
+                CharacterClassifier::textMasks64(data_ + start, printable, at);
+                return;
+            }
+
+            char padded[64] = {};
+            const ptrdiff_t from = std::max<ptrdiff_t>(start, 0);
+            const ptrdiff_t to = std::min<ptrdiff_t>(start + 64, len);
+            if (from < to)
+                std::memcpy(padded + (from - start), data_ + from, static_cast<size_t>(to - from));
+            CharacterClassifier::textMasks64(padded, printable, at);
+        }
+
+        void classify(size_t block) noexcept
+        {
+            block_ = block;
+            const size_t begin = block * BLOCK_BYTES;
+            const size_t blockEnd = std::min(len_, begin + BLOCK_BYTES);
+            size_t sampled = 0;
+            size_t invalid = 0;
+            for (size_t at = begin; at < blockEnd; at += SAMPLE_STRIDE)
+            {
+                const size_t size = std::min(blockEnd - at, SAMPLE_BYTES);
+                invalid += CharacterClassifier::countInvalidLocal(data_ + at, size);
+                sampled += size;
+            }
+            binary_ = invalid * 100 > sampled * BINARY_PERCENT;
+        }
+
+    public:
+        BinaryRegionFilter(std::string_view text, size_t minRun) noexcept
+            : data_(text.data()), len_(text.size()), minRun_(std::clamp<size_t>(minRun, 1, MAX_MIN_RUN))
+        {
+        }
+
+        // The first '@' at or after atPos worth examining, or the text length if there is none
+        [[nodiscard]] size_t nextCandidate(size_t atPos) noexcept
+        {
+            while (atPos < len_)
+            {
+                const size_t block = atPos / BLOCK_BYTES;
+                if (block != block_)
+                    classify(block);
+                if (!binary_)
+                    return atPos;
+
+                // Printable bytes from the '@' rightwards (at least the '@' itself) and leftwards
+                uint64_t right = 0;
+                uint64_t left = 0;
+                uint64_t ats = 0;
+                uint64_t unused = 0;
+                masksAt(static_cast<ptrdiff_t>(atPos), right, ats);
+                masksAt(static_cast<ptrdiff_t>(atPos) - 64, left, unused);
+                right = ~right;
+                left = ~left;
+                const size_t rightRun = right == 0 ? 64 : static_cast<size_t>(CharacterClassifier::countTrailingZeros64(right));
+                const size_t leftRun = left == 0 ? 64 : static_cast<size_t>(CharacterClassifier::countLeadingZeros64(left));
+                if (leftRun + rightRun >= minRun_)
+                    return atPos;
+
+                // '@'s in the rest of this short run are rejected too; the window often holds the next one
+                ats &= ~uint64_t{0} << rightRun;
+                if (ats != 0)
+                {
+                    atPos += static_cast<size_t>(CharacterClassifier::countTrailingZeros64(ats));
+                    continue;
+                }
+                const size_t from = atPos + 64;
+                const void *found = from < len_ ? std::memchr(data_ + from, '@', len_ - from) : nullptr;
+                atPos = found ? static_cast<size_t>(static_cast<const char *>(found) - data_) : len_;
+            }
+            return len_;
+        }
+    };
+
+    // Shared scanning loop behind contains(), extract() and forEachMatch(). Every validated
+    // candidate is handed to onMatch(start, end), which decides whether scanning goes on.
+    template <typename OnMatch>
+    static void scanLoop(std::string_view text, ScanReport &report, LoopLimits limits, const ScanOptions &options,
+                         OnMatch &&onMatch)
+    {
+        const size_t len = text.length();
+        const char *data = text.data();
+        size_t pos = 0;
+        size_t minScannedIndex = 0;
+        size_t lastConsumedEnd = 0;
+        size_t atSymbolsProcessed = 0;
+
+        std::atomic<size_t> totalOps{0};
+        OperationBatcher batcher;
+        batcher.local_count = 0;
+
+        static constexpr size_t MAX_SCAN_ITERATIONS = 100'000;
+        size_t iterations = 0;
+        static constexpr size_t MAX_TOTAL_CHARS_SCANNED = 1'000'000;
+        size_t totalCharsScanned = 0;
+
+        BinaryRegionFilter binaryFilter(text, std::max<size_t>(options.minPrintableRun, 1));
+
+        report.bytesScanned = len;
+
+        while (pos < len)
+        {
+            if (limits.capIterations && iterations++ >= MAX_SCAN_ITERATIONS)
+            {
+                report.truncate(ScanLimit::SCAN_ITERATIONS);
+                break;
+            }
+
+            if (batcher.checkLimit(totalOps, MAX_TOTAL_OPERATIONS)) [[unlikely]]
+            {
+                report.truncate(ScanLimit::TOTAL_OPERATIONS);
+                break;
+            }
+
+            if (limits.capAtSymbols && UNLIKELY(atSymbolsProcessed >= MAX_AT_SYMBOLS))
+            {
+                report.truncate(ScanLimit::AT_SYMBOLS);
+                break;
+            }
+
+            auto atPosOpt = safe_memchr_index(data, pos, len, '@');
+            if (!atPosOpt)
+                break;
+
+            size_t atPos = *atPosOpt;
+
+            if (options.skipBinary)
+            {
+                atPos = binaryFilter.nextCandidate(atPos);
+                if (atPos >= len)
+                    break;
+            }
+
+            ++atSymbolsProcessed;
+
+            if (UNLIKELY(atPos < 1 || atPos >= len - 3))
+            {
+                pos = atPos + 1;
+                continue;
+            }
+
+            if (atPos < lastConsumedEnd)
+            {
+                pos = atPos + 1;
+                continue;
+            }
+
+            auto boundaries = findEmailBoundaries(text, atPos, minScannedIndex, totalOps, batcher, options.strictTld);
+
+            size_t charsScanned = 0;
+            size_t temp = 0;
+
+            if (!safe_add(safe_subtract(atPos, boundaries.start),
+                          safe_subtract(boundaries.end, atPos), temp))
+            {
+                report.truncate(ScanLimit::TOTAL_CHARS_SCANNED);
+                break;
+            }
+
+            charsScanned = temp;
+
+            if (charsScanned > MAX_BACKTRACK_PER_AT)
+            {
+                pos = atPos + 1;
+                continue;
+            }
+
+            if (!safe_add(totalCharsScanned, charsScanned, totalCharsScanned) ||
+                totalCharsScanned > MAX_TOTAL_CHARS_SCANNED)
+            {
+                report.truncate(ScanLimit::TOTAL_CHARS_SCANNED);
+                break;
+            }
+
+            if (!boundaries.validBoundaries)
+            {
+                if (boundaries.skipTo > 0)
+                    pos = boundaries.skipTo;
+                else
+                    pos = atPos + 1;
+                continue;
+            }
+
+            LocalPartValidator::ValidationMode mode = LocalPartValidator::ValidationMode::SCAN;
+            if (boundaries.start < atPos && boundaries.start < len &&
+                text[boundaries.start] == '"')
+            {
+                mode = LocalPartValidator::ValidationMode::EXACT;
+            }
+
+            bool localValid = LocalPartValidator::validate(text, boundaries.start, atPos, mode);
+            bool domainValid = boundaries.didTrimDomain ||
+                               (options.domainCache != nullptr
+                                    ? options.domainCache->validate(text.substr(atPos + 1, boundaries.end - atPos - 1))
+                                    : DomainPartValidator::validate(text, atPos + 1, boundaries.end));
+
+            if (localValid && domainValid)
+            {
+                if (UNLIKELY(boundaries.start >= len ||
+                             boundaries.end > len ||
+                             boundaries.start >= boundaries.end))
+                {
+                    pos = atPos + 1;
+                    continue;
+                }
+
+                const bool listed =
+                    (options.domainRules == nullptr ||
+                     options.domainRules->shouldReport(text.substr(atPos + 1, boundaries.end - atPos - 1))) &&
+                    (options.knownEmails == nullptr ||
+                     options.knownEmails->contains(text.substr(boundaries.start, boundaries.end - boundaries.start)));
+                if (listed && onMatch(boundaries.start, boundaries.end) == MatchAction::STOP)
+                    return;
+
+                minScannedIndex = std::max(minScannedIndex, boundaries.start);
+                lastConsumedEnd = std::max(lastConsumedEnd, boundaries.end);
+                pos = boundaries.end;
+                continue;
+            }
+
+            pos = atPos + 1;
+        }
+
+        if (totalOps.load(std::memory_order_relaxed) > MAX_TOTAL_OPERATIONS)
+            report.truncate(ScanLimit::TOTAL_OPERATIONS);
+    }
+
+    // Redaction's walk over text: onMatch(start, end) sees every match in text order, found by one
+    // scanLoop per REDACT_WINDOW bytes with MAX_LEFT_SCAN bytes of context before it. Returns how
+    // much of text was fully scanned: all of it, or, if a window was still truncated (the report
+    // says by what), only up to the end of the last match visited.
+    template <typename OnMatch>
+    static size_t scanWindows(std::string_view text, ScanReport &report, const ScanOptions &options,
+                              OnMatch &&onMatch)
+    {
+        const size_t len = text.length();
+        size_t scanned = 0;
+        size_t consumed = 0;
+
+        while (scanned < len)
+        {
+            const size_t viewStart = safe_subtract(scanned, MAX_LEFT_SCAN);
+            const size_t viewEnd = std::min(len, scanned + REDACT_WINDOW);
+            const bool final = viewEnd == len;
+            const size_t safeEnd = final ? len : viewEnd - REDACT_HOLDBACK;
+
+            ScanReport round;
+            scanLoop(text.substr(viewStart, viewEnd - viewStart), round, {false, false}, options,
+                     [&](size_t start, size_t end)
+                     {
+                         start += viewStart;
+                         end += viewStart;
+                         if (end > safeEnd)
+                             return MatchAction::STOP;
+                         if (start < consumed)
+                             return MatchAction::CONTINUE;
+
+                         onMatch(start, end);
+                         consumed = end;
+                         return MatchAction::CONTINUE; });
+
+            if (round.wasTruncated())
+            {
+                report.truncate(round.truncatedBy);
+                return consumed;
+            }
+
+            // A match not found yet ends past safeEnd, so it starts at most MAX_BACKTRACK_PER_AT before it
+            scanned = final ? len : std::max(consumed, safeEnd - MAX_BACKTRACK_PER_AT);
+        }
+
+        return len;
+    }
+
+    // Stack buffer writeReplacement renders masks and hash digits into; SHAPE stores whole vectors,
+    // so it has room for a match rounded up to 16 bytes
+    static constexpr size_t REPLACEMENT_BUFFER = MAX_BACKTRACK_PER_AT + 16;
+
+    [[nodiscard]] static FORCE_INLINE bool isShapeDelimiter(char c) noexcept
+    {
+        return c == '.' || c == '@' || c == '"';
+    }
+
+    // SHAPE rendering of email (at most MAX_BACKTRACK_PER_AT bytes) into out. A byte is kept when it
+    // is a delimiter ('.', '@', '"'), or when the byte before it is one and the byte after it is
+    // not: that keeps the first byte of every segment and label longer than one byte, so a one-byte
+    // segment (the a of a@b.co) is masked rather than left whole. The rest become maskChar, sixteen
+    // bytes per compare-and-blend. The TLD is then copied back whole.
+    static void renderShape(std::string_view email, char maskChar, char *out) noexcept
+    {
+        const size_t len = email.size();
+
+        // Delimiters on both sides, so the first byte counts as a segment start and the last as an end
+        char padded[REPLACEMENT_BUFFER + 32];
+        padded[0] = '.';
+        std::memcpy(padded + 1, email.data(), len);
+
+#if defined(__SSE2__) || defined(_M_X64)
+        std::memset(padded + 1 + len, 0, 16);
+        padded[1 + len] = '.';
+
+        const __m128i dot = _mm_set1_epi8('.');
+        const __m128i at = _mm_set1_epi8('@');
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i fill = _mm_set1_epi8(maskChar);
+        auto delimiters = [&](__m128i v)
+        {
+            return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, dot), _mm_cmpeq_epi8(v, at)),
+                                _mm_cmpeq_epi8(v, quote));
+        };
+
+        for (size_t i = 0; i < len; i += 16)
+        {
+            const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i *>(padded + 1 + i));
+            const __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i *>(padded + i));
+            const __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i *>(padded + 2 + i));
+            const __m128i keep = _mm_or_si128(delimiters(current),
+                                              _mm_andnot_si128(delimiters(next), delimiters(previous)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                             _mm_or_si128(_mm_and_si128(keep, current), _mm_andnot_si128(keep, fill)));
+        }
+#else
+        padded[1 + len] = '.';
+        for (size_t i = 0; i < len; ++i)
+            out[i] = isShapeDelimiter(padded[i + 1]) || (isShapeDelimiter(padded[i]) && !isShapeDelimiter(padded[i + 2]))
+                         ? padded[i + 1]
+                         : maskChar;
+#endif
+
+        const size_t atPos = email.rfind('@');
+        const size_t lastDot = email.rfind('.');
+        if (atPos != std::string_view::npos && lastDot != std::string_view::npos && lastDot > atPos)
+            std::memcpy(out + lastDot + 1, email.data() + lastDot + 1, len - lastDot - 1);
+    }
+
+    [[nodiscard]] static size_t replacementLength(size_t emailLength, const RedactionPolicy &policy) noexcept
+    {
+        switch (policy.mode)
+        {
+        case RedactionMode::MASK:
+        case RedactionMode::SHAPE:
+            return emailLength;
+        case RedactionMode::TOKEN:
+            return policy.token.size();
+        case RedactionMode::HASH:
+            return policy.hashPrefix.size() + 16;
+        case RedactionMode::PSEUDONYM:
+            return policy.pseudonymizer ? policy.pseudonymizer->prefix().size() + 16 : emailLength;
+        }
+        return emailLength;
+    }
+
+public:
+    [[nodiscard]] static bool contains(std::string_view text) noexcept
+    {
+        ScanReport report;
+        return contains(text, report);
+    }
+
+    [[nodiscard]] static bool contains(std::string_view text, ScanReport &report,
+                                       const ScanOptions &options = {}) noexcept
+    {
+        report = ScanReport{};
+
+        try
+        {
+            const size_t len = text.length();
+
+            if (UNLIKELY(len > MAX_INPUT_SIZE))
+            {
+                report.rejectedOversize = true;
+                return false;
+            }
+
+            if (UNLIKELY(len < 5))
+                return false;
+
+            if (UNLIKELY(text.data() == nullptr && len > 0))
+                return false;
+
+            bool found = false;
+            scanLoop(text, report, {false, false}, options, [&found](size_t, size_t)
+                     {
+                         found = true;
+                         return MatchAction::STOP; });
+
+            report.emailsFound = found ? 1 : 0;
+            return found;
+        }
+        catch (...)
+        {
+            ThreadSafeErrorCounter::recordError();
+            return false;
+        }
+    }
+
+    [[nodiscard]] static std::vector<std::string> extract(std::string_view text) noexcept
+    {
+        ScanReport report;
+        return extract(text, report);
+    }
+
+    [[nodiscard]] static std::vector<std::string> extract(std::string_view text, ScanReport &report,
+                                                          const ScanOptions &options = {}) noexcept
+    {
+        std::vector<std::string> emails;
+        report = ScanReport{};
+
+        try
+        {
+            const size_t len = text.length();
+
+            if (UNLIKELY(len > MAX_INPUT_SIZE))
+            {
+                report.rejectedOversize = true;
+                return emails;
+            }
+
+            if (UNLIKELY(len < 5))
+                return emails;
+
+            if (UNLIKELY(text.data() == nullptr && len > 0))
+                return emails;
+
+            size_t initial_reserve = std::min({MAX_INITIAL_RESERVE,
+                                               len / 30,
+                                               static_cast<size_t>(10)});
+
+            emails.reserve(initial_reserve);
+
+            std::unordered_set<std::string> seen;
+            size_t expected_unique = std::min({len / 30,
+                                               MAX_EMAILS_EXTRACT,
+                                               MAX_SEEN_SET_SIZE});
+
+            size_t reserve_size = 0;
+            if (safe_add(expected_unique * 13 / 10, 1, reserve_size))
+            {
+                reserve_size = std::min(reserve_size, MAX_SEEN_SET_SIZE);
+                seen.reserve(reserve_size);
+            }
+
+            size_t extractedCount = 0;
+            size_t estimatedMemory = 0;
+
+            scanLoop(text, report, {true, true}, options, [&](size_t start, size_t end)
+                     {
+                if (UNLIKELY(extractedCount >= MAX_EMAILS_EXTRACT))
+                {
+                    report.truncate(ScanLimit::EMAILS_EXTRACT);
+                    return MatchAction::STOP;
+                }
+
+                std::string email(text.substr(start, end - start));
+
+                size_t emailMemory = email.length() + sizeof(std::string) +
+                                     sizeof(void *) * 2;
+                size_t newMemory = 0;
+
+                if (!safe_add(estimatedMemory, emailMemory, newMemory) ||
+                    newMemory > MAX_MEMORY_BUDGET)
+                {
+                    report.truncate(ScanLimit::MEMORY_BUDGET);
+                    return MatchAction::STOP;
+                }
+
+                if (seen.size() >= MAX_SEEN_SET_SIZE)
+                {
+                    report.truncate(ScanLimit::SEEN_SET_SIZE);
+                    return MatchAction::STOP;
+                }
+
+                if (emails.size() >= emails.capacity())
+                {
+                    size_t new_capacity = emails.size() + 1;
+                    size_t additional_memory = new_capacity * sizeof(std::string);
+
+                    if (!safe_add(newMemory, additional_memory, newMemory) ||
+                        newMemory > MAX_MEMORY_BUDGET)
+                    {
+                        report.truncate(ScanLimit::MEMORY_BUDGET);
+                        return MatchAction::STOP;
+                    }
+
+                    emails.reserve(new_capacity);
+                }
+
+                auto [it, inserted] = seen.insert(email);
+
+                if (inserted)
+                {
+                    try
+                    {
+                        emails.push_back(std::move(email));
+                        estimatedMemory = newMemory;
+                        ++extractedCount;
+                    }
+                    catch (...)
+                    {
+                        seen.erase(it);
+                        ThreadSafeErrorCounter::recordError();
+                        return MatchAction::STOP;
+                    }
+                }
+
+                return MatchAction::CONTINUE; });
+        }
+        catch (const std::bad_alloc &)
+        {
+            ThreadSafeErrorCounter::recordError();
+            emails.clear();
+        }
+        catch (const std::length_error &)
+        {
+            ThreadSafeErrorCounter::recordError();
+            emails.clear();
+        }
+        catch (...)
+        {
+            ThreadSafeErrorCounter::recordError();
+            emails.clear();
+        }
+
+        report.emailsFound = emails.size();
+        return emails;
+    }
+
+    // extract(), with each distinct address (as written) replaced by its pseudonym under the tenant's key
+    [[nodiscard]] static std::vector<std::string> extractPseudonyms(std::string_view text, ScanReport &report,
+                                                                    const EmailPseudonymizer &pseudonymizer,
+                                                                    const ScanOptions &options = {}) noexcept
+    {
+        std::vector<std::string> emails = extract(text, report, options);
+
+        try
+        {
+            for (auto &email : emails)
+                email = pseudonymizer.pseudonym(email);
+        }
+        catch (...)
+        {
+            ThreadSafeErrorCounter::recordError();
+            emails.clear();
+        }
+
+        return emails;
+    }
+
+    // Visits every match (duplicates included) in text order as offsets into text.
+    // The visitor is called as visitor(start, end) and returns false to stop the scan.
+    template <typename Visitor>
+    static void forEachMatch(std::string_view text, ScanReport &report, Visitor &&visitor,
+                             const ScanOptions &options = {}) noexcept
+    {
+        report = ScanReport{};
+
+        try
+        {
+            const size_t len = text.length();
+
+            if (UNLIKELY(len > MAX_INPUT_SIZE))
+            {
+                report.rejectedOversize = true;
+                return;
+            }
+
+            if (UNLIKELY(len < 5 || text.data() == nullptr))
+                return;
+
+            scanLoop(text, report, {true, false}, options, [&](size_t start, size_t end)
+                     {
+                         ++report.emailsFound;
+                         return visitor(start, end) ? MatchAction::CONTINUE : MatchAction::STOP; });
+        }
+        catch (...)
+        {
+            ThreadSafeErrorCounter::recordError();
+        }
+    }
+
+    // 64-bit FNV-1a of the address with its domain lowercased, so User@Example.COM and
+    // User@example.com hash alike; the local part is kept as written. Stable across runs and builds.
+    [[nodiscard]] static uint64_t hashAddress(std::string_view email) noexcept
+    {
+        const size_t at = email.rfind('@');
+        uint64_t hash = 0xcbf29ce484222325ULL;
+
+        for (size_t i = 0; i < email.size(); ++i)
+        {
+            auto c = static_cast<unsigned char>(email[i]);
+            if (at != std::string_view::npos && i > at && c >= 'A' && c <= 'Z')
+                c = static_cast<unsigned char>(c + ('a' - 'A'));
+            hash = (hash ^ c) * 0x100000001b3ULL;
+        }
+
+        return hash;
+    }
+
+    // Passes the replacement for one matched address to sink(std::string_view) in one or two pieces
+    template <typename Sink>
+    static void writeReplacement(std::string_view email, const RedactionPolicy &policy, Sink &sink)
+    {
+        char buffer[REPLACEMENT_BUFFER];
+
+        RedactionMode mode = policy.mode;
+        if ((mode == RedactionMode::PSEUDONYM && policy.pseudonymizer == nullptr) ||
+            (mode == RedactionMode::SHAPE && email.size() > MAX_BACKTRACK_PER_AT))
+            mode = RedactionMode::MASK;
+
+        switch (mode)
+        {
+        case RedactionMode::MASK:
+        {
+            // Matches never exceed MAX_BACKTRACK_PER_AT bytes, so one buffer always covers them
+            const size_t length = std::min(email.size(), sizeof(buffer));
+            std::memset(buffer, static_cast<unsigned char>(policy.maskChar), length);
+            sink(std::string_view(buffer, length));
+            return;
+        }
+        case RedactionMode::TOKEN:
+            sink(policy.token);
+            return;
+        case RedactionMode::HASH:
+            EmailPseudonymizer::formatHex(hashAddress(email), buffer);
+            sink(policy.hashPrefix);
+            sink(std::string_view(buffer, 16));
+            return;
+        case RedactionMode::SHAPE:
+            renderShape(email, policy.maskChar, buffer);
+            sink(std::string_view(buffer, email.size()));
+            return;
+        case RedactionMode::PSEUDONYM:
+            EmailPseudonymizer::formatHex(policy.pseudonymizer->digest(email), buffer);
+            sink(std::string_view(policy.pseudonymizer->prefix()));
+            sink(std::string_view(buffer, 16));
+            return;
+        }
+    }
+
+    // Copies text to sink(std::string_view) with every match replaced per policy, in one pass: the
+    // bytes between matches go out as single slices. Oversize text produces no output (use
+    // EmailStreamRedactor). Redaction fails closed: if the report is truncated, output ends with the
+    // last address replaced and the rest of text, which was not fully scanned, is withheld.
+    template <typename Sink>
+    static void redact(std::string_view text, const RedactionPolicy &policy, ScanReport &report, Sink &&sink,
+                       const ScanOptions &options = {}) noexcept
+    {
+        report = ScanReport{};
+
+        try
+        {
+            const size_t len = text.length();
+
+            if (UNLIKELY(len > MAX_INPUT_SIZE))
+            {
+                report.rejectedOversize = true;
+                return;
+            }
+
+            if (UNLIKELY(text.data() == nullptr && len > 0))
+                return;
+
+            report.bytesScanned = len;
+
+            size_t copied = 0;
+            size_t scanned = len;
+            if (len >= 5)
+            {
+                scanned = scanWindows(text, report, options, [&](size_t start, size_t end)
+                                      {
+                                          if (start > copied)
+                                              sink(text.substr(copied, start - copied));
+                                          writeReplacement(text.substr(start, end - start), policy, sink);
+                                          copied = end;
+                                          ++report.emailsFound; });
+            }
+
+            if (scanned == len && copied < len)
+                sink(text.substr(copied));
+        }
+        catch (...)
+        {
+            ThreadSafeErrorCounter::recordError();
+        }
+    }
+
+    // Appends the redacted text to out
+    static void redact(std::string_view text, std::string &out, const RedactionPolicy &policy,
+                       ScanReport &report, const ScanOptions &options = {}) noexcept
+    {
+        try
+        {
+            out.reserve(out.size() + text.size());
+        }
+        catch (...)
+        {
+            ThreadSafeErrorCounter::recordError();
+            report = ScanReport{};
+            return;
+        }
+
+        redact(text, policy, report, [&out](std::string_view piece)
+               { out.append(piece); }, options);
+    }
+
+    static void redact(std::string_view text, std::string &out, const RedactionPolicy &policy = {}) noexcept
+    {
+        ScanReport report;
+        redact(text, out, policy, report);
+    }
+
+    // Redacts data[0, len) in place and returns the new length. Replacements never grow the text: a
+    // match shorter than its token or hash is masked instead. The scan runs on the original bytes;
+    // the edits are applied afterwards in one forward pass that moves each gap once. If the report
+    // is truncated, the text is cut after the last address replaced, as redact() withholds it.
+    [[nodiscard]] static size_t redactInPlace(char *data, size_t len, const RedactionPolicy &policy,
+                                              ScanReport &report, const ScanOptions &options = {}) noexcept
+    {
+        report = ScanReport{};
+
+        try
+        {
+            if (UNLIKELY(len > MAX_INPUT_SIZE))
+            {
+                report.rejectedOversize = true;
+                return len;
+            }
+
+            if (UNLIKELY(len < 5 || data == nullptr))
+                return len;
+
+            report.bytesScanned = len;
+
+            const std::string_view text(data, len);
+            std::vector<std::pair<size_t, size_t>> matches;
+            const size_t scanned = scanWindows(text, report, options, [&matches](size_t start, size_t end)
+                                               { matches.emplace_back(start, end); });
+
+            size_t write = 0;
+            size_t read = 0;
+            for (const auto &[start, end] : matches)
+            {
+                if (start > read && write != read)
+                    std::memmove(data + write, data + read, start - read);
+                write += start - read;
+
+                RedactionPolicy effective = policy;
+                if (replacementLength(end - start, policy) > end - start)
+                    effective.mode = RedactionMode::MASK;
+
+                // Replacements land at or before the match, never past bytes still to be moved
+                auto sink = [&data, &write](std::string_view piece)
+                {
+                    std::memmove(data + write, piece.data(), piece.size());
+                    write += piece.size();
+                };
+                writeReplacement(std::string_view(data + start, end - start), effective, sink);
+                read = end;
+            }
+
+            if (scanned < len)
+                len = read;
+            if (read < len && write != read)
+                std::memmove(data + write, data + read, len - read);
+            write += len - read;
+
+            report.emailsFound = matches.size();
+            return write;
+        }
+        catch (...)
+        {
+            ThreadSafeErrorCounter::recordError();
+            return len;
+        }
+    }
+
+    static void redactInPlace(std::string &text, const RedactionPolicy &policy, ScanReport &report,
+                              const ScanOptions &options = {}) noexcept
+    {
+        text.resize(redactInPlace(text.data(), text.size(), policy, report, options));
+    }
+
+    [[nodiscard]] static constexpr size_t getMaxInputSize() noexcept
+    {
+        return MAX_INPUT_SIZE;
+    }
+
+    // Longest span a match can cover; streaming callers hold back this much to keep matches whole
+    [[nodiscard]] static constexpr size_t getMaxMatchLength() noexcept
+    {
+        return MAX_BACKTRACK_PER_AT;
+    }
+
+    // Largest window redaction scans in one pass; EmailStreamRedactor keeps its window within it
+    [[nodiscard]] static constexpr size_t getRedactWindow() noexcept
+    {
+        return REDACT_WINDOW;
+    }
+};
+
+// ====================================================================================================
+// EMAIL STREAM SCANNER (Chunked input, absolute offsets)
+// ====================================================================================================
+
+class EmailStreamScanner final
+{
+public:
+    static constexpr size_t DEFAULT_WINDOW_SIZE = 64 * 1024;
+    static constexpr size_t MIN_WINDOW_SIZE = 4 * 1024;
+    // Left context kept behind the emit horizon so boundary detection sees what a whole-buffer scan would
+    static constexpr size_t CONTEXT_BYTES = 4096;
+    // Matches ending inside the buffered tail wait for more input (domain limit + right boundary)
+    static constexpr size_t HOLDBACK_BYTES = 512;
+
+private:
+    size_t windowSize_;
+    ScanOptions options_;
+    std::string buffer_;
+    uint64_t bufferOffset_ = 0;
+    uint64_t emittedEnd_ = 0;
+    ScanReport report_;
+
+    [[nodiscard]] size_t capacity() const noexcept
+    {
+        return windowSize_ + CONTEXT_BYTES + HOLDBACK_BYTES;
+    }
+
+    template <typename OnMatch>
+    void processBuffer(bool final, OnMatch &onMatch)
+    {
+        if (buffer_.empty())
+            return;
+
+        const std::string_view view(buffer_);
+        const size_t safeEnd = final ? view.size() : safe_subtract(view.size(), HOLDBACK_BYTES);
+
+        ScanReport round;
+        EmailScanner::forEachMatch(view, round, [&](size_t start, size_t end)
+                                   {
+                                       if (end > safeEnd)
+                                           return false;
+
+                                       const uint64_t absoluteStart = bufferOffset_ + start;
+                                       if (absoluteStart < emittedEnd_)
+                                           return true;
+
+                                       onMatch(view.substr(start, end - start), absoluteStart);
+                                       emittedEnd_ = bufferOffset_ + end;
+                                       ++report_.emailsFound;
+                                       return true; },
+                                   options_);
+
+        report_.truncate(round.truncatedBy);
+
+        if (!final)
+        {
+            const size_t keepFrom = safe_subtract(safeEnd, CONTEXT_BYTES);
+            buffer_.erase(0, keepFrom);
+            bufferOffset_ += keepFrom;
+        }
+    }
+
+public:
+    explicit EmailStreamScanner(size_t windowSize = DEFAULT_WINDOW_SIZE, const ScanOptions &options = {})
+        : windowSize_(std::clamp(windowSize, MIN_WINDOW_SIZE,
+                                 EmailScanner::getMaxInputSize() - CONTEXT_BYTES - HOLDBACK_BYTES)),
+          options_(options)
+    {
+        buffer_.reserve(capacity());
+    }
+
+    // Scans the next piece of the stream; onMatch(std::string_view email, uint64_t offset) receives
+    // each match once, with its offset counted from the first byte ever fed.
+    template <typename OnMatch>
+    void feed(std::string_view chunk, OnMatch &&onMatch) noexcept
+    {
+        try
+        {
+            report_.bytesScanned += chunk.size();
+
+            while (!chunk.empty())
+            {
+                const size_t take = std::min(chunk.size(), capacity() - buffer_.size());
+                buffer_.append(chunk.data(), take);
+                chunk.remove_prefix(take);
+
+                if (buffer_.size() >= capacity())
+                    processBuffer(false, onMatch);
+            }
+        }
+        catch (...)
+        {
+            ThreadSafeErrorCounter::recordError();
+        }
+    }
+
+    // Flushes the buffered tail; the next feed() starts a new stream at offset 0
+    template <typename OnMatch>
+    void finish(OnMatch &&onMatch) noexcept
+    {
+        try
+        {
+            processBuffer(true, onMatch);
+        }
+        catch (...)
+        {
+            ThreadSafeErrorCounter::recordError();
+        }
+
+        buffer_.clear();
+        bufferOffset_ = 0;
+        emittedEnd_ = 0;
+    }
+
+    void reset() noexcept
+    {
+        buffer_.clear();
+        bufferOffset_ = 0;
+        emittedEnd_ = 0;
+        report_ = ScanReport{};
+    }
+
+    // Totals since the last reset() (bytes fed, emails emitted, first limit that truncated a window)
+    [[nodiscard]] const ScanReport &getReport() const noexcept
+    {
+        return report_;
+    }
+
+    [[nodiscard]] size_t getWindowSize() const noexcept
+    {
+        return windowSize_;
+    }
+};
+
+// ====================================================================================================
+// EMAIL STREAM REDACTOR (Chunked input, redacted output)
+// ====================================================================================================
+
+class EmailStreamRedactor final
+{
+public:
+    // Output lags input by at most this much plus SETTLE_BYTES and the HOLDBACK_BYTES tail
+    static constexpr size_t DEFAULT_WINDOW_SIZE = EmailStreamScanner::DEFAULT_WINDOW_SIZE;
+    static constexpr size_t MIN_WINDOW_SIZE = EmailStreamScanner::MIN_WINDOW_SIZE;
+    static constexpr size_t CONTEXT_BYTES = EmailStreamScanner::CONTEXT_BYTES;
+    static constexpr size_t HOLDBACK_BYTES = EmailStreamScanner::HOLDBACK_BYTES;
+    // A window fits in one redaction pass, so the scan limits stop it only on pathological input
+    static constexpr size_t MAX_WINDOW_SIZE = EmailScanner::getRedactWindow() - CONTEXT_BYTES - HOLDBACK_BYTES;
+    // A match not yet found ends past the holdback horizon and so starts within this many bytes of it
+    static constexpr size_t SETTLE_BYTES = 512;
+    static_assert(SETTLE_BYTES >= EmailScanner::getMaxMatchLength(), "unsettled matches could be written out");
+
+private:
+    // One output slice: window bytes, or rendered replacement bytes in replacements_
+    struct Piece
+    {
+        size_t offset;
+        size_t length;
+        bool replacement;
+    };
+
+    size_t windowSize_;
+    RedactionPolicy policy_;
+    ScanOptions options_;
+    // Fixed window; input is appended at size_, so callers can read() straight into it
+    std::unique_ptr<char[]> buffer_;
+    size_t size_ = 0;
+    uint64_t bufferOffset_ = 0;
+    // Absolute offset up to which input has been written out, redacted
+    uint64_t writtenEnd_ = 0;
+    std::string replacements_;
+    std::vector<Piece> pieces_;
+    ScanReport report_;
+
+    [[nodiscard]] size_t capacity() const noexcept
+    {
+        return windowSize_ + CONTEXT_BYTES + HOLDBACK_BYTES;
+    }
+
+    // Redacts the window up to safeEnd, writes out everything before settled, then hands the batch to
+    // sink: one call per piece and a final empty piece. Pieces stay valid until the empty piece. A
+    // truncated scan fails closed: the batch ends with the last address replaced and the window is
+    // dropped, bytes not yet scanned included.
+    template <typename Sink>
+    void processWindow(size_t safeEnd, size_t settled, bool final, Sink &sink)
+    {
+        const std::string_view view(buffer_.get(), size_);
+        size_t written = static_cast<size_t>(writtenEnd_ - bufferOffset_);
+        replacements_.clear();
+        pieces_.clear();
+
+        auto render = [this](std::string_view piece)
+        {
+            pieces_.push_back({replacements_.size(), piece.size(), true});
+            replacements_.append(piece);
+        };
+
+        ScanReport round;
+        EmailScanner::forEachMatch(view, round, [&](size_t start, size_t end)
+                                   {
+                                       if (end > safeEnd)
+                                           return false;
+                                       if (start < written)
+                                           return true;
+
+                                       if (start > written)
+                                           pieces_.push_back({written, start - written, false});
+                                       EmailScanner::writeReplacement(view.substr(start, end - start), policy_, render);
+                                       written = end;
+                                       ++report_.emailsFound;
+                                       return true; },
+                                   options_);
+
+        if (round.wasTruncated())
+        {
+            report_.truncate(round.truncatedBy);
+            settled = written;
+        }
+
+        if (settled > written)
+        {
+            pieces_.push_back({written, settled - written, false});
+            written = settled;
+        }
+        writtenEnd_ = bufferOffset_ + written;
+
+        for (const Piece &piece : pieces_)
+        {
+            const char *base = piece.replacement ? replacements_.data() : buffer_.get();
+            sink(std::string_view(base + piece.offset, piece.length));
+        }
+        sink(std::string_view());
+
+        if (report_.wasTruncated())
+        {
+            size_ = 0;
+        }
+        else if (!final)
+        {
+            const size_t keepFrom = std::min(safe_subtract(safeEnd, CONTEXT_BYTES), written);
+            std::memmove(buffer_.get(), buffer_.get() + keepFrom, size_ - keepFrom);
+            size_ -= keepFrom;
+            bufferOffset_ += keepFrom;
+        }
+    }
+
+    template <typename Sink>
+    void processFull(Sink &sink)
+    {
+        // Matches ending inside the tail wait for the next window
+        const size_t safeEnd = safe_subtract(size_, HOLDBACK_BYTES);
+        processWindow(safeEnd, safe_subtract(safeEnd, SETTLE_BYTES), false, sink);
+    }
+
+public:
+    explicit EmailStreamRedactor(const RedactionPolicy &policy = {}, size_t windowSize = DEFAULT_WINDOW_SIZE,
+                                 const ScanOptions &options = {})
+        : windowSize_(std::clamp(windowSize, MIN_WINDOW_SIZE, MAX_WINDOW_SIZE)),
+          policy_(policy), options_(options), buffer_(new char[capacity()])
+    {
+    }
+
+    // Consumes the next piece of the stream. Redacted output goes to sink(std::string_view) in
+    // batches as it settles: each batch ends with an empty piece, and its pieces point into the
+    // redactor until then, so a sink may queue them for one writev() rather than copy them.
+    // Concatenated, the pieces are the redacted stream. Once the report is truncated, input is
+    // dropped and nothing more is written until reset().
+    template <typename Sink>
+    void feed(std::string_view chunk, Sink &&sink) noexcept
+    {
+        while (!chunk.empty())
+        {
+            const size_t take = std::min(chunk.size(), writableSize());
+            std::memcpy(writableData(), chunk.data(), take);
+            chunk.remove_prefix(take);
+            commit(take, sink);
+        }
+    }
+
+    // Free window space, for reading input in place of feed(): read up to writableSize() bytes into
+    // writableData(), then commit() them. Never empty between calls.
+    [[nodiscard]] char *writableData() noexcept
+    {
+        return buffer_.get() + size_;
+    }
+
+    [[nodiscard]] size_t writableSize() const noexcept
+    {
+        return capacity() - size_;
+    }
+
+    template <typename Sink>
+    void commit(size_t bytes, Sink &&sink) noexcept
+    {
+        try
+        {
+            bytes = std::min(bytes, writableSize());
+            report_.bytesScanned += bytes;
+            if (report_.wasTruncated())
+                return;
+
+            size_ += bytes;
+
+            if (size_ >= capacity())
+                processFull(sink);
+        }
+        catch (...)
+        {
+            ThreadSafeErrorCounter::recordError();
+        }
+    }
+
+    // Writes out every buffered complete line, for when input goes quiet: no address spans a line
+    // break, so everything before the last '\n' is final. Returns false if there is none.
+    template <typename Sink>
+    bool flushLines(Sink &&sink) noexcept
+    {
+        try
+        {
+            const size_t written = static_cast<size_t>(writtenEnd_ - bufferOffset_);
+            if (report_.wasTruncated() || size_ <= written)
+                return false;
+
+            const size_t newline = std::string_view(buffer_.get(), size_).rfind('\n');
+            if (newline == std::string_view::npos || newline < written)
+                return false;
+
+            processWindow(newline + 1, newline + 1, false, sink);
+            return true;
+        }
+        catch (...)
+        {
+            ThreadSafeErrorCounter::recordError();
+            return false;
+        }
+    }
+
+    // Writes out the buffered tail; the next feed() starts a new stream
+    template <typename Sink>
+    void finish(Sink &&sink) noexcept
+    {
+        try
+        {
+            if (size_ > 0 && !report_.wasTruncated())
+                processWindow(size_, size_, true, sink);
+        }
+        catch (...)
+        {
+            ThreadSafeErrorCounter::recordError();
+        }
+
+        size_ = 0;
+        bufferOffset_ = 0;
+        writtenEnd_ = 0;
+    }
+
+    void reset() noexcept
+    {
+        size_ = 0;
+        bufferOffset_ = 0;
+        writtenEnd_ = 0;
+        report_ = ScanReport{};
+    }
+
+    // Totals since the last reset() (bytes fed, addresses redacted, first limit that truncated a window)
+    [[nodiscard]] const ScanReport &getReport() const noexcept
+    {
+        return report_;
+    }
+
+    [[nodiscard]] size_t getWindowSize() const noexcept
+    {
+        return windowSize_;
+    }
+};
+
+// ====================================================================================================
+// DOCUMENT RESULT CACHE (extract results keyed by a 128-bit content hash, optional TTL)
+// ====================================================================================================
+
+// Chat, ticketing and mail systems resend identical payloads: templates, signatures, retries. This
+// cache answers extract() for a document it has seen before in the time it takes to hash it.
+// Documents are not stored; the key is a 128-bit hash of the bytes in the style of XXH3 (four
+// 64-bit lanes over 32-byte stripes, each folding a 32x32-bit product of the input and a secret),
+// with a secret drawn at random per cache so colliding documents cannot be prepared in advance.
+// The ScanOptions that change results are part of the key.
+//
+// Entries are spread over shards by hash. A lookup holds its shard's lock shared, so hits on one
+// shard run concurrently; a store holds it exclusively. Each shard gets an equal part of the
+// entry and byte budgets (the bytes are those of the cached addresses) and evicts by CLOCK when
+// either is exceeded. With a TTL, older entries count as misses and are replaced.
+//
+// Hashing is several times cheaper than extract() on text with addresses in it, which is where a
+// hit pays; below minBytes the lookup costs more than the scan and documents are scanned directly.
+// contains() is not cached: it stops at the first address and skips '@'-free text at memchr
+// speed, so hashing the whole document is always the slower way to answer it.
+class DocumentResultCache final
+{
+public:
+    static constexpr size_t SHARDS = 16;
+    static constexpr size_t DEFAULT_MIN_BYTES = 256;
+
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t bypassed = 0;
+        uint64_t expirations = 0;
+        uint64_t evictions = 0;
+        // Document bytes answered from the cache instead of being scanned
+        uint64_t bytesSaved = 0;
+        size_t entries = 0;
+        size_t resultBytes = 0;
+        size_t capacity = 0;
+
+        [[nodiscard]] double getHitRate() const noexcept
+        {
+            const uint64_t lookups = hits + misses + bypassed;
+            return lookups > 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+        }
+    };
+
+    struct ContentHash
+    {
+        uint64_t low = 0;
+        uint64_t high = 0;
+
+        [[nodiscard]] bool operator==(const ContentHash &other) const noexcept
+        {
+            return low == other.low && high == other.high;
+        }
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        ContentHash key;
+        Clock::time_point storedAt;
+        ScanReport report;
+        std::vector<std::string> emails;
+        size_t resultBytes = 0;
+        mutable std::atomic<bool> referenced{false};
+        bool used = false;
+    };
+
+    struct KeyHasher
+    {
+        [[nodiscard]] size_t operator()(const ContentHash &key) const noexcept
+        {
+            return static_cast<size_t>(key.high);
+        }
+    };
+
+    struct alignas(64) Shard
+    {
+        mutable std::shared_mutex mutex;
+        std::unique_ptr<Entry[]> entries;
+        std::unordered_map<ContentHash, size_t, KeyHasher> index;
+        size_t hand = 0;
+        size_t resultBytes = 0;
+        uint64_t evictions = 0;
+        uint64_t expirations = 0;
+    };
+
+    std::array<uint64_t, 4> secret_;
+    size_t entriesPerShard_;
+    size_t bytesPerShard_;
+    size_t minBytes_;
+    Clock::duration ttl_;
+    std::array<Shard, SHARDS> shards_;
+    CacheCounters counters_;
+    std::atomic<uint64_t> bytesSaved_{0};
+
+    [[nodiscard]] static constexpr uint64_t avalanche(uint64_t h) noexcept
+    {
+        h ^= h >> 37;
+        h *= 0x165667919e3779f9ULL;
+        return h ^ (h >> 32);
+    }
+
+    [[nodiscard]] static uint64_t load64(const unsigned char *bytes) noexcept
+    {
+        uint64_t word;
+        std::memcpy(&word, bytes, 8);
+        return word;
+    }
+
+    // The accumulate step of XXH3: each lane adds the raw word to its neighbour and the product of
+    // the two halves of the word xor the secret to itself
+    static FORCE_INLINE void accumulate(std::array<uint64_t, 4> &acc, const unsigned char *stripe,
+                                        const std::array<uint64_t, 4> &secret) noexcept
+    {
+        for (size_t lane = 0; lane < 4; ++lane)
+        {
+            const uint64_t word = load64(stripe + 8 * lane);
+            const uint64_t keyed = word ^ secret[lane];
+            acc[lane ^ 1] += word;
+            acc[lane] += (keyed & 0xffffffffULL) * (keyed >> 32);
+        }
+    }
+
+    [[nodiscard]] static uint64_t optionsKey(const ScanOptions &options) noexcept
+    {
+        // Every ScanOptions field that can change a result; domainCache cannot. Filters enter by
+        // generation, not address, so a changed or reallocated one never matches an old entry.
+        uint64_t h = options.skipBinary ? options.minPrintableRun + 1 : 0;
+        h = h * 0x9e3779b97f4a7c15ULL + (options.strictTld ? 1 : 0);
+        h = h * 0x9e3779b97f4a7c15ULL + (options.knownEmails ? options.knownEmails->generation() : 0);
+        h = h * 0x9e3779b97f4a7c15ULL + (options.domainRules ? options.domainRules->generation() : 0);
+        return avalanche(h);
+    }
+
+    [[nodiscard]] bool expired(const Entry &entry, Clock::time_point now) const noexcept
+    {
+        return ttl_ != Clock::duration::zero() && now - entry.storedAt >= ttl_;
+    }
+
+    [[nodiscard]] static size_t resultBytesOf(const std::vector<std::string> &emails) noexcept
+    {
+        size_t bytes = emails.size() * sizeof(std::string);
+        for (const std::string &email : emails)
+            bytes += email.size();
+        return bytes;
+    }
+
+    // Copies the cached result out under the shared lock; false on a miss or an expired entry
+    [[nodiscard]] bool lookup(const ContentHash &key, ScanReport &report, std::vector<std::string> &emails) const
+    {
+        const Shard &shard = shards_[key.low % SHARDS];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        const auto it = shard.index.find(key);
+        if (it == shard.index.end())
+            return false;
+
+        const Entry &entry = shard.entries[it->second];
+        if (expired(entry, Clock::now()))
+            return false;
+
+        if (!entry.referenced.load(std::memory_order_relaxed))
+            entry.referenced.store(true, std::memory_order_relaxed);
+        report = entry.report;
+        emails = entry.emails;
+        return true;
+    }
+
+    void release(Shard &shard, Entry &entry) noexcept
+    {
+        shard.index.erase(entry.key);
+        shard.resultBytes -= entry.resultBytes;
+        entry.emails = {};
+        entry.resultBytes = 0;
+        entry.used = false;
+    }
+
+    void store(const ContentHash &key, const ScanReport &report, const std::vector<std::string> &emails)
+    {
+        const size_t resultBytes = resultBytesOf(emails);
+        if (resultBytes > bytesPerShard_)
+            return;
+
+        Shard &shard = shards_[key.low % SHARDS];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        const Clock::time_point now = Clock::now();
+
+        size_t slot = entriesPerShard_;
+        const auto it = shard.index.find(key);
+        if (it != shard.index.end())
+        {
+            // Another thread stored it first, or the entry expired
+            if (!expired(shard.entries[it->second], now))
+                return;
+            slot = it->second;
+            release(shard, shard.entries[slot]);
+            ++shard.expirations;
+        }
+
+        // CLOCK: referenced entries get a second chance, expired and unreferenced ones go
+        while (slot == entriesPerShard_ || shard.resultBytes + resultBytes > bytesPerShard_)
+        {
+            Entry &candidate = shard.entries[shard.hand];
+            const size_t position = shard.hand;
+            shard.hand = (shard.hand + 1) % entriesPerShard_;
+
+            if (!candidate.used)
+            {
+                if (slot == entriesPerShard_)
+                    slot = position;
+                continue;
+            }
+            if (candidate.referenced.load(std::memory_order_relaxed) && !expired(candidate, now))
+            {
+                candidate.referenced.store(false, std::memory_order_relaxed);
+                continue;
+            }
+
+            if (expired(candidate, now))
+                ++shard.expirations;
+            else
+                ++shard.evictions;
+            release(shard, candidate);
+            if (slot == entriesPerShard_)
+                slot = position;
+        }
+
+        Entry &entry = shard.entries[slot];
+        entry.key = key;
+        entry.storedAt = now;
+        entry.report = report;
+        entry.emails = emails;
+        entry.resultBytes = resultBytes;
+        entry.referenced.store(false, std::memory_order_relaxed);
+        entry.used = true;
+        shard.resultBytes += resultBytes;
+        shard.index.emplace(key, slot);
+    }
+
+    [[nodiscard]] bool bypass(std::string_view text) noexcept
+    {
+        if (text.size() >= minBytes_ && text.size() <= EmailScanner::getMaxInputSize())
+            return false;
+        counters_.bypass();
+        return true;
+    }
+
+public:
+    // entries and maxResultBytes are split evenly over the shards; ttl zero keeps entries until
+    // they are evicted
+    explicit DocumentResultCache(size_t entries = 4096, size_t maxResultBytes = 16 * 1024 * 1024,
+                                 std::chrono::milliseconds ttl = std::chrono::milliseconds::zero(),
+                                 size_t minBytes = DEFAULT_MIN_BYTES)
+        : entriesPerShard_(std::max<size_t>(1, (entries + SHARDS - 1) / SHARDS)),
+          bytesPerShard_(std::max<size_t>(1, maxResultBytes / SHARDS)), minBytes_(minBytes), ttl_(ttl)
+    {
+        std::random_device random;
+        for (uint64_t &word : secret_)
+            word = (uint64_t{random()} << 32) ^ random();
+
+        for (Shard &shard : shards_)
+        {
+            shard.entries = std::make_unique<Entry[]>(entriesPerShard_);
+            shard.index.reserve(entriesPerShard_);
+        }
+    }
+
+    DocumentResultCache(const DocumentResultCache &) = delete;
+    DocumentResultCache &operator=(const DocumentResultCache &) = delete;
+
+    [[nodiscard]] ContentHash hash(std::string_view text) const noexcept
+    {
+        const auto *bytes = reinterpret_cast<const unsigned char *>(text.data());
+        const size_t len = text.size();
+
+        std::array<uint64_t, 4> acc = {secret_[0] ^ 0x9e3779b185ebca87ULL, secret_[1] ^ 0xc2b2ae3d27d4eb4fULL,
+                                       secret_[2] ^ 0x165667b19e3779f9ULL, secret_[3] ^ 0x85ebca77c2b2ae63ULL};
+        size_t offset = 0;
+        for (; offset + 32 <= len; offset += 32)
+        {
+            accumulate(acc, bytes + offset, secret_);
+            // Scramble every KiB, as XXH3 does, so no lane grows from the input alone for long
+            if ((offset & 1023) == 992)
+            {
+                for (uint64_t &lane : acc)
+                    lane = (lane ^ (lane >> 47) ^ secret_[3]) * 0x9e3779b1ULL;
+            }
+        }
+
+        // The last partial stripe, zero-padded
+        unsigned char tail[32] = {};
+        std::memcpy(tail, bytes + offset, len - offset);
+        accumulate(acc, tail, secret_);
+
+        const uint64_t mixedLength = len * 0x9e3779b185ebca87ULL;
+        ContentHash result;
+        result.low = avalanche(mixedLength + avalanche(acc[0] ^ secret_[1]) + avalanche(acc[1] ^ secret_[2]) +
+                               avalanche(acc[2] ^ secret_[3]) + avalanche(acc[3] ^ secret_[0]));
+        result.high = avalanche(~mixedLength + avalanche(acc[0] ^ secret_[2]) * 3 +
+                                avalanche(acc[1] ^ secret_[3]) * 5 + avalanche(acc[2] ^ secret_[0]) * 7 +
+                                avalanche(acc[3] ^ secret_[1]) * 9);
+        return result;
+    }
+
+    // Same result and report as EmailScanner::extract(text, report, options)
+    [[nodiscard]] std::vector<std::string> extract(std::string_view text, ScanReport &report,
+                                                   const ScanOptions &options = {})
+    {
+        if (bypass(text))
+            return EmailScanner::extract(text, report, options);
+
+        ContentHash key = hash(text);
+        key.low ^= optionsKey(options);
+        std::vector<std::string> emails;
+        if (lookup(key, report, emails))
+        {
+            counters_.hit();
+            bytesSaved_.fetch_add(text.size(), std::memory_order_relaxed);
+            return emails;
+        }
+
+        counters_.miss();
+        emails = EmailScanner::extract(text, report, options);
+        store(key, report, emails);
+        return emails;
+    }
+
+    [[nodiscard]] size_t getMinBytes() const noexcept
+    {
+        return minBytes_;
+    }
+
+    [[nodiscard]] Stats getStats() const
+    {
+        const CacheCounters::Totals totals = counters_.getTotals();
+        Stats stats;
+        stats.hits = totals.hits;
+        stats.misses = totals.misses;
+        stats.bypassed = totals.bypassed;
+        stats.bytesSaved = bytesSaved_.load(std::memory_order_relaxed);
+        stats.capacity = entriesPerShard_ * SHARDS;
+        for (const Shard &shard : shards_)
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            stats.expirations += shard.expirations;
+            stats.evictions += shard.evictions;
+            stats.entries += shard.index.size();
+            stats.resultBytes += shard.resultBytes;
+        }
+        return stats;
+    }
+
+    // Zeroes the counters, keeping the cached results
+    void resetStats()
+    {
+        counters_.reset();
+        bytesSaved_.store(0, std::memory_order_relaxed);
+        for (Shard &shard : shards_)
+        {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            shard.expirations = 0;
+            shard.evictions = 0;
+        }
+    }
+};
+
+// ====================================================================================================
+// EMAIL SCANNER SERVICE (With Statistics)
+// ====================================================================================================
+
+class EmailScannerService final
+{
+private:
+    ValidationStats stats_;
+    // Optional cache for extract(), and may be shared with other services
+    std::shared_ptr<DocumentResultCache> cache_;
+
+    void recordOutcome(const ScanReport &report, uint64_t checkFailuresBefore) noexcept
+    {
+        const uint64_t checkFailures = ThreadSafeErrorCounter::getThreadCount() - checkFailuresBefore;
+        if (UNLIKELY(checkFailures > 0))
+            stats_.recordError(checkFailures);
+
+        stats_.recordScanReport(report);
+    }
+
+public:
+    EmailScannerService() = default;
+
+    explicit EmailScannerService(std::shared_ptr<DocumentResultCache> cache) : cache_(std::move(cache))
+    {
+    }
+
+    EmailScannerService(const EmailScannerService &) = delete;
+    EmailScannerService &operator=(const EmailScannerService &) = delete;
+
+    EmailScannerService(EmailScannerService &&) noexcept = default;
+    EmailScannerService &operator=(EmailScannerService &&) noexcept = default;
+
+    [[nodiscard]] bool contains(std::string_view text, const ScanOptions &options = {}) noexcept
+    {
+        stats_.recordScan();
+
+        ScanReport report;
+        const uint64_t checkFailuresBefore = ThreadSafeErrorCounter::getThreadCount();
+        bool result = EmailScanner::contains(text, report, options);
+        recordOutcome(report, checkFailuresBefore);
+
+        return result;
+    }
+
+    [[nodiscard]] std::vector<std::string> extract(std::string_view text, const ScanOptions &options = {}) noexcept
+    {
+        stats_.recordExtract();
+
+        ScanReport report;
+        const uint64_t checkFailuresBefore = ThreadSafeErrorCounter::getThreadCount();
+        std::vector<std::string> result;
+        try
+        {
+            result = cache_ ? cache_->extract(text, report, options) : EmailScanner::extract(text, report, options);
+        }
+        catch (...)
+        {
+            // The cache could not allocate; scan without it
+            report = ScanReport{};
+            result = EmailScanner::extract(text, report, options);
+        }
+        recordOutcome(report, checkFailuresBefore);
+
+        return result;
+    }
+
+    [[nodiscard]] const ValidationStats &getStats() const noexcept
+    {
+        return stats_;
+    }
+
+    void resetStats() noexcept
+    {
+        stats_.reset();
+    }
+
+    [[nodiscard]] const DocumentResultCache *getCache() const noexcept
+    {
+        return cache_.get();
+    }
+};
+
+// ====================================================================================================
+// FACTORY (Dependency Inversion Principle)
+// ====================================================================================================
+
+class EmailServiceFactory
+{
+public:
+    // Create service instances with independent statistics
+    [[nodiscard]] static EmailValidationService createValidationService()
+    {
+        return EmailValidationService{};
+    }
+
+    // Services given the same cache share its results
+    [[nodiscard]] static EmailValidationService createValidationService(std::shared_ptr<ValidationResultCache> cache)
+    {
+        return EmailValidationService{std::move(cache)};
+    }
+
+    [[nodiscard]] static EmailScannerService createScannerService()
+    {
+        return EmailScannerService{};
+    }
+
+    // Services given the same cache share its results
+    [[nodiscard]] static EmailScannerService createScannerService(std::shared_ptr<DocumentResultCache> cache)
+    {
+        return EmailScannerService{std::move(cache)};
+    }
+
+    // Get thread-local service instances (for convenience)
+    [[nodiscard]] static EmailValidationService &getThreadLocalValidationService()
+    {
+        thread_local EmailValidationService instance;
+        return instance;
+    }
+
+    [[nodiscard]] static EmailScannerService &getThreadLocalScannerService()
+    {
+        thread_local EmailScannerService instance;
+        return instance;
+    }
+};
+
+// ====================================================================================================
+// HARDWARE PERFORMANCE COUNTERS (Benchmark instrumentation, Linux perf_event_open)
+// ====================================================================================================
+
+class HardwareCounters
+{
+public:
+    enum Event : size_t
+    {
+        CYCLES = 0,
+        INSTRUCTIONS,
+        BRANCH_MISSES,
+        L1D_MISSES,
+        LLC_MISSES,
+        EVENT_COUNT
+    };
+
+    struct Sample
+    {
+        std::array<uint64_t, EVENT_COUNT> values{};
+        std::array<bool, EVENT_COUNT> valid{};
+
+        [[nodiscard]] bool has(Event event) const noexcept
+        {
+            return valid[event];
+        }
+
+        [[nodiscard]] uint64_t get(Event event) const noexcept
+        {
+            return valid[event] ? values[event] : 0;
+        }
+
+        [[nodiscard]] double getIPC() const noexcept
+        {
+            return (has(CYCLES) && has(INSTRUCTIONS) && values[CYCLES] > 0)
+                       ? static_cast<double>(values[INSTRUCTIONS]) / values[CYCLES]
+                       : 0.0;
+        }
+
+        [[nodiscard]] double perByte(Event event, uint64_t bytes) const noexcept
+        {
+            return (has(event) && bytes > 0) ? static_cast<double>(values[event]) / bytes : 0.0;
+        }
+
+        [[nodiscard]] bool any() const noexcept
+        {
+            return std::find(valid.begin(), valid.end(), true) != valid.end();
+        }
+    };
+
+    [[nodiscard]] static constexpr const char *eventName(Event event) noexcept
+    {
+        switch (event)
+        {
+        case CYCLES:
+            return "cycles";
+        case INSTRUCTIONS:
+            return "instructions";
+        case BRANCH_MISSES:
+            return "branch-misses";
+        case L1D_MISSES:
+            return "L1D-load-misses";
+        case LLC_MISSES:
+            return "LLC-load-misses";
+        case EVENT_COUNT:
+            break;
+        }
+        return "unknown";
+    }
+
+    // Counters follow the calling thread and every thread it spawns afterwards (inherit),
+    // so a benchmark phase must create its worker threads between start() and stop()
+    // and join them before stop() reads the totals.
+    explicit HardwareCounters(bool enabled = true) noexcept
+    {
+        fds_.fill(-1);
+#if defined(__linux__)
+        if (!enabled)
+            return;
+
+        const std::array<std::pair<uint32_t, uint64_t>, EVENT_COUNT> configs = {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                                     (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL |
+                                     (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        }};
+
+        for (size_t i = 0; i < EVENT_COUNT; ++i)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = configs[i].first;
+            attr.config = configs[i].second;
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            fds_[i] = fd >= 0 ? static_cast<int>(fd) : -1;
+        }
+#else
+        (void)enabled;
+#endif
+    }
+
+    ~HardwareCounters()
+    {
+#if defined(__linux__)
+        for (int fd : fds_)
+        {
+            if (fd >= 0)
+                close(fd);
+        }
+#endif
+    }
+
+    HardwareCounters(const HardwareCounters &) = delete;
+    HardwareCounters &operator=(const HardwareCounters &) = delete;
+
+    [[nodiscard]] bool isAvailable() const noexcept
+    {
+        return std::any_of(fds_.begin(), fds_.end(), [](int fd)
+                           { return fd >= 0; });
+    }
+
+    void start() noexcept
+    {
+#if defined(__linux__)
+        for (int fd : fds_)
+        {
+            if (fd >= 0)
+            {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    [[nodiscard]] Sample stop() noexcept
+    {
+        Sample sample;
+#if defined(__linux__)
+        for (int fd : fds_)
+        {
+            if (fd >= 0)
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+
+        for (size_t i = 0; i < EVENT_COUNT; ++i)
+        {
+            if (fds_[i] < 0)
+                continue;
+
+            // value, time_enabled, time_running
+            uint64_t data[3] = {0, 0, 0};
+            if (read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)))
+                continue;
+
+            if (data[2] == 0)
+                continue;
+
+            // Scale up when the kernel multiplexed this counter with others
+            double scaled = static_cast<double>(data[0]);
+            if (data[2] < data[1])
+                scaled = scaled * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+
+            sample.values[i] = static_cast<uint64_t>(scaled);
+            sample.valid[i] = true;
+        }
+#endif
+        return sample;
+    }
+
+private:
+    std::array<int, EVENT_COUNT> fds_{};
+};
+
+// ====================================================================================================
+// ALLOCATION TRACKING (Global operator new/delete hooks, opt-in at runtime)
+// ====================================================================================================
+
+struct AllocationCounts
+{
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes = 0;
+
+    [[nodiscard]] AllocationCounts operator-(const AllocationCounts &other) const noexcept
+    {
+        return {allocations - other.allocations,
+                deallocations - other.deallocations,
+                bytes - other.bytes};
+    }
+
+    AllocationCounts &operator+=(const AllocationCounts &other) noexcept
+    {
+        allocations += other.allocations;
+        deallocations += other.deallocations;
+        bytes += other.bytes;
+        return *this;
+    }
+};
+
+// Counts heap allocations made through the global operator new. The hooks are linked in unless
+// EMAIL_DETECTOR_NO_ALLOCATION_HOOKS is defined, but only count while tracking is enabled, so
+// the cost when off is one relaxed load per allocation. Counts are kept per thread.
+class AllocationTracker
+{
+public:
+    // Enables tracking for its lifetime and restores the previous state afterwards
+    class Scope
+    {
+    private:
+        bool previous_;
+
+    public:
+        Scope() noexcept : previous_(enabled_.exchange(true, std::memory_order_relaxed)) {}
+        ~Scope() { enabled_.store(previous_, std::memory_order_relaxed); }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+    [[nodiscard]] static bool isAvailable() noexcept
+    {
+#ifdef EMAIL_DETECTOR_NO_ALLOCATION_HOOKS
+        return false;
+#else
+        return true;
+#endif
+    }
+
+    [[nodiscard]] static bool isEnabled() noexcept
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // Everything the calling thread allocated while tracking was enabled
+    [[nodiscard]] static AllocationCounts getThreadCounts() noexcept
+    {
+        return threadCounts_;
+    }
+
+    static void recordAllocation(size_t size) noexcept
+    {
+        if (UNLIKELY(enabled_.load(std::memory_order_relaxed)))
+        {
+            ++threadCounts_.allocations;
+            threadCounts_.bytes += size;
+        }
+    }
+
+    static void recordDeallocation() noexcept
+    {
+        if (UNLIKELY(enabled_.load(std::memory_order_relaxed)))
+            ++threadCounts_.deallocations;
+    }
+
+    // Process-wide resident set high-water mark in bytes, 0 where unsupported
+    [[nodiscard]] static uint64_t getPeakResidentBytes() noexcept
+    {
+#if defined(__linux__)
+        struct rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+            return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+        return 0;
+    }
+
+private:
+    static inline std::atomic<bool> enabled_{false};
+    static inline thread_local AllocationCounts threadCounts_{};
+};
+
+#ifndef EMAIL_DETECTOR_NO_ALLOCATION_HOOKS
+
+static void *trackedAllocate(std::size_t size)
+{
+    AllocationTracker::recordAllocation(size);
+    if (size == 0)
+        size = 1;
+
+    for (;;)
+    {
+        if (void *ptr = std::malloc(size))
+            return ptr;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+static void *trackedAllocate(std::size_t size, std::align_val_t alignment)
+{
+    AllocationTracker::recordAllocation(size);
+    const size_t align = std::max(static_cast<size_t>(alignment), sizeof(void *));
+    // aligned_alloc requires the size to be a multiple of the alignment
+    const size_t rounded = size == 0 ? align : (size + align - 1) / align * align;
+
+    for (;;)
+    {
+        if (void *ptr = std::aligned_alloc(align, rounded))
+            return ptr;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+static void trackedFree(void *ptr) noexcept
+{
+    if (ptr == nullptr)
+        return;
+    AllocationTracker::recordDeallocation();
+    std::free(ptr);
+}
+
+void *operator new(std::size_t size) { return trackedAllocate(size); }
+void *operator new[](std::size_t size) { return trackedAllocate(size); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return trackedAllocate(size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return trackedAllocate(size, alignment); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return trackedAllocate(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return trackedAllocate(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return trackedAllocate(size, alignment);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return trackedAllocate(size, alignment);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void operator delete(void *ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { trackedFree(ptr); }
+
+#endif // EMAIL_DETECTOR_NO_ALLOCATION_HOOKS
+
+// ====================================================================================================
+// SYNTHETIC CORPUS GENERATOR (Deterministic, seeded benchmark input)
+// ====================================================================================================
+
+enum class CorpusType
+{
+    SYSLOG,
+    JSON_LOG,
+    HTML,
+    MIME,
+    CSV,
+    BINARY
+};
+
+inline constexpr std::array<CorpusType, 6> ALL_CORPUS_TYPES = {
+    CorpusType::SYSLOG, CorpusType::JSON_LOG, CorpusType::HTML,
+    CorpusType::MIME, CorpusType::CSV, CorpusType::BINARY};
+
+[[nodiscard]] constexpr const char *corpusTypeName(CorpusType type) noexcept
+{
+    switch (type)
+    {
+    case CorpusType::SYSLOG:
+        return "syslog";
+    case CorpusType::JSON_LOG:
+        return "json";
+    case CorpusType::HTML:
+        return "html";
+    case CorpusType::MIME:
+        return "mime";
+    case CorpusType::CSV:
+        return "csv";
+    case CorpusType::BINARY:
+        return "binary";
+    }
+    return "unknown";
+}
+
+struct CorpusOptions
+{
+    uint64_t seed = 42;
+    // Probability that a record (log line, paragraph, row ...) carries an email address
+    double emailDensity = 0.1;
+    // Probability that a record carries an '@' that is not an address (handles, decorators, literals)
+    double nearMissRate = 0.05;
+    size_t documentSize = 4096;
+};
+
+class CorpusGenerator
+{
+private:
+    // SplitMix64: tiny, fast and identical on every platform, unlike std:: distributions
+    uint64_t state_;
+    CorpusOptions options_;
+
+    static constexpr std::array<const char *, 24> WORDS = {
+        "request", "completed", "user", "session", "timeout", "connection", "accepted", "queue",
+        "worker", "started", "payload", "cache", "miss", "retry", "upstream", "latency",
+        "token", "refresh", "invoice", "order", "shipped", "account", "updated", "login"};
+
+    static constexpr std::array<const char *, 12> FIRST_NAMES = {
+        "john", "jane", "alex", "maria", "li", "omar", "sara", "tom", "anna", "raj", "eva", "noah"};
+
+    static constexpr std::array<const char *, 10> DOMAINS = {
+        "gmail.com", "outlook.com", "example.org", "corp.example.com", "mail.co.uk",
+        "yahoo.co.in", "company.io", "uni.edu", "service.net", "shop.store"};
+
+    static constexpr std::array<const char *, 10> NEAR_MISSES = {
+        "@Override", "@param", "@SuppressWarnings(\"unchecked\")", "user@[10.1.2.3]", "meet @ 3pm",
+        "ping me @here", "price@$5", "x@.org", "a@-b.com", "@@handle"};
+
+    [[nodiscard]] uint64_t next() noexcept
+    {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    [[nodiscard]] size_t below(size_t bound) noexcept
+    {
+        return bound > 0 ? static_cast<size_t>(next() % bound) : 0;
+    }
+
+    [[nodiscard]] bool chance(double probability) noexcept
+    {
+        return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0) < probability;
+    }
+
+    template <size_t N>
+    [[nodiscard]] const char *pick(const std::array<const char *, N> &items) noexcept
+    {
+        return items[below(N)];
+    }
+
+    void appendNumber(std::string &out, uint64_t value, size_t width = 0)
+    {
+        const std::string digits = std::to_string(value);
+        if (digits.size() < width)
+            out.append(width - digits.size(), '0');
+        out += digits;
+    }
+
+    void appendEmail(std::string &out)
+    {
+        out += pick(FIRST_NAMES);
+        switch (below(4))
+        {
+        case 0:
+            out += '.';
+            out += pick(FIRST_NAMES);
+            break;
+        case 1:
+            appendNumber(out, below(1000));
+            break;
+        case 2:
+            out += "+";
+            out += pick(WORDS);
+            break;
+        default:
+            break;
+        }
+        out += '@';
+        out += pick(DOMAINS);
+    }
+
+    void appendWords(std::string &out, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (i > 0)
+                out += ' ';
+            out += pick(WORDS);
+        }
+    }
+
+    // Free text with the configured email and near-miss mix
+    void appendMessage(std::string &out)
+    {
+        appendWords(out, 3 + below(6));
+        if (chance(options_.emailDensity))
+        {
+            out += " for ";
+            appendEmail(out);
+        }
+        if (chance(options_.nearMissRate))
+        {
+            out += ' ';
+            out += pick(NEAR_MISSES);
+        }
+        out += ' ';
+        appendWords(out, below(4));
+    }
+
+    void appendSyslogRecord(std::string &out)
+    {
+        static constexpr std::array<const char *, 12> MONTHS = {
+            "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+        out += '<';
+        appendNumber(out, below(192));
+        out += '>';
+        out += pick(MONTHS);
+        out += ' ';
+        appendNumber(out, 1 + below(28), 2);
+        out += ' ';
+        appendNumber(out, below(24), 2);
+        out += ':';
+        appendNumber(out, below(60), 2);
+        out += ':';
+        appendNumber(out, below(60), 2);
+        out += " host";
+        appendNumber(out, below(64));
+        out += " app[";
+        appendNumber(out, 100 + below(30000));
+        out += "]: ";
+        appendMessage(out);
+        out += '\n';
+    }
+
+    void appendJsonRecord(std::string &out)
+    {
+        static constexpr std::array<const char *, 4> LEVELS = {"DEBUG", "INFO", "WARN", "ERROR"};
+        out += "{\"ts\":\"2024-";
+        appendNumber(out, 1 + below(12), 2);
+        out += '-';
+        appendNumber(out, 1 + below(28), 2);
+        out += "T";
+        appendNumber(out, below(24), 2);
+        out += ":00:00Z\",\"level\":\"";
+        out += pick(LEVELS);
+        out += "\",\"request_id\":\"";
+        appendNumber(out, next() & 0xFFFFFFFFFFULL);
+        out += "\",\"msg\":\"";
+        appendMessage(out);
+        out += '"';
+        if (chance(options_.emailDensity))
+        {
+            out += ",\"email\":\"";
+            appendEmail(out);
+            out += '"';
+        }
+        out += "}\n";
+    }
+
+    void appendHtmlRecord(std::string &out)
+    {
+        switch (below(4))
+        {
+        case 0:
+            out += "<div class=\"row\"><span>";
+            appendWords(out, 2 + below(4));
+            out += "</span></div>\n";
+            break;
+        case 1:
+            if (chance(options_.emailDensity * 2.0))
+            {
+                out += "<p>Contact <a href=\"mailto:";
+                const size_t start = out.size();
+                appendEmail(out);
+                const std::string email = out.substr(start);
+                out += "\">";
+                out += email;
+                out += "</a></p>\n";
+                break;
+            }
+            [[fallthrough]];
+        default:
+            out += "<p>";
+            appendMessage(out);
+            out += "</p>\n";
+            break;
+        }
+    }
+
+    void appendMimeRecord(std::string &out)
+    {
+        static constexpr char BASE64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        switch (below(6))
+        {
+        case 0:
+            out += "From: \"";
+            out += pick(FIRST_NAMES);
+            out += "\" <";
+            appendEmail(out);
+            out += ">\r\nTo: ";
+            appendEmail(out);
+            out += "\r\nSubject: ";
+            appendWords(out, 3);
+            out += "\r\nContent-Type: multipart/alternative; boundary=\"b";
+            appendNumber(out, next() & 0xFFFFFF);
+            out += "\"\r\n\r\n";
+            break;
+        case 1:
+            for (size_t i = 0; i < 76; ++i)
+                out += BASE64[below(64)];
+            out += "\r\n";
+            break;
+        case 2:
+            out += "> On Monday ";
+            appendEmail(out);
+            out += " wrote:\r\n";
+            break;
+        default:
+            appendMessage(out);
+            out += "\r\n";
+            break;
+        }
+    }
+
+    void appendCsvRecord(std::string &out)
+    {
+        appendNumber(out, next() & 0xFFFFFF);
+        out += ',';
+        out += pick(FIRST_NAMES);
+        out += ' ';
+        out += pick(FIRST_NAMES);
+        out += ',';
+        if (chance(options_.emailDensity * 5.0))
+            appendEmail(out);
+        else if (chance(options_.nearMissRate))
+            out += pick(NEAR_MISSES);
+        out += ",+1-555-";
+        appendNumber(out, below(10000), 4);
+        out += ',';
+        out += pick(WORDS);
+        out += ",\"";
+        appendWords(out, 1 + below(3));
+        out += "\"\n";
+    }
+
+    void appendBinaryRecord(std::string &out)
+    {
+        // Mostly random bytes, with occasional printable runs like strings(1) would find
+        const size_t binaryBytes = 32 + below(224);
+        for (size_t i = 0; i < binaryBytes; i += 8)
+        {
+            uint64_t bits = next();
+            const size_t n = std::min<size_t>(8, binaryBytes - i);
+            for (size_t j = 0; j < n; ++j, bits >>= 8)
+                out += static_cast<char>(bits & 0xFF);
+        }
+        if (chance(0.3))
+            appendMessage(out);
+    }
+
+    void appendRecord(std::string &out, CorpusType type)
+    {
+        switch (type)
+        {
+        case CorpusType::SYSLOG:
+            appendSyslogRecord(out);
+            break;
+        case CorpusType::JSON_LOG:
+            appendJsonRecord(out);
+            break;
+        case CorpusType::HTML:
+            appendHtmlRecord(out);
+            break;
+        case CorpusType::MIME:
+            appendMimeRecord(out);
+            break;
+        case CorpusType::CSV:
+            appendCsvRecord(out);
+            break;
+        case CorpusType::BINARY:
+            appendBinaryRecord(out);
+            break;
+        }
+    }
+
+public:
+    explicit CorpusGenerator(const CorpusOptions &options) noexcept
+        : state_(options.seed), options_(options)
+    {
+    }
+
+    // One document of exactly options.documentSize bytes; the same seed always yields the same bytes
+    [[nodiscard]] std::string generateDocument(CorpusType type)
+    {
+        std::string document;
+        document.reserve(options_.documentSize + 512);
+
+        if (type == CorpusType::HTML)
+            document += "<!DOCTYPE html>\n<html><head><title>report</title></head><body>\n";
+
+        while (document.size() < options_.documentSize)
+            appendRecord(document, type);
+
+        document.resize(options_.documentSize);
+        return document;
+    }
+
+    // Documents totalling at least totalSize bytes (one document minimum)
+    [[nodiscard]] std::vector<std::string> generateCorpus(CorpusType type, uint64_t totalSize)
+    {
+        const size_t documentSize = std::max<size_t>(options_.documentSize, 1);
+        const uint64_t count = std::max<uint64_t>(1, (totalSize + documentSize - 1) / documentSize);
+
+        std::vector<std::string> corpus;
+        corpus.reserve(static_cast<size_t>(count));
+        for (uint64_t i = 0; i < count; ++i)
+            corpus.push_back(generateDocument(type));
+        return corpus;
+    }
+};
+
+// ====================================================================================================
+// BENCHMARK HARNESS (Configurable workloads, threads, pinning, JSON output)
+// ====================================================================================================
+
+enum class BenchmarkWorkload
+{
+    IS_VALID,
+    CONTAINS,
+    EXTRACT,
+    COMBINED,
+    BATCH,
+    STREAM,
+    REDACT
+};
+
+inline constexpr std::array<BenchmarkWorkload, 7> ALL_BENCHMARK_WORKLOADS = {
+    BenchmarkWorkload::IS_VALID, BenchmarkWorkload::CONTAINS, BenchmarkWorkload::EXTRACT,
+    BenchmarkWorkload::COMBINED, BenchmarkWorkload::BATCH, BenchmarkWorkload::STREAM,
+    BenchmarkWorkload::REDACT};
+
+[[nodiscard]] constexpr const char *workloadName(BenchmarkWorkload workload) noexcept
+{
+    switch (workload)
+    {
+    case BenchmarkWorkload::IS_VALID:
+        return "isValid";
+    case BenchmarkWorkload::CONTAINS:
+        return "contains";
+    case BenchmarkWorkload::EXTRACT:
+        return "extract";
+    case BenchmarkWorkload::COMBINED:
+        return "combined";
+    case BenchmarkWorkload::BATCH:
+        return "batch";
+    case BenchmarkWorkload::STREAM:
+        return "stream";
+    case BenchmarkWorkload::REDACT:
+        return "redact";
+    }
+    return "unknown";
+}
+
+// How worker threads are placed on CPUs
+enum class BenchmarkPinMode
+{
+    NONE,
+    ANY,            // allowed CPUs in numeric order
+    PHYSICAL_CORES, // one thread per physical core before any SMT sibling is used
+    SMT_SIBLINGS    // fill both hyperthreads of a core before moving to the next core
+};
+
+// Which object the workload calls through
+enum class BenchmarkServiceMode
+{
+    NONE,        // stateless EmailValidator / EmailScanner
+    SHARED,      // one EmailValidationService / EmailScannerService shared by all threads
+    THREAD_LOCAL // one service instance per thread
+};
+
+struct BenchmarkConfig
+{
+    std::vector<BenchmarkWorkload> workloads = {BenchmarkWorkload::IS_VALID, BenchmarkWorkload::CONTAINS,
+                                                BenchmarkWorkload::EXTRACT, BenchmarkWorkload::COMBINED};
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t iterations = 100000;
+    double durationSeconds = 0.0;
+    uint64_t warmupIterations = 0;
+    BenchmarkPinMode pinMode = BenchmarkPinMode::NONE;
+    BenchmarkServiceMode serviceMode = BenchmarkServiceMode::NONE;
+    bool sweep = false;
+    bool jsonOutput = false;
+    bool hardwareCounters = false;
+    // Count heap allocations in the timed loop through the global operator new hooks
+    bool trackAllocations = false;
+    // Passed to contains/extract/stream (e.g. skipBinary for mixed corpora)
+    ScanOptions scanOptions;
+    // Replacement written by the redact workload; PSEUDONYM uses a fixed benchmark key
+    RedactionMode redactMode = RedactionMode::TOKEN;
+    size_t pseudonymCacheEntries = 0;
+    // DomainValidationCache entries shared by the worker threads; 0 validates every domain
+    size_t domainCacheEntries = 0;
+    // ValidationResultCache entries shared by the worker threads for isValid; 0 disables it
+    size_t validationCacheEntries = 0;
+    // DocumentResultCache entries shared by the worker threads for extract; 0 disables it
+    size_t documentCacheEntries = 0;
+    size_t streamChunkSize = 4096;
+    // Generated corpora replace the embedded test cases when any type is selected
+    std::vector<CorpusType> corpusTypes;
+    CorpusOptions corpusOptions;
+    uint64_t corpusSize = 4 * 1024 * 1024;
+    // Pathological-input complexity suite instead of the throughput workloads
+    bool complexity = false;
+    // Compare extract() against a std::regex one-liner instead of the throughput workloads
+    bool regexBaseline = false;
+    // Results file to write, and an earlier one to diff against
+    std::string saveBaselinePath;
+    std::string compareBaselinePath;
+    double regressionThresholdPercent = 5.0;
+    // Per-size throughput sweep instead of the throughput workloads
+    bool sizeSweep = false;
+    // Input size range for --complexity and --size-sweep; 0 picks the mode's default
+    size_t minSize = 0;
+    size_t maxSize = 0;
+
+    // Accepts plain byte counts or K/M/G (binary) suffixes: 64, 4K, 16M, 2G
+    [[nodiscard]] static uint64_t parseSize(std::string_view value, std::string_view option)
+    {
+        uint64_t multiplier = 1;
+        if (!value.empty())
+        {
+            switch (value.back())
+            {
+            case 'k':
+            case 'K':
+                multiplier = 1024ULL;
+                break;
+            case 'm':
+            case 'M':
+                multiplier = 1024ULL * 1024;
+                break;
+            case 'g':
+            case 'G':
+                multiplier = 1024ULL * 1024 * 1024;
+                break;
+            default:
+                break;
+            }
+            if (multiplier > 1)
+                value.remove_suffix(1);
+        }
+
+        const uint64_t base = parseUnsigned(value, option);
+        if (base > UINT64_MAX / multiplier)
+            throw std::invalid_argument("value too large for " + std::string(option));
+        return base * multiplier;
+    }
+
+    [[nodiscard]] static std::vector<CorpusType> parseCorpusTypes(std::string_view list)
+    {
+        std::vector<CorpusType> result;
+
+        while (!list.empty())
+        {
+            const size_t comma = list.find(',');
+            const std::string_view name = list.substr(0, comma);
+            list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+            if (name == "all")
+            {
+                result.assign(ALL_CORPUS_TYPES.begin(), ALL_CORPUS_TYPES.end());
+                continue;
+            }
+
+            auto it = std::find_if(ALL_CORPUS_TYPES.begin(), ALL_CORPUS_TYPES.end(),
+                                   [name](CorpusType type)
+                                   { return name == corpusTypeName(type); });
+            if (it == ALL_CORPUS_TYPES.end())
+                throw std::invalid_argument("unknown corpus type '" + std::string(name) + "'");
+
+            if (std::find(result.begin(), result.end(), *it) == result.end())
+                result.push_back(*it);
+        }
+
+        return result;
+    }
+
+    [[nodiscard]] static double parseProbability(std::string_view value, std::string_view option)
+    {
+        const double result = parseDouble(value, option);
+        if (result > 1.0)
+            throw std::invalid_argument(std::string(option) + " must be between 0 and 1");
+        return result;
+    }
+
+    [[nodiscard]] static uint64_t parseUnsigned(std::string_view value, std::string_view option)
+    {
+        if (value.empty() || value.size() > 19)
+            throw std::invalid_argument("invalid value for " + std::string(option) + ": '" + std::string(value) + "'");
+
+        uint64_t result = 0;
+        for (char c : value)
+        {
+            if (c < '0' || c > '9')
+                throw std::invalid_argument("invalid value for " + std::string(option) + ": '" + std::string(value) + "'");
+            result = result * 10 + static_cast<uint64_t>(c - '0');
+        }
+        return result;
+    }
+
+    [[nodiscard]] static double parseDouble(std::string_view value, std::string_view option)
+    {
+        try
+        {
+            size_t consumed = 0;
+            const std::string text(value);
+            double result = std::stod(text, &consumed);
+            if (consumed != text.size() || !std::isfinite(result) || result < 0.0)
+                throw std::invalid_argument("");
+            return result;
+        }
+        catch (const std::exception &)
+        {
+            throw std::invalid_argument("invalid value for " + std::string(option) + ": '" + std::string(value) + "'");
+        }
+    }
+
+    [[nodiscard]] static std::vector<BenchmarkWorkload> parseWorkloads(std::string_view list)
+    {
+        std::vector<BenchmarkWorkload> result;
+
+        while (!list.empty())
+        {
+            const size_t comma = list.find(',');
+            const std::string_view name = list.substr(0, comma);
+            list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+            if (name == "all")
+            {
+                result.assign(ALL_BENCHMARK_WORKLOADS.begin(), ALL_BENCHMARK_WORKLOADS.end());
+                continue;
+            }
+
+            auto it = std::find_if(ALL_BENCHMARK_WORKLOADS.begin(), ALL_BENCHMARK_WORKLOADS.end(),
+                                   [name](BenchmarkWorkload w)
+                                   { return name == workloadName(w); });
+            if (it == ALL_BENCHMARK_WORKLOADS.end())
+                throw std::invalid_argument("unknown workload '" + std::string(name) + "'");
+
+            if (std::find(result.begin(), result.end(), *it) == result.end())
+                result.push_back(*it);
+        }
+
+        if (result.empty())
+            throw std::invalid_argument("--workload needs at least one workload");
+
+        return result;
+    }
+
+    // Parses "bench" options of the form --name=value or --flag
+    [[nodiscard]] static BenchmarkConfig parse(const std::vector<std::string_view> &args)
+    {
+        BenchmarkConfig config;
+        bool iterationsGiven = false;
+
+        for (std::string_view arg : args)
+        {
+            const size_t eq = arg.find('=');
+            const std::string_view name = arg.substr(0, eq);
+            const std::string_view value = eq == std::string_view::npos ? std::string_view{} : arg.substr(eq + 1);
+            const bool hasValue = eq != std::string_view::npos;
+
+            auto requireValue = [&]()
+            {
+                if (!hasValue)
+                    throw std::invalid_argument(std::string(name) + " needs a value");
+            };
+            auto rejectValue = [&]()
+            {
+                if (hasValue)
+                    throw std::invalid_argument(std::string(name) + " takes no value");
+            };
+
+            if (name == "--workload")
+            {
+                requireValue();
+                config.workloads = parseWorkloads(value);
+            }
+            else if (name == "--threads")
+            {
+                requireValue();
+                config.threads = static_cast<size_t>(parseUnsigned(value, name));
+                if (config.threads == 0)
+                    throw std::invalid_argument("--threads must be at least 1");
+            }
+            else if (name == "--iterations")
+            {
+                requireValue();
+                config.iterations = parseUnsigned(value, name);
+                iterationsGiven = true;
+            }
+            else if (name == "--duration")
+            {
+                requireValue();
+                config.durationSeconds = parseDouble(value, name);
+                if (config.durationSeconds <= 0.0)
+                    throw std::invalid_argument("--duration must be a positive number of seconds");
+            }
+            else if (name == "--warmup")
+            {
+                requireValue();
+                config.warmupIterations = parseUnsigned(value, name);
+            }
+            else if (name == "--stream-chunk")
+            {
+                requireValue();
+                config.streamChunkSize = static_cast<size_t>(parseUnsigned(value, name));
+                if (config.streamChunkSize == 0)
+                    throw std::invalid_argument("--stream-chunk must be at least 1");
+            }
+            else if (name == "--pin")
+            {
+                if (!hasValue)
+                    config.pinMode = BenchmarkPinMode::ANY;
+                else if (value == "core")
+                    config.pinMode = BenchmarkPinMode::PHYSICAL_CORES;
+                else if (value == "smt")
+                    config.pinMode = BenchmarkPinMode::SMT_SIBLINGS;
+                else if (value == "none")
+                    config.pinMode = BenchmarkPinMode::NONE;
+                else
+                    throw std::invalid_argument("--pin expects core, smt or none");
+            }
+            else if (name == "--service")
+            {
+                requireValue();
+                if (value == "none")
+                    config.serviceMode = BenchmarkServiceMode::NONE;
+                else if (value == "shared")
+                    config.serviceMode = BenchmarkServiceMode::SHARED;
+                else if (value == "thread-local")
+                    config.serviceMode = BenchmarkServiceMode::THREAD_LOCAL;
+                else
+                    throw std::invalid_argument("--service expects none, shared or thread-local");
+            }
+            else if (name == "--sweep")
+            {
+                rejectValue();
+                config.sweep = true;
+            }
+            else if (name == "--complexity")
+            {
+                rejectValue();
+                config.complexity = true;
+            }
+            else if (name == "--regex")
+            {
+                rejectValue();
+                config.regexBaseline = true;
+            }
+            else if (name == "--save-baseline")
+            {
+                requireValue();
+                config.saveBaselinePath = std::string(value);
+            }
+            else if (name == "--compare")
+            {
+                requireValue();
+                config.compareBaselinePath = std::string(value);
+            }
+            else if (name == "--threshold")
+            {
+                requireValue();
+                config.regressionThresholdPercent = parseDouble(value, name);
+                if (config.regressionThresholdPercent <= 0.0)
+                    throw std::invalid_argument("--threshold must be a positive percentage");
+            }
+            else if (name == "--max-size")
+            {
+                requireValue();
+                config.maxSize = static_cast<size_t>(parseSize(value, name));
+            }
+            else if (name == "--min-size")
+            {
+                requireValue();
+                config.minSize = static_cast<size_t>(parseSize(value, name));
+            }
+            else if (name == "--size-sweep")
+            {
+                rejectValue();
+                config.sizeSweep = true;
+            }
+            else if (name == "--corpus")
+            {
+                requireValue();
+                config.corpusTypes = parseCorpusTypes(value);
+            }
+            else if (name == "--doc-size")
+            {
+                requireValue();
+                config.corpusOptions.documentSize = static_cast<size_t>(parseSize(value, name));
+                if (config.corpusOptions.documentSize == 0)
+                    throw std::invalid_argument("--doc-size must be at least 1 byte");
+            }
+            else if (name == "--corpus-size")
+            {
+                requireValue();
+                config.corpusSize = parseSize(value, name);
+            }
+            else if (name == "--seed")
+            {
+                requireValue();
+                config.corpusOptions.seed = parseUnsigned(value, name);
+            }
+            else if (name == "--email-density")
+            {
+                requireValue();
+                config.corpusOptions.emailDensity = parseProbability(value, name);
+            }
+            else if (name == "--near-miss-rate")
+            {
+                requireValue();
+                config.corpusOptions.nearMissRate = parseProbability(value, name);
+            }
+            else if (name == "--json")
+            {
+                rejectValue();
+                config.jsonOutput = true;
+            }
+            else if (name == "--perf")
+            {
+                rejectValue();
+                config.hardwareCounters = true;
+            }
+            else if (name == "--alloc")
+            {
+                rejectValue();
+                config.trackAllocations = true;
+            }
+            else if (name == "--skip-binary")
+            {
+                rejectValue();
+                config.scanOptions.skipBinary = true;
+            }
+            else if (name == "--strict-tld")
+            {
+                rejectValue();
+                config.scanOptions.strictTld = true;
+            }
+            else if (name == "--redact-mode")
+            {
+                requireValue();
+                if (value == "token")
+                    config.redactMode = RedactionMode::TOKEN;
+                else if (value == "mask")
+                    config.redactMode = RedactionMode::MASK;
+                else if (value == "hash")
+                    config.redactMode = RedactionMode::HASH;
+                else if (value == "pseudonym")
+                    config.redactMode = RedactionMode::PSEUDONYM;
+                else if (value == "shape")
+                    config.redactMode = RedactionMode::SHAPE;
+                else
+                    throw std::invalid_argument("--redact-mode must be token, mask, shape, hash or pseudonym");
+            }
+            else if (name == "--pseudonym-cache")
+            {
+                requireValue();
+                config.pseudonymCacheEntries = static_cast<size_t>(parseSize(value, name));
+            }
+            else if (name == "--domain-cache")
+            {
+                requireValue();
+                config.domainCacheEntries = static_cast<size_t>(parseSize(value, name));
+            }
+            else if (name == "--validation-cache")
+            {
+                requireValue();
+                config.validationCacheEntries = static_cast<size_t>(parseSize(value, name));
+            }
+            else if (name == "--document-cache")
+            {
+                requireValue();
+                config.documentCacheEntries = static_cast<size_t>(parseSize(value, name));
+            }
+            else
+            {
+                throw std::invalid_argument("unknown benchmark option '" + std::string(arg) + "'");
+            }
+        }
+
+        // The complexity suite times contains/extract, which reject inputs over MAX_INPUT_SIZE; the
+        // size sweep streams larger inputs and only needs them to fit in memory
+        const size_t defaultMin = config.complexity ? 1024 : 64;
+        const size_t defaultMax = config.complexity ? 1024 * 1024 : size_t{1} << 30;
+        const size_t limitMax = config.complexity ? EmailScanner::getMaxInputSize() : size_t{1} << 32;
+        if (config.minSize == 0)
+            config.minSize = defaultMin;
+        if (config.maxSize == 0)
+            config.maxSize = std::max(defaultMax, config.minSize);
+        if (config.maxSize < config.minSize || config.maxSize > limitMax)
+            throw std::invalid_argument("--max-size must be at least --min-size and at most " +
+                                        std::to_string(limitMax) + " bytes");
+
+        // A generated corpus is megabytes per pass, not 80 short strings
+        if (!config.corpusTypes.empty() && !iterationsGiven)
+            config.iterations = 10;
+
+        return config;
+    }
+
+    static void printUsage(std::ostream &out)
+    {
+        out << "Benchmark options:\n"
+            << "  --workload=LIST     comma-separated: isValid,contains,extract,combined,batch,stream,redact or all\n"
+            << "                      (default: isValid,contains,extract,combined)\n"
+            << "  --threads=N         worker threads (default: hardware concurrency)\n"
+            << "  --iterations=N      corpus passes per thread (default: 100000)\n"
+            << "  --duration=SECONDS  run each workload for a fixed time instead of --iterations\n"
+            << "  --warmup=N          untimed corpus passes per thread before measuring (default: 0)\n"
+            << "  --stream-chunk=N    bytes per feed() call for the stream workload (default: 4096)\n"
+            << "  --pin[=core|smt|none]  pin worker threads to CPUs (Linux); core spreads over physical\n"
+            << "                      cores first, smt fills both SMT siblings of a core first, none\n"
+            << "                      (the default) leaves placement to the scheduler\n"
+            << "  --sweep             run every workload at 1, 2, 4 ... --threads threads and report scaling\n"
+            << "  --service=MODE      none (static scanner), shared or thread-local EmailScannerService\n"
+            << "  --perf              collect hardware performance counters (Linux perf_event_open)\n"
+            << "  --alloc             count heap allocations per operation and report peak RSS\n"
+            << "  --skip-binary       scan with ScanOptions::skipBinary (only '@'s in text or long printable runs)\n"
+            << "  --strict-tld        scan with ScanOptions::strictTld (only TLDs in the root zone)\n"
+            << "  --redact-mode=MODE  token, mask, shape, hash or pseudonym replacement for the redact workload\n"
+            << "  --pseudonym-cache=N shared address -> pseudonym cache entries for --redact-mode=pseudonym\n"
+            << "  --domain-cache=N    shared domain validation cache entries; reports its hit rate\n"
+            << "  --validation-cache=N  shared isValid result cache entries (any --service); reports its hit rate\n"
+            << "  --document-cache=N  shared extract result cache entries, keyed by document hash (any --service)\n"
+            << "  --json              print results as JSON (one object per corpus)\n"
+            << "  --corpus=LIST       generated corpora instead of the embedded test cases:\n"
+            << "                      syslog,json,html,mime,csv,binary or all (default passes: 10)\n"
+            << "  --doc-size=SIZE     bytes per generated document, K/M/G suffixes (default: 4K)\n"
+            << "  --corpus-size=SIZE  total generated bytes per corpus type (default: 4M)\n"
+            << "  --seed=N            generator seed (default: 42)\n"
+            << "  --email-density=P   probability that a record carries an email (default: 0.1)\n"
+            << "  --near-miss-rate=P  probability that a record carries a non-email '@' (default: 0.05)\n"
+            << "  --complexity        time pathological inputs from 1K to --max-size and fail on superlinear growth\n"
+            << "  --size-sweep        MB/s of contains, extract and stream per input size, doubling from\n"
+            << "                      --min-size to --max-size (default: 64 to 1G, first --corpus type)\n"
+            << "  --min-size=SIZE     smallest input for --complexity / --size-sweep\n"
+            << "  --max-size=SIZE     largest input (default: 1M for --complexity, 1G for --size-sweep)\n"
+            << "  --regex             compare extract() with a std::regex one-liner on the same corpora:\n"
+            << "                      MB/s, speedup and differing matches (--duration per side, default 1s)\n"
+            << "  --save-baseline=FILE  write throughput, p99 latency and cycles/byte per workload to FILE\n"
+            << "  --compare=FILE      diff this run against a saved baseline; exit 1 on regressions\n"
+            << "  --threshold=PCT     change that counts as a regression or improvement (default: 5)\n";
+    }
+};
+
+struct BenchmarkResult
+{
+    BenchmarkWorkload workload;
+    size_t threads = 0;
+    uint64_t operations = 0;
+    uint64_t bytes = 0;
+    uint64_t results = 0;
+    double seconds = 0.0;
+    HardwareCounters::Sample hardware;
+    // Sampled per-operation latency, including one steady_clock read pair
+    double p50Nanos = 0.0;
+    double p99Nanos = 0.0;
+    size_t latencySamples = 0;
+    bool allocationsTracked = false;
+    AllocationCounts allocations;
+    uint64_t peakResidentBytes = 0;
+    // Timed-loop counters of the domain validation cache, when one was used
+    bool domainCacheUsed = false;
+    DomainValidationCache::Stats domainCache;
+    bool validationCacheUsed = false;
+    ValidationResultCache::Stats validationCache;
+    bool documentCacheUsed = false;
+    DocumentResultCache::Stats documentCache;
+    // Filled in by thread-scaling sweeps, relative to the single-thread run of the same workload
+    double speedup = 0.0;
+    double efficiency = 0.0;
+
+    [[nodiscard]] double getOpsPerSecond() const noexcept
+    {
+        return seconds > 0.0 ? operations / seconds : 0.0;
+    }
+
+    [[nodiscard]] double getNanosPerOp() const noexcept
+    {
+        return operations > 0 ? seconds * 1e9 / operations : 0.0;
+    }
+
+    [[nodiscard]] double getMegabytesPerSecond() const noexcept
+    {
+        return seconds > 0.0 ? (bytes / 1048576.0) / seconds : 0.0;
+    }
+
+    [[nodiscard]] double getAllocationsPerOp() const noexcept
+    {
+        return operations > 0 ? static_cast<double>(allocations.allocations) / operations : 0.0;
+    }
+
+    [[nodiscard]] double getAllocatedBytesPerOp() const noexcept
+    {
+        return operations > 0 ? static_cast<double>(allocations.bytes) / operations : 0.0;
+    }
+};
+
+// ====================================================================================================
+// BENCHMARK BASELINES (Save results as JSON, diff later runs against them)
+// ====================================================================================================
+
+class BenchmarkBaseline
+{
+public:
+    static constexpr int FORMAT_VERSION = 1;
+
+    // One workload at one thread count on one corpus; zero means "not measured"
+    struct Entry
+    {
+        std::string corpus;
+        std::string workload;
+        uint64_t threads = 0;
+        double opsPerSecond = 0.0;
+        double megabytesPerSecond = 0.0;
+        double p99Nanos = 0.0;
+        double cyclesPerByte = 0.0;
+
+        [[nodiscard]] bool sameRun(const Entry &other) const noexcept
+        {
+            return corpus == other.corpus && workload == other.workload && threads == other.threads;
+        }
+    };
+
+    [[nodiscard]] static Entry fromResult(std::string_view corpus, const BenchmarkResult &result)
+    {
+        Entry entry;
+        entry.corpus = std::string(corpus);
+        entry.workload = workloadName(result.workload);
+        entry.threads = result.threads;
+        entry.opsPerSecond = result.getOpsPerSecond();
+        entry.megabytesPerSecond = result.getMegabytesPerSecond();
+        entry.p99Nanos = result.p99Nanos;
+        if (result.hardware.has(HardwareCounters::CYCLES))
+            entry.cyclesPerByte = result.hardware.perByte(HardwareCounters::CYCLES, result.bytes);
+        return entry;
+    }
+
+    static void save(const std::string &path, const std::vector<Entry> &entries)
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("cannot write baseline file '" + path + "'");
+
+        file << "{\"version\":" << FORMAT_VERSION << ",\"results\":[\n";
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            const auto &entry = entries[i];
+            file << "{\"corpus\":\"" << entry.corpus << "\""
+                 << ",\"workload\":\"" << entry.workload << "\""
+                 << ",\"threads\":" << entry.threads
+                 << std::setprecision(10)
+                 << ",\"ops_per_sec\":" << entry.opsPerSecond
+                 << ",\"mb_per_sec\":" << entry.megabytesPerSecond
+                 << ",\"p99_ns\":" << entry.p99Nanos
+                 << ",\"cycles_per_byte\":";
+            if (entry.cyclesPerByte > 0.0)
+                file << entry.cyclesPerByte;
+            else
+                file << "null";
+            file << "}" << (i + 1 < entries.size() ? "," : "") << "\n";
+        }
+        file << "]}\n";
+
+        if (!file)
+            throw std::runtime_error("failed writing baseline file '" + path + "'");
+    }
+
+    [[nodiscard]] static std::vector<Entry> load(const std::string &path)
+    {
+        std::ifstream file(path);
+        if (!file)
+            throw std::runtime_error("cannot read baseline file '" + path + "'");
+
+        const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return Parser(text, path).parseBaseline();
+    }
+
+    // Prints every metric of every run present in both sets and flags changes beyond the
+    // threshold. Returns false if any metric regressed by more than the threshold.
+    static bool compare(const std::vector<Entry> &baseline, const std::vector<Entry> &current,
+                        double thresholdPercent, bool json, std::ostream &out)
+    {
+        struct Metric
+        {
+            const char *name;
+            double Entry::*field;
+            bool higherIsBetter;
+        };
+
+        static constexpr std::array<Metric, 3> METRICS = {{
+            {"mb_per_sec", &Entry::megabytesPerSecond, true},
+            {"p99_ns", &Entry::p99Nanos, false},
+            {"cycles_per_byte", &Entry::cyclesPerByte, false},
+        }};
+
+        size_t regressions = 0;
+        size_t improvements = 0;
+        bool firstJson = true;
+
+        if (json)
+        {
+            out << "{\"comparison\":[";
+        }
+        else
+        {
+            out << std::string(100, '-') << "\n";
+            out << "BASELINE COMPARISON (threshold " << thresholdPercent << "%)\n";
+            out << std::string(100, '-') << "\n";
+            out << std::left << std::setw(10) << "corpus" << std::setw(10) << "workload" << std::right
+                << std::setw(8) << "threads" << std::setw(18) << "metric" << std::setw(14) << "baseline"
+                << std::setw(14) << "current" << std::setw(10) << "delta" << "\n";
+        }
+
+        for (const auto &now : current)
+        {
+            const auto before = std::find_if(baseline.begin(), baseline.end(),
+                                             [&now](const Entry &entry)
+                                             { return entry.sameRun(now); });
+            if (before == baseline.end())
+            {
+                if (!json)
+                    out << std::left << std::setw(10) << now.corpus << std::setw(10) << now.workload << std::right
+                        << std::setw(8) << now.threads << "  (not in baseline)\n";
+                continue;
+            }
+
+            for (const auto &metric : METRICS)
+            {
+                const double was = (*before).*metric.field;
+                const double is = now.*metric.field;
+                if (was <= 0.0 || is <= 0.0)
+                    continue;
+
+                const double delta = (is - was) / was * 100.0;
+                const double gain = metric.higherIsBetter ? delta : -delta;
+                const bool regressed = gain < -thresholdPercent;
+                const bool improved = gain > thresholdPercent;
+                regressions += regressed ? 1 : 0;
+                improvements += improved ? 1 : 0;
+
+                if (json)
+                {
+                    out << (firstJson ? "" : ",") << "{\"corpus\":\"" << now.corpus << "\""
+                        << ",\"workload\":\"" << now.workload << "\""
+                        << ",\"threads\":" << now.threads
+                        << ",\"metric\":\"" << metric.name << "\""
+                        << ",\"baseline\":" << was << ",\"current\":" << is
+                        << ",\"delta_percent\":" << delta
+                        << ",\"status\":\"" << (regressed ? "regression" : improved ? "improvement" : "unchanged") << "\"}";
+                    firstJson = false;
+                    continue;
+                }
+
+                out << std::left << std::setw(10) << now.corpus << std::setw(10) << now.workload << std::right
+                    << std::setw(8) << now.threads << std::setw(18) << metric.name
+                    << std::setw(14) << was << std::setw(14) << is
+                    << std::setw(9) << std::fixed << std::setprecision(1) << std::showpos << delta << "%"
+                    << std::noshowpos << std::defaultfloat << std::setprecision(6)
+                    << (regressed ? "  ✗ REGRESSION" : improved ? "  ✓ improved" : "") << "\n";
+            }
+        }
+
+        if (json)
+        {
+            out << "],\"regressions\":" << regressions << ",\"improvements\":" << improvements << "}\n";
+        }
+        else
+        {
+            out << std::string(100, '-') << "\n";
+            out << (regressions == 0 ? "✓ " : "✗ ") << regressions << " regression(s), "
+                << improvements << " improvement(s) beyond " << thresholdPercent << "%\n\n";
+        }
+
+        return regressions == 0;
+    }
+
+private:
+    // Reads back what save() writes: an object whose "results" array holds flat objects
+    class Parser
+    {
+    private:
+        std::string_view text_;
+        const std::string &path_;
+        size_t pos_ = 0;
+
+        [[noreturn]] void fail(const std::string &what) const
+        {
+            throw std::runtime_error("invalid baseline file '" + path_ + "': " + what + " at offset " +
+                                     std::to_string(pos_));
+        }
+
+        void skipSpace() noexcept
+        {
+            while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_])))
+                ++pos_;
+        }
+
+        [[nodiscard]] bool consume(char c) noexcept
+        {
+            skipSpace();
+            if (pos_ < text_.size() && text_[pos_] == c)
+            {
+                ++pos_;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char c)
+        {
+            if (!consume(c))
+                fail(std::string("expected '") + c + "'");
+        }
+
+        [[nodiscard]] std::string parseString()
+        {
+            expect('"');
+            std::string value;
+            while (pos_ < text_.size() && text_[pos_] != '"')
+            {
+                char c = text_[pos_++];
+                if (c == '\\')
+                {
+                    if (pos_ >= text_.size())
+                        break;
+                    c = text_[pos_++];
+                    if (c != '"' && c != '\\' && c != '/')
+                        fail("unsupported escape");
+                }
+                value += c;
+            }
+            if (pos_ >= text_.size())
+                fail("unterminated string");
+            ++pos_;
+            return value;
+        }
+
+        // Numbers as doubles; null reads as 0 ("not measured")
+        [[nodiscard]] double parseNumber()
+        {
+            skipSpace();
+            if (text_.substr(pos_, 4) == "null")
+            {
+                pos_ += 4;
+                return 0.0;
+            }
+
+            const std::string rest(text_.substr(pos_, 64));
+            char *end = nullptr;
+            const double value = std::strtod(rest.c_str(), &end);
+            if (end == rest.c_str())
+                fail("expected a number");
+            pos_ += static_cast<size_t>(end - rest.c_str());
+            return value;
+        }
+
+        void skipValue()
+        {
+            skipSpace();
+            if (pos_ >= text_.size())
+                fail("unexpected end of input");
+
+            const char c = text_[pos_];
+            if (c == '"')
+            {
+                (void)parseString();
+            }
+            else if (c == '{' || c == '[')
+            {
+                const char close = c == '{' ? '}' : ']';
+                ++pos_;
+                if (consume(close))
+                    return;
+                do
+                {
+                    if (c == '{')
+                    {
+                        (void)parseString();
+                        expect(':');
+                    }
+                    skipValue();
+                } while (consume(','));
+                expect(close);
+            }
+            else if (text_.substr(pos_, 4) == "true" || text_.substr(pos_, 4) == "null")
+            {
+                pos_ += 4;
+            }
+            else if (text_.substr(pos_, 5) == "false")
+            {
+                pos_ += 5;
+            }
+            else
+            {
+                (void)parseNumber();
+            }
+        }
+
+        [[nodiscard]] Entry parseEntry()
+        {
+            Entry entry;
+            expect('{');
+            if (consume('}'))
+                return entry;
+            do
+            {
+                const std::string key = parseString();
+                expect(':');
+                if (key == "corpus")
+                    entry.corpus = parseString();
+                else if (key == "workload")
+                    entry.workload = parseString();
+                else if (key == "threads")
+                    entry.threads = static_cast<uint64_t>(parseNumber());
+                else if (key == "ops_per_sec")
+                    entry.opsPerSecond = parseNumber();
+                else if (key == "mb_per_sec")
+                    entry.megabytesPerSecond = parseNumber();
+                else if (key == "p99_ns")
+                    entry.p99Nanos = parseNumber();
+                else if (key == "cycles_per_byte")
+                    entry.cyclesPerByte = parseNumber();
+                else
+                    skipValue();
+            } while (consume(','));
+            expect('}');
+            return entry;
+        }
+
+    public:
+        Parser(std::string_view text, const std::string &path) : text_(text), path_(path) {}
+
+        [[nodiscard]] std::vector<Entry> parseBaseline()
+        {
+            std::vector<Entry> entries;
+            bool versionSeen = false;
+
+            expect('{');
+            do
+            {
+                const std::string key = parseString();
+                expect(':');
+                if (key == "version")
+                {
+                    if (parseNumber() != FORMAT_VERSION)
+                        fail("unsupported version");
+                    versionSeen = true;
+                }
+                else if (key == "results")
+                {
+                    expect('[');
+                    if (!consume(']'))
+                    {
+                        do
+                        {
+                            entries.push_back(parseEntry());
+                        } while (consume(','));
+                        expect(']');
+                    }
+                }
+                else
+                {
+                    skipValue();
+                }
+            } while (consume(','));
+            expect('}');
+
+            if (!versionSeen)
+                fail("missing version");
+            return entries;
+        }
+    };
+};
+
+class EmailBenchmark
+{
+private:
+    struct ThreadTotals
+    {
+        uint64_t operations = 0;
+        uint64_t bytes = 0;
+        uint64_t results = 0;
+        AllocationCounts allocations;
+        std::vector<uint32_t> latencies;
+    };
+
+    // Per-operation latency is sampled on every LATENCY_SAMPLE_INTERVAL-th corpus pass (every pass
+    // for whole-document workloads), up to MAX_LATENCY_SAMPLES per thread
+    static constexpr uint64_t LATENCY_SAMPLE_INTERVAL = 8;
+    static constexpr size_t MAX_LATENCY_SAMPLES = 1 << 16;
+
+    // One pass over the corpus for a workload; each worker thread owns one instance
+    class WorkloadPass
+    {
+    private:
+        BenchmarkWorkload workload_;
+        const std::vector<std::string> &corpus_;
+        const std::string &document_;
+        size_t streamChunkSize_;
+        ScanOptions options_;
+        EmailStreamScanner streamScanner_;
+        std::string redacted_;
+        RedactionPolicy redaction_;
+        EmailValidationService *validationService_;
+        ValidationResultCache *validationCache_;
+        EmailScannerService *scannerService_;
+        DocumentResultCache *documentCache_;
+
+        [[nodiscard]] bool isValid(std::string_view text) const
+        {
+            if (validationService_)
+                return validationService_->validate(text);
+            return validationCache_ ? validationCache_->isValid(text) : EmailValidator::isValid(text);
+        }
+
+        [[nodiscard]] bool contains(std::string_view text) const
+        {
+            ScanReport report;
+            return scannerService_ ? scannerService_->contains(text, options_)
+                                   : EmailScanner::contains(text, report, options_);
+        }
+
+        [[nodiscard]] std::vector<std::string> extract(std::string_view text) const
+        {
+            ScanReport report;
+            if (scannerService_)
+                return scannerService_->extract(text, options_);
+            return documentCache_ ? documentCache_->extract(text, report, options_)
+                                  : EmailScanner::extract(text, report, options_);
+        }
+
+        // Times one operation into latencies while it has spare capacity, so sampling never allocates
+        template <typename Operation>
+        static void measure(std::vector<uint32_t> *latencies, Operation &&operation)
+        {
+            if (latencies == nullptr || latencies->size() == latencies->capacity())
+            {
+                operation();
+                return;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            operation();
+            const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now() - start)
+                                   .count();
+            latencies->push_back(static_cast<uint32_t>(std::min<int64_t>(nanos, UINT32_MAX)));
+        }
+
+    public:
+        WorkloadPass(BenchmarkWorkload workload, const std::vector<std::string> &corpus,
+                     const std::string &document, size_t streamChunkSize, const ScanOptions &options,
+                     const RedactionPolicy &redaction, EmailValidationService *validationService,
+                     ValidationResultCache *validationCache, EmailScannerService *scannerService,
+                     DocumentResultCache *documentCache)
+            : workload_(workload), corpus_(corpus), document_(document), streamChunkSize_(streamChunkSize),
+              options_(options), streamScanner_(EmailStreamScanner::DEFAULT_WINDOW_SIZE, options),
+              redaction_(redaction), validationService_(validationService), validationCache_(validationCache),
+              scannerService_(scannerService), documentCache_(documentCache)
+        {
+        }
+
+        // Operations per run() call, each one a latency sample when sampled
+        [[nodiscard]] bool isWholeDocument() const noexcept
+        {
+            return workload_ == BenchmarkWorkload::BATCH || workload_ == BenchmarkWorkload::STREAM;
+        }
+
+        void run(ThreadTotals &totals, std::vector<uint32_t> *latencies = nullptr)
+        {
+            switch (workload_)
+            {
+            case BenchmarkWorkload::IS_VALID:
+                for (const auto &text : corpus_)
+                {
+                    measure(latencies, [&]()
+                            { totals.results += isValid(text) ? 1 : 0; });
+                    totals.bytes += text.size();
+                }
+                totals.operations += corpus_.size();
+                break;
+
+            case BenchmarkWorkload::CONTAINS:
+                for (const auto &text : corpus_)
+                {
+                    measure(latencies, [&]()
+                            { totals.results += contains(text) ? 1 : 0; });
+                    totals.bytes += text.size();
+                }
+                totals.operations += corpus_.size();
+                break;
+
+            case BenchmarkWorkload::EXTRACT:
+                for (const auto &text : corpus_)
+                {
+                    measure(latencies, [&]()
+                            { totals.results += extract(text).size(); });
+                    totals.bytes += text.size();
+                }
+                totals.operations += corpus_.size();
+                break;
+
+            case BenchmarkWorkload::COMBINED:
+                for (const auto &text : corpus_)
+                {
+                    // Real-world pattern: check first, extract if found, or validate exact emails
+                    measure(latencies, [&]()
+                            {
+                        if (contains(text))
+                            totals.results += extract(text).size();
+                        if (isValid(text))
+                            ++totals.results; });
+                    totals.bytes += text.size();
+                }
+                totals.operations += corpus_.size();
+                break;
+
+            case BenchmarkWorkload::BATCH:
+                measure(latencies, [&]()
+                        { totals.results += extract(document_).size(); });
+                totals.bytes += document_.size();
+                ++totals.operations;
+                break;
+
+            case BenchmarkWorkload::STREAM:
+            {
+                uint64_t found = 0;
+                auto onMatch = [&found](std::string_view, uint64_t)
+                { ++found; };
+
+                measure(latencies, [&]()
+                        {
+                    std::string_view rest(document_);
+                    while (!rest.empty())
+                    {
+                        const size_t take = std::min(rest.size(), streamChunkSize_);
+                        streamScanner_.feed(rest.substr(0, take), onMatch);
+                        rest.remove_prefix(take);
+                    }
+                    streamScanner_.finish(onMatch); });
+
+                totals.results += found;
+                totals.bytes += document_.size();
+                ++totals.operations;
+                break;
+            }
+
+            case BenchmarkWorkload::REDACT:
+                for (const auto &text : corpus_)
+                {
+                    measure(latencies, [&]()
+                            {
+                        ScanReport report;
+                        redacted_.clear();
+                        EmailScanner::redact(text, redacted_, redaction_, report, options_);
+                        totals.results += report.emailsFound; });
+                    totals.bytes += text.size();
+                }
+                totals.operations += corpus_.size();
+                break;
+            }
+        }
+    };
+
+    [[nodiscard]] static int readCpuTopologyValue(int cpu, const char *name)
+    {
+        std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name);
+        int value = -1;
+        if (!(file >> value))
+            return -1;
+        return value;
+    }
+
+    // Allowed CPUs ordered for the requested placement; SMT siblings share (package, core_id)
+    [[nodiscard]] static std::vector<int> cpuOrder(BenchmarkPinMode mode)
+    {
+        std::vector<int> cpus = availableCpus();
+        if (mode == BenchmarkPinMode::NONE)
+            return {};
+        if (mode == BenchmarkPinMode::ANY || cpus.empty())
+            return cpus;
+
+        struct CpuSlot
+        {
+            int cpu;
+            int package;
+            int core;
+            int siblingRank;
+        };
+
+        std::vector<CpuSlot> slots;
+        for (int cpu : cpus)
+        {
+            const int package = readCpuTopologyValue(cpu, "physical_package_id");
+            const int core = readCpuTopologyValue(cpu, "core_id");
+            int siblingRank = 0;
+            for (const auto &slot : slots)
+            {
+                if (slot.package == package && slot.core == core)
+                    ++siblingRank;
+            }
+            // Without topology information every CPU counts as its own core
+            slots.push_back({cpu, package, core < 0 ? cpu : core, core < 0 ? 0 : siblingRank});
+        }
+
+        std::stable_sort(slots.begin(), slots.end(), [mode](const CpuSlot &a, const CpuSlot &b)
+                         {
+                             if (mode == BenchmarkPinMode::PHYSICAL_CORES && a.siblingRank != b.siblingRank)
+                                 return a.siblingRank < b.siblingRank;
+                             if (a.package != b.package)
+                                 return a.package < b.package;
+                             if (a.core != b.core)
+                                 return a.core < b.core;
+                             return a.siblingRank < b.siblingRank; });
+
+        std::vector<int> ordered;
+        ordered.reserve(slots.size());
+        for (const auto &slot : slots)
+            ordered.push_back(slot.cpu);
+        return ordered;
+    }
+
+    [[nodiscard]] static const char *pinModeName(BenchmarkPinMode mode) noexcept
+    {
+        switch (mode)
+        {
+        case BenchmarkPinMode::NONE:
+            return "off";
+        case BenchmarkPinMode::ANY:
+            return "on";
+        case BenchmarkPinMode::PHYSICAL_CORES:
+            return "physical cores first";
+        case BenchmarkPinMode::SMT_SIBLINGS:
+            return "SMT siblings first";
+        }
+        return "unknown";
+    }
+
+    [[nodiscard]] static const char *serviceModeName(BenchmarkServiceMode mode) noexcept
+    {
+        switch (mode)
+        {
+        case BenchmarkServiceMode::NONE:
+            return "none";
+        case BenchmarkServiceMode::SHARED:
+            return "shared";
+        case BenchmarkServiceMode::THREAD_LOCAL:
+            return "thread-local";
+        }
+        return "unknown";
+    }
+
+    // Thread counts for a sweep: powers of two up to maxThreads, plus maxThreads itself
+    [[nodiscard]] static std::vector<size_t> sweepThreadCounts(size_t maxThreads)
+    {
+        std::vector<size_t> counts;
+        for (size_t n = 1; n < maxThreads; n *= 2)
+            counts.push_back(n);
+        counts.push_back(maxThreads);
+        return counts;
+    }
+
+    [[nodiscard]] static std::vector<int> availableCpus()
+    {
+        std::vector<int> cpus;
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &set))
+                    cpus.push_back(cpu);
+            }
+        }
+#endif
+        return cpus;
+    }
+
+    static bool pinCurrentThread(int cpu) noexcept
+    {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+
+    [[nodiscard]] static const char *workloadTitle(BenchmarkWorkload workload) noexcept
+    {
+        switch (workload)
+        {
+        case BenchmarkWorkload::IS_VALID:
+            return "isValid() - Exact Email Validation";
+        case BenchmarkWorkload::CONTAINS:
+            return "contains() - Fast Email Detection";
+        case BenchmarkWorkload::EXTRACT:
+            return "extract() - Full Email Extraction";
+        case BenchmarkWorkload::COMBINED:
+            return "Combined Workload (Real-world)";
+        case BenchmarkWorkload::BATCH:
+            return "extract() - Whole Corpus As One Document";
+        case BenchmarkWorkload::STREAM:
+            return "EmailStreamScanner - Chunked Stream Scanning";
+        case BenchmarkWorkload::REDACT:
+            return "redact() - One-Pass Token Redaction";
+        }
+        return "unknown";
+    }
+
+    [[nodiscard]] static const char *resultLabel(BenchmarkWorkload workload) noexcept
+    {
+        switch (workload)
+        {
+        case BenchmarkWorkload::IS_VALID:
+            return "Valid emails found";
+        case BenchmarkWorkload::CONTAINS:
+            return "Texts with emails";
+        case BenchmarkWorkload::EXTRACT:
+        case BenchmarkWorkload::BATCH:
+            return "Emails extracted";
+        case BenchmarkWorkload::COMBINED:
+            return "Results produced";
+        case BenchmarkWorkload::STREAM:
+            return "Emails streamed";
+        case BenchmarkWorkload::REDACT:
+            return "Emails redacted";
+        }
+        return "Results";
+    }
+
+    // Per-line std::regex extraction, kept to lines a recursive regex executor can handle
+    static constexpr size_t MAX_REGEX_LINE = 64 * 1024;
+
+    struct RegexComparison
+    {
+        uint64_t bytes = 0;
+        uint64_t scannerPasses = 0;
+        uint64_t regexPasses = 0;
+        double scannerSeconds = 0.0;
+        double regexSeconds = 0.0;
+        uint64_t matchedByBoth = 0;
+        uint64_t scannerOnly = 0;
+        uint64_t regexOnly = 0;
+        uint64_t skippedLines = 0;
+        std::vector<std::string> scannerOnlyExamples;
+        std::vector<std::string> regexOnlyExamples;
+
+        [[nodiscard]] double getScannerMegabytesPerSecond() const noexcept
+        {
+            return scannerSeconds > 0.0 ? (bytes * scannerPasses / 1048576.0) / scannerSeconds : 0.0;
+        }
+
+        [[nodiscard]] double getRegexMegabytesPerSecond() const noexcept
+        {
+            return regexSeconds > 0.0 ? (bytes * regexPasses / 1048576.0) / regexSeconds : 0.0;
+        }
+
+        [[nodiscard]] double getSpeedup() const noexcept
+        {
+            const double regex = getRegexMegabytesPerSecond();
+            return regex > 0.0 ? getScannerMegabytesPerSecond() / regex : 0.0;
+        }
+    };
+
+    // The usual one-liner: dot-atom local part, dot-separated labels, alphabetic TLD
+    [[nodiscard]] static const std::regex &baselineRegex()
+    {
+        static const std::regex pattern(
+            R"([A-Za-z0-9!#$%&'*+/=?^_`{|}~-]+(?:\.[A-Za-z0-9!#$%&'*+/=?^_`{|}~-]+)*)"
+            R"(@(?:[A-Za-z0-9](?:[A-Za-z0-9-]{0,61}[A-Za-z0-9])?\.)+[A-Za-z]{2,})",
+            std::regex::ECMAScript | std::regex::optimize);
+        return pattern;
+    }
+
+    // Unique matches per document, like extract(); counts lines too long for the regex engine
+    [[nodiscard]] static std::vector<std::string> regexExtract(const std::string &document, uint64_t &skippedLines)
+    {
+        std::vector<std::string> emails;
+        std::unordered_set<std::string> seen;
+        const std::regex &pattern = baselineRegex();
+
+        size_t lineStart = 0;
+        while (lineStart < document.size())
+        {
+            size_t lineEnd = document.find('\n', lineStart);
+            if (lineEnd == std::string::npos)
+                lineEnd = document.size();
+
+            if (lineEnd - lineStart > MAX_REGEX_LINE)
+            {
+                ++skippedLines;
+            }
+            else
+            {
+                const auto begin = document.begin() + static_cast<std::ptrdiff_t>(lineStart);
+                const auto end = document.begin() + static_cast<std::ptrdiff_t>(lineEnd);
+                for (std::sregex_iterator it(begin, end, pattern), last; it != last; ++it)
+                {
+                    std::string email = it->str();
+                    if (seen.insert(email).second)
+                        emails.push_back(std::move(email));
+                }
+            }
+            lineStart = lineEnd + 1;
+        }
+        return emails;
+    }
+
+    [[nodiscard]] static std::string exampleText(const std::string &email)
+    {
+        static constexpr size_t MAX_EXAMPLE_LENGTH = 80;
+        if (email.size() <= MAX_EXAMPLE_LENGTH)
+            return email;
+        return email.substr(0, MAX_EXAMPLE_LENGTH) + "... (" + std::to_string(email.size()) + " bytes)";
+    }
+
+    template <typename Extractor>
+    static void timeExtraction(const std::vector<std::string> &corpus, double minSeconds,
+                               uint64_t &passes, double &seconds, Extractor &&extractor)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        do
+        {
+            for (const auto &document : corpus)
+                (void)extractor(document);
+            ++passes;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (seconds < minSeconds);
+    }
+
+    [[nodiscard]] static RegexComparison compareWithRegex(const std::vector<std::string> &corpus, double minSeconds)
+    {
+        static constexpr size_t MAX_EXAMPLES = 5;
+        RegexComparison comparison;
+
+        for (const auto &document : corpus)
+        {
+            comparison.bytes += document.size();
+
+            const auto scanned = EmailScanner::extract(document);
+            uint64_t skipped = 0;
+            const auto matched = regexExtract(document, skipped);
+            comparison.skippedLines += skipped;
+
+            const std::unordered_set<std::string> scannedSet(scanned.begin(), scanned.end());
+            const std::unordered_set<std::string> matchedSet(matched.begin(), matched.end());
+
+            for (const auto &email : scanned)
+            {
+                if (matchedSet.count(email))
+                {
+                    ++comparison.matchedByBoth;
+                    continue;
+                }
+                ++comparison.scannerOnly;
+                if (comparison.scannerOnlyExamples.size() < MAX_EXAMPLES)
+                    comparison.scannerOnlyExamples.push_back(exampleText(email));
+            }
+
+            for (const auto &email : matched)
+            {
+                if (scannedSet.count(email))
+                    continue;
+                ++comparison.regexOnly;
+                if (comparison.regexOnlyExamples.size() < MAX_EXAMPLES)
+                    comparison.regexOnlyExamples.push_back(exampleText(email));
+            }
+        }
+
+        timeExtraction(corpus, minSeconds, comparison.scannerPasses, comparison.scannerSeconds,
+                       [](const std::string &document)
+                       { return EmailScanner::extract(document); });
+
+        uint64_t skipped = 0;
+        timeExtraction(corpus, minSeconds, comparison.regexPasses, comparison.regexSeconds,
+                       [&skipped](const std::string &document)
+                       { return regexExtract(document, skipped); });
+
+        return comparison;
+    }
+
+    static void printRegexComparison(std::ostream &out, const RegexComparison &comparison,
+                                     std::string_view corpusLabel, bool json)
+    {
+        if (json)
+        {
+            out << "{\"regex_comparison\":{\"corpus\":\"" << corpusLabel << "\""
+                << ",\"bytes\":" << comparison.bytes
+                << ",\"scanner_mb_per_sec\":" << comparison.getScannerMegabytesPerSecond()
+                << ",\"regex_mb_per_sec\":" << comparison.getRegexMegabytesPerSecond()
+                << ",\"speedup\":" << comparison.getSpeedup()
+                << ",\"matched_by_both\":" << comparison.matchedByBoth
+                << ",\"scanner_only\":" << comparison.scannerOnly
+                << ",\"regex_only\":" << comparison.regexOnly
+                << ",\"regex_skipped_lines\":" << comparison.skippedLines << "}}\n";
+            return;
+        }
+
+        out << std::string(100, '-') << "\n";
+        out << "REGEX BASELINE: " << corpusLabel << " (" << comparison.bytes << " bytes)\n";
+        out << std::string(100, '-') << "\n";
+        out << "EmailScanner::extract: " << comparison.getScannerMegabytesPerSecond() << " MB/s ("
+            << comparison.scannerPasses << " passes)\n";
+        out << "std::regex_search:     " << comparison.getRegexMegabytesPerSecond() << " MB/s ("
+            << comparison.regexPasses << " passes)\n";
+        out << "Speedup: " << std::fixed << std::setprecision(1) << comparison.getSpeedup() << "x\n"
+            << std::defaultfloat << std::setprecision(6);
+        out << "Matched by both: " << comparison.matchedByBoth << "\n";
+        out << "Scanner only: " << comparison.scannerOnly << "\n";
+        for (const auto &email : comparison.scannerOnlyExamples)
+            out << "  + " << email << "\n";
+        out << "Regex only: " << comparison.regexOnly << "\n";
+        for (const auto &email : comparison.regexOnlyExamples)
+            out << "  - " << email << "\n";
+        if (comparison.skippedLines > 0)
+            out << "Lines over " << MAX_REGEX_LINE << " bytes skipped by the regex: " << comparison.skippedLines << "\n";
+        out << "\n";
+    }
+
+private:
+    // Data cache sizes in bytes (L1d, L2, L3), 0 where the platform does not say
+    [[nodiscard]] static std::array<size_t, 3> dataCacheSizes() noexcept
+    {
+        std::array<size_t, 3> sizes{};
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+        const std::array<int, 3> names = {_SC_LEVEL1_DCACHE_SIZE, _SC_LEVEL2_CACHE_SIZE, _SC_LEVEL3_CACHE_SIZE};
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            const long value = sysconf(names[i]);
+            sizes[i] = value > 0 ? static_cast<size_t>(value) : 0;
+        }
+#endif
+        return sizes;
+    }
+
+    [[nodiscard]] static const char *cacheLevelFor(size_t bytes, const std::array<size_t, 3> &caches) noexcept
+    {
+        static constexpr std::array<const char *, 3> LEVELS = {"L1", "L2", "L3"};
+        for (size_t i = 0; i < caches.size(); ++i)
+        {
+            if (caches[i] > 0 && bytes <= caches[i])
+                return LEVELS[i];
+        }
+        return caches[2] > 0 ? "DRAM" : "?";
+    }
+
+    // Median MB/s of one scanner path over windows of `size` bytes. Every repetition moves the
+    // window to a fresh random offset in the arena, then repeats the call until it has covered
+    // about 64 KiB so tiny inputs are not dominated by the clock.
+    template <typename Operation>
+    [[nodiscard]] static double measureWindowThroughput(const std::string &arena, size_t size, uint64_t &rngState,
+                                                        Operation &&operation)
+    {
+        using Clock = std::chrono::steady_clock;
+        static constexpr auto MIN_TOTAL = std::chrono::milliseconds(50);
+        static constexpr int MIN_REPEATS = 3;
+        static constexpr int MAX_REPEATS = 1001;
+        static constexpr size_t CALL_BYTES = 64 * 1024;
+
+        const size_t span = arena.size() - size;
+        const size_t calls = std::max<size_t>(1, CALL_BYTES / size);
+
+        std::vector<double> nanosPerByte;
+        const auto begin = Clock::now();
+        for (int repeat = 0; repeat < MAX_REPEATS; ++repeat)
+        {
+            uint64_t z = (rngState += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            const size_t offset = span > 0 ? static_cast<size_t>((z ^ (z >> 31)) % (span + 1)) : 0;
+            const std::string_view window(arena.data() + offset, size);
+
+            const auto start = Clock::now();
+            for (size_t call = 0; call < calls; ++call)
+                operation(window);
+            const auto end = Clock::now();
+
+            nanosPerByte.push_back(std::chrono::duration<double, std::nano>(end - start).count() /
+                                   static_cast<double>(calls * size));
+            if (repeat + 1 >= MIN_REPEATS && end - begin >= MIN_TOTAL)
+                break;
+        }
+
+        std::nth_element(nanosPerByte.begin(), nanosPerByte.begin() + nanosPerByte.size() / 2, nanosPerByte.end());
+        const double median = nanosPerByte[nanosPerByte.size() / 2];
+        return median > 0.0 ? 1e9 / median / 1048576.0 : 0.0;
+    }
+
+public:
+    // Input-size sweep from --min-size to --max-size, doubling each step, for the per-message
+    // (contains/extract) and bulk (EmailStreamScanner) paths. Sizes above MAX_INPUT_SIZE are
+    // rejected by contains/extract, so only the stream path is timed there.
+    static void runSizeSweep(const BenchmarkConfig &config, std::ostream &out)
+    {
+        // Random window placement spans a few pages beyond the largest window
+        static constexpr size_t PLACEMENT_SPAN = 16 * 1024;
+        static constexpr size_t MAX_GENERATED = 16 * 1024 * 1024;
+
+        const CorpusType type = config.corpusTypes.empty() ? CorpusType::SYSLOG : config.corpusTypes.front();
+        const size_t arenaSize = config.maxSize + PLACEMENT_SPAN;
+
+        CorpusOptions options = config.corpusOptions;
+        options.documentSize = std::min(arenaSize, MAX_GENERATED);
+        CorpusGenerator generator(options);
+        const std::string tile = generator.generateDocument(type);
+
+        std::string arena;
+        arena.reserve(arenaSize);
+        while (arena.size() < arenaSize)
+            arena.append(tile, 0, std::min(tile.size(), arenaSize - arena.size()));
+
+        const auto caches = dataCacheSizes();
+        uint64_t rngState = config.corpusOptions.seed;
+        EmailStreamScanner stream;
+        const size_t chunkSize = config.streamChunkSize;
+
+        auto containsPath = [](std::string_view window)
+        { (void)EmailScanner::contains(window); };
+        bool extractTruncated = false;
+        auto extractPath = [&extractTruncated](std::string_view window)
+        {
+            ScanReport report;
+            (void)EmailScanner::extract(window, report);
+            extractTruncated = extractTruncated || report.wasTruncated();
+        };
+        auto streamPath = [&stream, chunkSize](std::string_view window)
+        {
+            auto onMatch = [](std::string_view, uint64_t) {};
+            while (!window.empty())
+            {
+                const size_t take = std::min(window.size(), chunkSize);
+                stream.feed(window.substr(0, take), onMatch);
+                window.remove_prefix(take);
+            }
+            stream.finish(onMatch);
+        };
+
+        if (config.jsonOutput)
+        {
+            out << "{\"size_sweep\":{\"corpus\":\"" << corpusTypeName(type) << "\""
+                << ",\"l1d_bytes\":" << caches[0] << ",\"l2_bytes\":" << caches[1] << ",\"l3_bytes\":" << caches[2]
+                << ",\"points\":[";
+        }
+        else
+        {
+            out << "\n"
+                << std::string(100, '=') << "\n";
+            out << "=== INPUT SIZE SWEEP ===\n";
+            out << std::string(100, '=') << "\n";
+            out << "Corpus: " << corpusTypeName(type) << ", single thread, median of random window placements\n";
+            out << "Data caches: L1d " << caches[0] / 1024 << " KiB, L2 " << caches[1] / 1024 << " KiB, L3 "
+                << caches[2] / 1024 << " KiB (0 = unknown)\n";
+            out << "Inputs over " << EmailScanner::getMaxInputSize() << " bytes only take the stream path; contains\n"
+                << "returns at the first match; '*' marks extract runs stopped by a MAX_* guard\n\n";
+            out << std::setw(14) << "bytes" << std::setw(7) << "fits" << std::setw(16) << "contains MB/s"
+                << std::setw(16) << "extract MB/s" << std::setw(16) << "stream MB/s" << "\n";
+        }
+
+        bool first = true;
+        for (size_t size = config.minSize; size <= config.maxSize; size *= 2)
+        {
+            const bool perMessage = size <= EmailScanner::getMaxInputSize();
+            extractTruncated = false;
+            const double containsRate = perMessage ? measureWindowThroughput(arena, size, rngState, containsPath) : 0.0;
+            const double extractRate = perMessage ? measureWindowThroughput(arena, size, rngState, extractPath) : 0.0;
+            const double streamRate = measureWindowThroughput(arena, size, rngState, streamPath);
+
+            if (config.jsonOutput)
+            {
+                auto rate = [&out](double value)
+                {
+                    if (value > 0.0)
+                        out << value;
+                    else
+                        out << "null";
+                };
+                out << (first ? "" : ",") << "{\"bytes\":" << size
+                    << ",\"fits\":\"" << cacheLevelFor(size, caches) << "\",\"contains_mb_per_sec\":";
+                rate(containsRate);
+                out << ",\"extract_mb_per_sec\":";
+                rate(extractRate);
+                out << ",\"extract_truncated\":" << (extractTruncated ? "true" : "false");
+                out << ",\"stream_mb_per_sec\":";
+                rate(streamRate);
+                out << "}";
+                first = false;
+                continue;
+            }
+
+            auto rate = [&out](double value, bool marked)
+            {
+                if (value > 0.0)
+                    out << std::setw(15) << std::fixed << std::setprecision(1) << value << std::defaultfloat
+                        << (marked ? '*' : ' ');
+                else
+                    out << std::setw(15) << "-" << ' ';
+            };
+            out << std::setw(14) << size << std::setw(7) << cacheLevelFor(size, caches);
+            rate(containsRate, false);
+            rate(extractRate, extractTruncated);
+            rate(streamRate, false);
+            out << std::setprecision(6) << "\n";
+        }
+
+        if (config.jsonOutput)
+            out << "]}}\n";
+        else
+            out << "\n";
+    }
+
+    // Known worst cases for the boundary logic, each generated at an arbitrary size
+    enum class PathologicalFamily
+    {
+        AT_RUN,
+        DOT_RUN,
+        ALTERNATING_QUOTES,
+        A_AT_A,
+        ATEXT_RUN_4096,
+        LONG_DOMAIN
+    };
+
+    static constexpr std::array<PathologicalFamily, 6> ALL_PATHOLOGICAL_FAMILIES = {
+        PathologicalFamily::AT_RUN, PathologicalFamily::DOT_RUN, PathologicalFamily::ALTERNATING_QUOTES,
+        PathologicalFamily::A_AT_A, PathologicalFamily::ATEXT_RUN_4096, PathologicalFamily::LONG_DOMAIN};
+
+    [[nodiscard]] static const char *pathologicalFamilyName(PathologicalFamily family) noexcept
+    {
+        switch (family)
+        {
+        case PathologicalFamily::AT_RUN:
+            return "at-run";
+        case PathologicalFamily::DOT_RUN:
+            return "dot-run";
+        case PathologicalFamily::ALTERNATING_QUOTES:
+            return "alternating-quotes";
+        case PathologicalFamily::A_AT_A:
+            return "a@a@a";
+        case PathologicalFamily::ATEXT_RUN_4096:
+            return "atext-4096";
+        case PathologicalFamily::LONG_DOMAIN:
+            return "long-domain";
+        }
+        return "unknown";
+    }
+
+    [[nodiscard]] static std::string generatePathological(PathologicalFamily family, size_t size)
+    {
+        std::string unit;
+        switch (family)
+        {
+        case PathologicalFamily::AT_RUN:
+            unit = "@";
+            break;
+        case PathologicalFamily::DOT_RUN:
+            unit = "a" + std::string(62, '.') + "@";
+            break;
+        case PathologicalFamily::ALTERNATING_QUOTES:
+            unit = "\"'`\"'`\"'`\"'`a@b.co\"'`";
+            break;
+        case PathologicalFamily::A_AT_A:
+            unit = "a@";
+            break;
+        case PathologicalFamily::ATEXT_RUN_4096:
+            unit = std::string(4096, 'a') + "@";
+            break;
+        case PathologicalFamily::LONG_DOMAIN:
+        {
+            unit = "u@";
+            while (unit.size() < 2 + 250)
+                unit += "abcdefghi.";
+            unit += "com ";
+            break;
+        }
+        }
+
+        std::string text;
+        text.reserve(size + unit.size());
+        while (text.size() < size)
+            text += unit;
+        text.resize(size);
+        return text;
+    }
+
+private:
+    struct ComplexityPoint
+    {
+        size_t bytes = 0;
+        double nanosPerByte = 0.0;
+        ScanLimit truncatedBy = ScanLimit::NONE;
+    };
+
+    // Best-of-N wall time per byte for one scanner entry point on one input
+    template <typename Operation>
+    [[nodiscard]] static ComplexityPoint measureComplexityPoint(const std::string &text, Operation &&operation)
+    {
+        using Clock = std::chrono::steady_clock;
+        static constexpr auto MIN_TOTAL = std::chrono::milliseconds(20);
+        static constexpr int MIN_REPEATS = 3;
+        static constexpr int MAX_REPEATS = 10000;
+
+        ComplexityPoint point;
+        point.bytes = text.size();
+
+        double best = 0.0;
+        const auto begin = Clock::now();
+        for (int repeat = 0; repeat < MAX_REPEATS; ++repeat)
+        {
+            ScanReport report;
+            const auto start = Clock::now();
+            operation(text, report);
+            const auto end = Clock::now();
+
+            const double nanos = std::chrono::duration<double, std::nano>(end - start).count();
+            if (repeat == 0 || nanos < best)
+                best = nanos;
+            point.truncatedBy = report.truncatedBy;
+
+            if (repeat + 1 >= MIN_REPEATS && end - begin >= MIN_TOTAL)
+                break;
+        }
+
+        point.nanosPerByte = best / static_cast<double>(std::max<size_t>(text.size(), 1));
+        return point;
+    }
+
+    // Least-squares slope of log(time) against log(size): 1.0 is linear, 2.0 quadratic. Only the
+    // larger half of the uncapped sizes is fitted so fixed per-call costs do not mask the trend.
+    // NaN when fewer than two uncapped sizes remain.
+    [[nodiscard]] static double complexityExponent(const std::vector<ComplexityPoint> &points)
+    {
+        std::vector<ComplexityPoint> uncapped;
+        for (const auto &point : points)
+        {
+            if (point.truncatedBy == ScanLimit::NONE && point.nanosPerByte > 0.0)
+                uncapped.push_back(point);
+        }
+
+        if (uncapped.size() < 2)
+            return std::numeric_limits<double>::quiet_NaN();
+
+        double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+        size_t n = 0;
+
+        for (size_t i = std::min(uncapped.size() / 2, uncapped.size() - 2); i < uncapped.size(); ++i)
+        {
+            const auto &point = uncapped[i];
+            const double x = std::log(static_cast<double>(point.bytes));
+            const double y = std::log(point.nanosPerByte * static_cast<double>(point.bytes));
+            sumX += x;
+            sumY += y;
+            sumXX += x * x;
+            sumXY += x * y;
+            ++n;
+        }
+
+        const double denominator = n * sumXX - sumX * sumX;
+        return denominator != 0.0 ? (n * sumXY - sumX * sumY) / denominator : 1.0;
+    }
+
+public:
+    // Growth exponent above which a family counts as superlinear (leaves room for timer noise)
+    static constexpr double MAX_LINEAR_EXPONENT = 1.3;
+
+    // Measures ns/byte against input size for every pathological family through contains(),
+    // extract() and forEachMatch(). Sizes where a MAX_* guard stopped the scan are shown but
+    // left out of the fit, since a capped scan hides the real cost. Returns false if any
+    // family grows superlinearly.
+    static bool runComplexitySuite(const BenchmarkConfig &config, std::ostream &out)
+    {
+        struct EntryPoint
+        {
+            const char *name;
+            void (*run)(const std::string &, ScanReport &);
+        };
+
+        static constexpr std::array<EntryPoint, 3> ENTRY_POINTS = {{
+            {"contains", [](const std::string &text, ScanReport &report)
+             { (void)EmailScanner::contains(text, report); }},
+            {"extract", [](const std::string &text, ScanReport &report)
+             { (void)EmailScanner::extract(text, report); }},
+            {"scan", [](const std::string &text, ScanReport &report)
+             { EmailScanner::forEachMatch(text, report, [](size_t, size_t)
+                                          { return true; }); }},
+        }};
+
+        std::vector<size_t> sizes;
+        for (size_t size = config.minSize; size <= config.maxSize; size *= 2)
+            sizes.push_back(size);
+
+        bool allLinear = true;
+
+        if (!config.jsonOutput)
+        {
+            out << "\n"
+                << std::string(100, '=') << "\n";
+            out << "=== PATHOLOGICAL INPUT COMPLEXITY ===\n";
+            out << std::string(100, '=') << "\n";
+            out << "ns/byte per input size; '*' marks sizes stopped by a MAX_* guard (excluded from the fit)\n";
+            out << "Superlinear threshold: exponent > " << MAX_LINEAR_EXPONENT << "\n\n";
+        }
+        else
+        {
+            out << "{\"complexity\":[";
+        }
+
+        bool firstJson = true;
+        for (PathologicalFamily family : ALL_PATHOLOGICAL_FAMILIES)
+        {
+            std::array<std::vector<ComplexityPoint>, ENTRY_POINTS.size()> curves;
+            for (size_t size : sizes)
+            {
+                const std::string text = generatePathological(family, size);
+                for (size_t e = 0; e < ENTRY_POINTS.size(); ++e)
+                    curves[e].push_back(measureComplexityPoint(text, ENTRY_POINTS[e].run));
+            }
+
+            if (!config.jsonOutput)
+            {
+                out << std::string(100, '-') << "\n";
+                out << "FAMILY: " << pathologicalFamilyName(family) << "\n";
+                out << std::string(100, '-') << "\n";
+                out << std::setw(12) << "bytes";
+                for (const auto &entry : ENTRY_POINTS)
+                    out << std::setw(16) << entry.name;
+                out << "\n";
+
+                for (size_t i = 0; i < sizes.size(); ++i)
+                {
+                    out << std::setw(12) << sizes[i];
+                    for (const auto &curve : curves)
+                    {
+                        out << std::setw(15) << std::fixed << std::setprecision(3) << curve[i].nanosPerByte
+                            << (curve[i].truncatedBy != ScanLimit::NONE ? '*' : ' ');
+                    }
+                    out << std::defaultfloat << std::setprecision(6) << "\n";
+                }
+            }
+
+            for (size_t e = 0; e < ENTRY_POINTS.size(); ++e)
+            {
+                const double exponent = complexityExponent(curves[e]);
+                const bool superlinear = exponent > MAX_LINEAR_EXPONENT;
+                allLinear = allLinear && !superlinear;
+
+                ScanLimit firstCap = ScanLimit::NONE;
+                size_t firstCapSize = 0;
+                for (const auto &point : curves[e])
+                {
+                    if (point.truncatedBy != ScanLimit::NONE)
+                    {
+                        firstCap = point.truncatedBy;
+                        firstCapSize = point.bytes;
+                        break;
+                    }
+                }
+
+                if (!config.jsonOutput)
+                {
+                    out << "  " << std::setw(9) << ENTRY_POINTS[e].name << ": ";
+                    if (std::isnan(exponent))
+                        out << "exponent n/a  - too few uncapped sizes";
+                    else
+                        out << "exponent " << std::fixed << std::setprecision(2) << exponent
+                            << std::defaultfloat << std::setprecision(6)
+                            << (superlinear ? "  ✗ SUPERLINEAR" : "  ✓ linear");
+                    if (firstCap != ScanLimit::NONE)
+                        out << "  (capped by " << scanLimitName(firstCap) << " from " << firstCapSize << " bytes)";
+                    out << "\n";
+                    continue;
+                }
+
+                out << (firstJson ? "" : ",") << "{\"family\":\"" << pathologicalFamilyName(family)
+                    << "\",\"api\":\"" << ENTRY_POINTS[e].name
+                    << "\",\"exponent\":";
+                if (std::isnan(exponent))
+                    out << "null";
+                else
+                    out << exponent;
+                out << ",\"superlinear\":" << (superlinear ? "true" : "false")
+                    << ",\"points\":[";
+                for (size_t i = 0; i < curves[e].size(); ++i)
+                {
+                    const auto &point = curves[e][i];
+                    out << (i > 0 ? "," : "") << "{\"bytes\":" << point.bytes
+                        << ",\"ns_per_byte\":" << point.nanosPerByte
+                        << ",\"capped_by\":\"" << scanLimitName(point.truncatedBy) << "\"}";
+                }
+                out << "]}";
+                firstJson = false;
+            }
+
+            if (!config.jsonOutput)
+                out << "\n";
+        }
+
+        if (config.jsonOutput)
+        {
+            out << "],\"passed\":" << (allLinear ? "true" : "false") << "}\n";
+        }
+        else
+        {
+            out << std::string(100, '=') << "\n";
+            out << (allLinear ? "✓ All pathological families scale linearly\n"
+                              : "✗ Superlinear growth detected\n");
+            out << std::string(100, '=') << "\n\n";
+        }
+
+        return allLinear;
+    }
+
+    [[nodiscard]] static std::vector<std::string> defaultCorpus()
+    {
+        return {
+            "Simple email: user@example.com in text",
+            "Multiple emails: first@domain.com and second@another.org",
+            "user..double@domain.com",
+            "Complex: john.doe+filter@sub.domain.co.uk mixed with text",
+            "No emails in this text at all",
+            "Edge case: a@b.co minimal email",
+            "review-team@geeksforgeeks.org",
+            "user..double@domain.com",
+            "user.@domain.com",
+            "27 age and alpha@gmail.com and other data",
+            "adfdgifldj@fk458439678 4krf8956 346 alpha@gmail.com r90wjk kf433@8958ifdjkks fgkl548765gr",
+            "27 age and alphatyicbnkdleoxkthes123fd56569565@gmail.com and othere data missing...!",
+            "any aged group and alphatyic(b)nkdleoxk%t/hes123fd56569565@gmail.com and othere data missing...!",
+            "27 age and alphatyicbnk.?'.,dleoxkthes123fd56569565@gmail.com and othere data missing...! other@email.co",
+            "27 age and alphatyicbnkdleo$#-=+xkthes123fd56569565@gmail.com and othere data missing...!",
+            "No email here",
+            "test@domain",
+            "invalid@.com",
+            "valid.email+tag@example.co.uk",
+            "Contact us at support@company.com for help",
+            "Multiple: first@test.com, second@demo.org",
+            "invalid@.com and test@domain",
+            std::string(1000, 'x') + "hidden@email.com" + std::string(1000, 'y'),
+
+            "user@example.com",
+            "a@b.co",
+            "test.user@example.com",
+            "user+tag@gmail.com",
+
+            "user!test@example.com",
+            "user#tag@example.com",
+            "user$admin@example.com",
+            "user%percent@example.com",
+            "user&name@example.com",
+            "user'quote@example.com",
+            "user*star@example.com",
+            "user=equal@example.com",
+            "user?question@example.com",
+            "user^caret@example.com",
+            "user_underscore@example.com",
+            "user`backtick@example.com",
+            "userbrace@example.com",
+            "user|pipe@example.com",
+            "user}brace@example.com",
+            "user~tilde@example.com",
+
+            "\"user\"@example.com",
+            "\"user name\"@example.com",
+            "\"user@internal\"@example.com",
+            "\"user.name\"@example.com",
+            "\"user\\\"name\"@example.com",
+            "\"user\\\\name\"@example.com",
+
+            "user@[192.168.1.1]",
+            "user@[2001:db8::1]",
+            "test@[10.0.0.1]",
+            "user@[fe80::1]",
+            "user@[::1]",
+
+            "first.last@sub.domain.co.uk",
+            "user@domain-name.com",
+            "user@123.456.789.012",
+            "user@domain.x",
+            "user@domain.123",
+
+            "user..double@domain.com",
+            ".user@domain.com",
+            "user.@domain.com",
+            "user@domain..com",
+            "@example.com",
+            "user@",
+            "userexample.com",
+            "user@@example.com",
+            "user@domain",
+            "user@.domain.com",
+            "user@domain.com.",
+            "user@-domain.com",
+            "user@domain-.com",
+            "user name@example.com",
+            "user@domain .com",
+            "\"unclosed@example.com",
+            "\"user\"name@example.com",
+            "user@[192.168.1]",
+            "user@[999.168.1.1]",
+            "user@[192.168.1.256]",
+            "user@[gggg::1]",
+        };
+    }
+
+    // Joins the corpus into the single document used by the batch and stream workloads
+    [[nodiscard]] static std::string joinCorpus(const std::vector<std::string> &corpus)
+    {
+        std::string document;
+        for (const auto &text : corpus)
         {
-            unsigned char closingQuote = static_cast<unsigned char>(data[atPos - 1]);
-            size_t quotesSeen = 0;
+            document += text;
+            document += '\n';
+        }
+        return document;
+    }
 
-            if (atPos >= 2)
-            {
-                for (size_t i = atPos; i > absoluteMin + 1 && i > 1;)
+    [[nodiscard]] static BenchmarkResult runWorkload(const BenchmarkConfig &config, BenchmarkWorkload workload,
+                                                     const std::vector<std::string> &corpus,
+                                                     const std::string &document,
+                                                     const std::vector<int> &cpuOrder)
+    {
+        const size_t numThreads = config.threads;
+        std::vector<ThreadTotals> totals(numThreads);
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads);
+
+        std::atomic<size_t> ready{0};
+        std::atomic<bool> go{false};
+        std::chrono::steady_clock::time_point deadline{};
+
+        HardwareCounters counters(config.hardwareCounters);
+        std::optional<AllocationTracker::Scope> allocationTracking;
+        if (config.trackAllocations)
+            allocationTracking.emplace();
+
+        std::shared_ptr<ValidationResultCache> validationCache;
+        if (config.validationCacheEntries > 0)
+            validationCache = std::make_shared<ValidationResultCache>(config.validationCacheEntries);
+
+        std::shared_ptr<DocumentResultCache> documentCache;
+        if (config.documentCacheEntries > 0)
+            documentCache = std::make_shared<DocumentResultCache>(config.documentCacheEntries);
+
+        EmailValidationService sharedValidationService(validationCache);
+        EmailScannerService sharedScannerService(documentCache);
+
+        // One pseudonymizer for all threads, so its cache sees their combined traffic
+        const EmailPseudonymizer pseudonymizer(PseudonymKey{0x0706050403020100ULL, 0x0f0e0d0c0b0a0908ULL}, "user:",
+                                               config.pseudonymCacheEntries);
+        RedactionPolicy redaction;
+        redaction.mode = config.redactMode;
+        redaction.pseudonymizer = &pseudonymizer;
+
+        std::optional<DomainValidationCache> domainCache;
+        ScanOptions scanOptions = config.scanOptions;
+        if (config.domainCacheEntries > 0)
+        {
+            domainCache.emplace(config.domainCacheEntries);
+            scanOptions.domainCache = &*domainCache;
+        }
+
+        for (size_t t = 0; t < numThreads; ++t)
+        {
+            threads.emplace_back(
+                [&, t]()
                 {
-                    --i;
-                    ++quotesSeen;
+                    if (!cpuOrder.empty())
+                        pinCurrentThread(cpuOrder[t % cpuOrder.size()]);
+
+                    EmailValidationService localValidationService(validationCache);
+                    EmailScannerService localScannerService(documentCache);
+                    EmailValidationService *validationService = nullptr;
+                    EmailScannerService *scannerService = nullptr;
+                    if (config.serviceMode == BenchmarkServiceMode::SHARED)
+                    {
+                        validationService = &sharedValidationService;
+                        scannerService = &sharedScannerService;
+                    }
+                    else if (config.serviceMode == BenchmarkServiceMode::THREAD_LOCAL)
+                    {
+                        validationService = &localValidationService;
+                        scannerService = &localScannerService;
+                    }
 
-                    batcher.recordOperation(opCounter);
-                    if (opCounter.load(std::memory_order_relaxed) > MAX_TOTAL_OPERATIONS) [[unlikely]]
+                    WorkloadPass pass(workload, corpus, document, config.streamChunkSize, scanOptions,
+                                      redaction, validationService, validationCache.get(), scannerService,
+                                      documentCache.get());
+                    ThreadTotals warmup;
+                    for (uint64_t i = 0; i < config.warmupIterations; ++i)
+                        pass.run(warmup);
+
+                    ready.fetch_add(1, std::memory_order_acq_rel);
+                    while (!go.load(std::memory_order_acquire))
+                        std::this_thread::yield();
+
+                    ThreadTotals local;
+                    local.latencies.reserve(MAX_LATENCY_SAMPLES);
+                    const uint64_t sampleInterval = pass.isWholeDocument() ? 1 : LATENCY_SAMPLE_INTERVAL;
+                    auto runPass = [&](uint64_t i)
+                    { pass.run(local, i % sampleInterval == 0 ? &local.latencies : nullptr); };
+
+                    const auto allocationsBefore = AllocationTracker::getThreadCounts();
+                    if (config.durationSeconds > 0.0)
                     {
-                        return {atPos, atPos, false, atPos, false};
+                        for (uint64_t i = 0; std::chrono::steady_clock::now() < deadline; ++i)
+                            runPass(i);
+                    }
+                    else
+                    {
+                        for (uint64_t i = 0; i < config.iterations; ++i)
+                            runPass(i);
                     }
 
-                    if (quotesSeen > MAX_QUOTE_SCAN)
-                        break;
+                    local.allocations = AllocationTracker::getThreadCounts() - allocationsBefore;
+                    totals[t] = std::move(local);
+                });
+        }
 
-                    if (data[i] == closingQuote)
-                    {
-                        bool validBoundary = (i == 0 || i == absoluteMin);
+        while (ready.load(std::memory_order_acquire) < numThreads)
+            std::this_thread::yield();
+
+        if (domainCache)
+            domainCache->resetStats();
+        if (validationCache)
+            validationCache->resetStats();
+        if (documentCache)
+            documentCache->resetStats();
+        counters.start();
+        const auto start = std::chrono::steady_clock::now();
+        deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                               std::chrono::duration<double>(config.durationSeconds));
+        go.store(true, std::memory_order_release);
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
 
-                        if (!validBoundary && i > 0)
-                        {
-                            unsigned char prevChar = static_cast<unsigned char>(data[i - 1]);
-                            validBoundary = CharacterClassifier::isScanBoundary(prevChar) ||
-                                            prevChar == ' ' ||
-                                            prevChar == '=' ||
-                                            prevChar == ':' ||
-                                            prevChar == ',' ||
-                                            prevChar == '<' ||
-                                            prevChar == '(' ||
-                                            prevChar == '[' ||
-                                            prevChar == '\r' ||
-                                            prevChar == '\n' ||
-                                            CharacterClassifier::isInvalidLocalChar(prevChar);
-                        }
+        const auto end = std::chrono::steady_clock::now();
 
-                        if (validBoundary && (atPos - i) >= 3)
-                        {
-                            bool rightBoundaryValid = true;
-                            if (end < len)
-                            {
-                                unsigned char nextChar = static_cast<unsigned char>(data[end]);
-                                if (!CharacterClassifier::isScanRightBoundary(nextChar) &&
-                                    nextChar != '\'' && nextChar != '`' && nextChar != '"' &&
-                                    nextChar != '@' && nextChar != '\\' &&
-                                    nextChar != ',' && nextChar != ';' && nextChar != '.' &&
-                                    nextChar != '!' && nextChar != '?' &&
-                                    !CharacterClassifier::isAtext(nextChar))
-                                {
-                                    rightBoundaryValid = false;
-                                }
-                            }
+        BenchmarkResult result;
+        result.workload = workload;
+        result.threads = numThreads;
+        result.hardware = counters.stop();
+        result.seconds = std::chrono::duration<double>(end - start).count();
+        if (domainCache)
+        {
+            result.domainCacheUsed = true;
+            result.domainCache = domainCache->getStats();
+        }
+        if (validationCache)
+        {
+            result.validationCacheUsed = true;
+            result.validationCache = validationCache->getStats();
+        }
+        if (documentCache)
+        {
+            result.documentCacheUsed = true;
+            result.documentCache = documentCache->getStats();
+        }
 
-                            if (rightBoundaryValid)
-                            {
-                                return {i, end, true, 0, false};
-                            }
-                        }
-                    }
+        std::vector<uint32_t> latencies;
+        for (const auto &local : totals)
+        {
+            result.operations += local.operations;
+            result.bytes += local.bytes;
+            result.results += local.results;
+            result.allocations += local.allocations;
+            latencies.insert(latencies.end(), local.latencies.begin(), local.latencies.end());
+        }
+
+        if (!latencies.empty())
+        {
+            auto percentile = [&latencies](double fraction)
+            {
+                const size_t index = std::min(latencies.size() - 1,
+                                              static_cast<size_t>(fraction * static_cast<double>(latencies.size())));
+                std::nth_element(latencies.begin(), latencies.begin() + static_cast<std::ptrdiff_t>(index),
+                                 latencies.end());
+                return static_cast<double>(latencies[index]);
+            };
+            result.p50Nanos = percentile(0.50);
+            result.p99Nanos = percentile(0.99);
+            result.latencySamples = latencies.size();
+        }
+
+        if (config.trackAllocations && AllocationTracker::isAvailable())
+        {
+            result.allocationsTracked = true;
+            result.peakResidentBytes = AllocationTracker::getPeakResidentBytes();
+        }
+
+        return result;
+    }
+
+    static void printTextResult(std::ostream &out, const BenchmarkResult &result, size_t index, bool withCounters)
+    {
+        out << std::string(100, '-') << "\n";
+        out << "BENCHMARK " << index << ": " << workloadTitle(result.workload) << "\n";
+        out << std::string(100, '-') << "\n";
+        out << "Time: " << static_cast<uint64_t>(result.seconds * 1000.0) << " ms\n";
+        out << "Operations: " << result.operations << "\n";
+        out << "Throughput: " << static_cast<uint64_t>(result.getOpsPerSecond()) << " ops/sec\n";
+        out << resultLabel(result.workload) << ": " << result.results << "\n";
+        out << "Avg latency: " << result.getNanosPerOp() << " ns/op\n";
+        if (result.latencySamples > 0)
+            out << "Latency p50/p99: " << result.p50Nanos << " / " << result.p99Nanos << " ns ("
+                << result.latencySamples << " samples)\n";
+        out << "Byte throughput: " << result.getMegabytesPerSecond() << " MB/s\n";
+        if (result.allocationsTracked)
+        {
+            out << "Allocations: " << result.getAllocationsPerOp() << "/op ("
+                << result.getAllocatedBytesPerOp() << " bytes/op, "
+                << result.allocations.allocations << " total)\n";
+            out << "Peak RSS: " << result.peakResidentBytes / 1024 << " KiB\n";
+        }
+        if (result.domainCacheUsed)
+            out << "Domain cache: " << result.domainCache.getHitRate() * 100.0 << "% hits ("
+                << result.domainCache.hits << " hits, " << result.domainCache.misses << " misses, "
+                << result.domainCache.bypassed << " bypassed, " << result.domainCache.capacity << " entries)\n";
+        if (result.validationCacheUsed)
+            out << "Validation cache: " << result.validationCache.getHitRate() * 100.0 << "% hits ("
+                << result.validationCache.hits << " hits, " << result.validationCache.misses << " misses, "
+                << result.validationCache.bypassed << " bypassed, " << result.validationCache.evictions
+                << " evictions, " << result.validationCache.capacity << " entries)\n";
+        if (result.documentCacheUsed)
+            out << "Document cache: " << result.documentCache.getHitRate() * 100.0 << "% hits ("
+                << result.documentCache.hits << " hits, " << result.documentCache.misses << " misses, "
+                << result.documentCache.bypassed << " bypassed, " << result.documentCache.evictions << " evictions, "
+                << result.documentCache.bytesSaved / (1024 * 1024) << " MiB not scanned)\n";
+
+        if (!withCounters)
+        {
+            out << "\n";
+            return;
+        }
+
+        const auto &hw = result.hardware;
+        if (!hw.any())
+        {
+            out << "Hardware counters: unavailable (perf_event_open denied or unsupported)\n\n";
+            return;
+        }
+
+        out << "Hardware counters:\n";
+        for (size_t i = 0; i < HardwareCounters::EVENT_COUNT; ++i)
+        {
+            const auto event = static_cast<HardwareCounters::Event>(i);
+            out << "  " << HardwareCounters::eventName(event) << ": ";
+            if (hw.has(event))
+                out << hw.get(event) << " (" << hw.perByte(event, result.bytes) << "/byte)\n";
+            else
+                out << "n/a\n";
+        }
+        if (hw.has(HardwareCounters::CYCLES) && hw.has(HardwareCounters::INSTRUCTIONS))
+            out << "  IPC: " << hw.getIPC() << "\n";
+        out << "\n";
+    }
+
+    static void printJsonResult(std::ostream &out, const BenchmarkResult &result)
+    {
+        out << "{\"workload\":\"" << workloadName(result.workload) << "\""
+            << ",\"threads\":" << result.threads
+            << ",\"operations\":" << result.operations
+            << ",\"bytes\":" << result.bytes
+            << ",\"results\":" << result.results
+            << ",\"seconds\":" << result.seconds
+            << ",\"ops_per_sec\":" << result.getOpsPerSecond()
+            << ",\"ns_per_op\":" << result.getNanosPerOp()
+            << ",\"p50_ns\":" << result.p50Nanos
+            << ",\"p99_ns\":" << result.p99Nanos
+            << ",\"mb_per_sec\":" << result.getMegabytesPerSecond();
+
+        if (result.speedup > 0.0)
+            out << ",\"speedup\":" << result.speedup << ",\"efficiency\":" << result.efficiency;
+
+        if (result.allocationsTracked)
+            out << ",\"allocations\":" << result.allocations.allocations
+                << ",\"allocations_per_op\":" << result.getAllocationsPerOp()
+                << ",\"alloc_bytes_per_op\":" << result.getAllocatedBytesPerOp()
+                << ",\"peak_rss_bytes\":" << result.peakResidentBytes;
+
+        if (result.domainCacheUsed)
+            out << ",\"domain_cache_hits\":" << result.domainCache.hits
+                << ",\"domain_cache_misses\":" << result.domainCache.misses
+                << ",\"domain_cache_bypassed\":" << result.domainCache.bypassed;
+
+        if (result.validationCacheUsed)
+            out << ",\"validation_cache_hits\":" << result.validationCache.hits
+                << ",\"validation_cache_misses\":" << result.validationCache.misses
+                << ",\"validation_cache_bypassed\":" << result.validationCache.bypassed
+                << ",\"validation_cache_evictions\":" << result.validationCache.evictions;
+
+        if (result.documentCacheUsed)
+            out << ",\"document_cache_hits\":" << result.documentCache.hits
+                << ",\"document_cache_misses\":" << result.documentCache.misses
+                << ",\"document_cache_bypassed\":" << result.documentCache.bypassed
+                << ",\"document_cache_evictions\":" << result.documentCache.evictions
+                << ",\"document_cache_bytes_saved\":" << result.documentCache.bytesSaved;
+
+        const auto &hw = result.hardware;
+        if (hw.any())
+        {
+            out << ",\"counters\":{";
+            bool first = true;
+            for (size_t i = 0; i < HardwareCounters::EVENT_COUNT; ++i)
+            {
+                const auto event = static_cast<HardwareCounters::Event>(i);
+                if (!hw.has(event))
+                    continue;
+                out << (first ? "" : ",") << "\"" << HardwareCounters::eventName(event) << "\":" << hw.get(event);
+                first = false;
+            }
+            if (hw.has(HardwareCounters::CYCLES) && hw.has(HardwareCounters::INSTRUCTIONS))
+                out << ",\"ipc\":" << hw.getIPC();
+            if (hw.has(HardwareCounters::BRANCH_MISSES))
+                out << ",\"branch_misses_per_byte\":" << hw.perByte(HardwareCounters::BRANCH_MISSES, result.bytes);
+            out << "}";
+        }
+        out << "}";
+    }
+
+    static void printScalingCurve(std::ostream &out, const std::vector<BenchmarkResult> &curve)
+    {
+        if (curve.empty())
+            return;
+
+        out << std::string(100, '-') << "\n";
+        out << "SCALING: " << workloadTitle(curve.front().workload) << "\n";
+        out << std::string(100, '-') << "\n";
+        out << std::setw(8) << "Threads" << std::setw(18) << "ops/sec" << std::setw(14) << "MB/s"
+            << std::setw(12) << "speedup" << std::setw(14) << "efficiency" << "\n";
+
+        for (const auto &point : curve)
+        {
+            out << std::setw(8) << point.threads
+                << std::setw(18) << static_cast<uint64_t>(point.getOpsPerSecond())
+                << std::setw(14) << std::fixed << std::setprecision(1) << point.getMegabytesPerSecond()
+                << std::setw(11) << std::setprecision(2) << point.speedup << "x"
+                << std::setw(13) << std::setprecision(1) << point.efficiency * 100.0 << "%"
+                << std::defaultfloat << std::setprecision(6) << "\n";
+        }
+        out << "\n";
+    }
+
+    // Runs the benchmark over the embedded test cases, or over each generated corpus type
+    // followed by a MB/s summary per corpus
+    // Times extract() against a std::regex one-liner over the same corpora and diffs the matches
+    static void runRegexBaseline(const BenchmarkConfig &config, std::ostream &out)
+    {
+        const double minSeconds = config.durationSeconds > 0.0 ? config.durationSeconds : 1.0;
+
+        if (!config.jsonOutput)
+        {
+            out << "\n"
+                << std::string(100, '=') << "\n";
+            out << "=== STD::REGEX BASELINE ===\n";
+            out << std::string(100, '=') << "\n";
+            out << "Single thread, at least " << minSeconds << " s per side; regex runs per line\n\n";
+        }
+
+        if (config.corpusTypes.empty())
+        {
+            printRegexComparison(out, compareWithRegex(defaultCorpus(), minSeconds), "embedded", config.jsonOutput);
+            return;
+        }
+
+        for (CorpusType type : config.corpusTypes)
+        {
+            CorpusGenerator generator(config.corpusOptions);
+            const auto corpus = generator.generateCorpus(type, config.corpusSize);
+            printRegexComparison(out, compareWithRegex(corpus, minSeconds), corpusTypeName(type), config.jsonOutput);
+        }
+    }
+
+    static bool runConfigured(const BenchmarkConfig &config, std::ostream &out)
+    {
+        if (config.complexity)
+            return runComplexitySuite(config, out);
+
+        if (config.sizeSweep)
+        {
+            runSizeSweep(config, out);
+            return true;
+        }
+
+        if (config.regexBaseline)
+        {
+            runRegexBaseline(config, out);
+            return true;
+        }
+
+        // Read the baseline first so a bad path fails before minutes of benchmarking
+        std::vector<BenchmarkBaseline::Entry> baseline;
+        if (!config.compareBaselinePath.empty())
+            baseline = BenchmarkBaseline::load(config.compareBaselinePath);
+
+        std::vector<BenchmarkBaseline::Entry> current;
+        auto record = [&current](std::string_view corpus, const std::vector<BenchmarkResult> &results)
+        {
+            for (const auto &result : results)
+                current.push_back(BenchmarkBaseline::fromResult(corpus, result));
+        };
+
+        if (config.corpusTypes.empty())
+        {
+            record("embedded", run(config, defaultCorpus(), out));
+        }
+        else
+        {
+            std::vector<std::pair<CorpusType, std::vector<BenchmarkResult>>> summary;
+            for (CorpusType type : config.corpusTypes)
+            {
+                CorpusGenerator generator(config.corpusOptions);
+                const auto corpus = generator.generateCorpus(type, config.corpusSize);
+                summary.emplace_back(type, run(config, corpus, out, corpusTypeName(type)));
+                record(corpusTypeName(type), summary.back().second);
+            }
+
+            if (!config.jsonOutput)
+                printCorpusSummary(config, summary, out);
+        }
+
+        if (!config.saveBaselinePath.empty())
+        {
+            BenchmarkBaseline::save(config.saveBaselinePath, current);
+            if (!config.jsonOutput)
+                out << "Baseline written to " << config.saveBaselinePath << "\n\n";
+        }
+
+        if (!config.compareBaselinePath.empty())
+            return BenchmarkBaseline::compare(baseline, current, config.regressionThresholdPercent,
+                                              config.jsonOutput, out);
+        return true;
+    }
+
+    static void printCorpusSummary(const BenchmarkConfig &config,
+                                   const std::vector<std::pair<CorpusType, std::vector<BenchmarkResult>>> &summary,
+                                   std::ostream &out)
+    {
+        out << std::string(100, '-') << "\n";
+        out << "THROUGHPUT BY CORPUS (MB/s)\n";
+        out << std::string(100, '-') << "\n";
+        out << std::setw(10) << "corpus";
+        for (BenchmarkWorkload workload : config.workloads)
+            out << std::setw(12) << workloadName(workload);
+        out << "\n";
+
+        for (const auto &[type, results] : summary)
+        {
+            out << std::setw(10) << corpusTypeName(type);
+            for (BenchmarkWorkload workload : config.workloads)
+            {
+                // Sweeps report several points per workload; the summary uses the widest one
+                double best = 0.0;
+                for (const auto &result : results)
+                {
+                    if (result.workload == workload)
+                        best = result.getMegabytesPerSecond();
                 }
+                out << std::setw(12) << std::fixed << std::setprecision(1) << best << std::defaultfloat;
             }
+            out << "\n";
         }
+        out << std::setprecision(6) << "\n";
+    }
 
-        size_t effectiveMin = std::max(minScannedIndex, absoluteMin);
-        size_t start = atPos;
-        bool hitInvalidChar = false;
-        size_t invalidCharPos = atPos;
-        bool didRecovery = false;
-        bool didTrim = false;
-        size_t charsScanned = 0;
+    // Runs every configured workload over the corpus and prints the results
+    static std::vector<BenchmarkResult> run(const BenchmarkConfig &config, const std::vector<std::string> &corpus,
+                                            std::ostream &out, std::string_view corpusLabel = "embedded")
+    {
+        const std::string document = joinCorpus(corpus);
+        const std::vector<int> cpus = cpuOrder(config.pinMode);
 
-        while (start > effectiveMin && start > 0 && charsScanned < MAX_BACKWARD_SCAN_CHARS)
+        if (!config.jsonOutput)
         {
-            batcher.recordOperation(opCounter);
-            if (opCounter.load(std::memory_order_relaxed) > MAX_TOTAL_OPERATIONS) [[unlikely]]
+            out << "\n"
+                << std::string(100, '=') << "\n";
+            out << "=== COMPREHENSIVE PERFORMANCE BENCHMARK ===\n";
+            out << std::string(100, '=') << "\n";
+            out << "Configuration:\n";
+            if (config.sweep)
+                out << "  Threads: sweep up to " << config.threads << "\n";
+            else
+                out << "  Threads: " << config.threads << "\n";
+            if (config.durationSeconds > 0.0)
+                out << "  Duration per workload: " << config.durationSeconds << " s\n";
+            else
+                out << "  Iterations per thread: " << config.iterations << "\n";
+            out << "  Warmup iterations: " << config.warmupIterations << "\n";
+            out << "  Corpus: " << corpusLabel << "\n";
+            out << "  Test cases: " << corpus.size() << " (" << document.size() << " bytes)\n";
+            if (config.durationSeconds <= 0.0 && !config.sweep)
+                out << "  Total operations per method: "
+                    << (config.threads * config.iterations * corpus.size()) << "\n";
+            out << "  CPU pinning: " << pinModeName(cpus.empty() ? BenchmarkPinMode::NONE : config.pinMode) << "\n";
+            out << "  Service: " << serviceModeName(config.serviceMode) << "\n";
+            out << "  Hardware counters: " << (config.hardwareCounters ? "enabled" : "disabled") << "\n";
+            out << "  Allocation tracking: "
+                << (!config.trackAllocations            ? "disabled"
+                    : AllocationTracker::isAvailable() ? "enabled"
+                                                       : "unavailable (built without allocation hooks)")
+                << "\n";
+            out << "  Binary skipping: " << (config.scanOptions.skipBinary ? "enabled" : "disabled") << "\n";
+            out << "  Strict TLDs: " << (config.scanOptions.strictTld ? "enabled" : "disabled") << "\n\n";
+        }
+
+        std::vector<BenchmarkResult> results;
+        for (BenchmarkWorkload workload : config.workloads)
+        {
+            if (!config.sweep)
             {
-                return {atPos, atPos, false, atPos, false};
+                results.push_back(runWorkload(config, workload, corpus, document, cpus));
+                if (!config.jsonOutput)
+                    printTextResult(out, results.back(), results.size(), config.hardwareCounters);
+                continue;
+            }
+
+            std::vector<BenchmarkResult> curve;
+            for (size_t threads : sweepThreadCounts(config.threads))
+            {
+                BenchmarkConfig point = config;
+                point.threads = threads;
+                curve.push_back(runWorkload(point, workload, corpus, document, cpus));
+            }
+
+            const double singleThread = curve.front().getOpsPerSecond();
+            for (auto &point : curve)
+            {
+                point.speedup = singleThread > 0.0 ? point.getOpsPerSecond() / singleThread : 0.0;
+                point.efficiency = point.speedup / static_cast<double>(point.threads);
+            }
+
+            if (!config.jsonOutput)
+                printScalingCurve(out, curve);
+            results.insert(results.end(), curve.begin(), curve.end());
+        }
+
+        if (config.jsonOutput)
+        {
+            out << "{\"config\":{\"threads\":" << config.threads
+                << ",\"iterations\":" << config.iterations
+                << ",\"duration_seconds\":" << config.durationSeconds
+                << ",\"warmup_iterations\":" << config.warmupIterations
+                << ",\"pinning\":\"" << pinModeName(cpus.empty() ? BenchmarkPinMode::NONE : config.pinMode) << "\""
+                << ",\"service\":\"" << serviceModeName(config.serviceMode) << "\""
+                << ",\"sweep\":" << (config.sweep ? "true" : "false")
+                << ",\"corpus\":\"" << corpusLabel << "\""
+                << ",\"corpus_cases\":" << corpus.size()
+                << ",\"corpus_bytes\":" << document.size()
+                << "},\"results\":[";
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                if (i > 0)
+                    out << ",";
+                printJsonResult(out, results[i]);
             }
+            out << "]}\n";
+        }
+        else
+        {
+            out << std::string(100, '=') << "\n";
+            out << "✓ Performance Benchmark Complete\n";
+            out << std::string(100, '=') << "\n\n";
+        }
+
+        return results;
+    }
+};
+
+// ====================================================================================================
+// SCAN PIPELINE (CLI: reader -> scanner workers -> writer over bounded queues)
+// ====================================================================================================
+
+[[nodiscard]] static std::string jsonEscape(std::string_view text)
+{
+    static constexpr char HEX[] = "0123456789abcdef";
+    std::string escaped;
+    escaped.reserve(text.size() + 2);
+    for (char c : text)
+    {
+        const auto byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (byte < 0x20)
+        {
+            escaped += "\\u00";
+            escaped += HEX[byte >> 4];
+            escaped += HEX[byte & 0xF];
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+// Blocking multi-producer/multi-consumer queue; push() waits while full, pop() returns
+// nullopt once the queue is closed and drained
+template <typename T>
+class BoundedQueue
+{
+private:
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::deque<T> items_;
+    size_t capacity_;
+    bool closed_ = false;
+
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+    void push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this]()
+                      { return items_.size() < capacity_ || closed_; });
+        if (closed_)
+            return;
+        items_.push_back(std::move(item));
+        lock.unlock();
+        notEmpty_.notify_one();
+    }
+
+    [[nodiscard]] std::optional<T> pop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this]()
+                       { return !items_.empty() || closed_; });
+        if (items_.empty())
+            return std::nullopt;
+        T item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        notFull_.notify_one();
+        return item;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+};
+
+enum class Compression
+{
+    NONE,
+    GZIP,
+    ZSTD
+};
+
+// Reads a file or standard input front to back, inflating gzip or zstd data on the fly. The format
+// comes from the first bytes, not the file name. Memory is one input buffer plus the decoder's
+// window, however large the stream. gzip needs a build with -DEMAIL_DETECTOR_WITH_ZLIB -lz,
+// zstd one with -DEMAIL_DETECTOR_WITH_ZSTD -lzstd; compressed input without the matching
+// decoder is an error rather than a scan of compressed bytes.
+class DecompressingReader
+{
+public:
+    static constexpr size_t INPUT_BUFFER_SIZE = 256 * 1024;
+
+private:
+    std::FILE *file_ = nullptr;
+    bool ownsFile_ = false;
+    Compression compression_ = Compression::NONE;
+    std::vector<char> input_;
+    size_t inputPos_ = 0;
+    size_t inputEnd_ = 0;
+    bool inputEof_ = false;
+    bool finished_ = false;
+    // A gzip member or zstd frame has been started and not yet completed
+    bool midFrame_ = false;
+    std::string error_;
+#ifdef EMAIL_DETECTOR_WITH_ZLIB
+    z_stream zlib_{};
+    bool zlibReady_ = false;
+#endif
+#ifdef EMAIL_DETECTOR_WITH_ZSTD
+    ZSTD_DStream *zstd_ = nullptr;
+#endif
+
+    void fillInput()
+    {
+        if (inputPos_ < inputEnd_ || inputEof_)
+            return;
+
+        inputPos_ = 0;
+        inputEnd_ = std::fread(input_.data(), 1, input_.size(), file_);
+        if (inputEnd_ == 0)
+        {
+            inputEof_ = true;
+            if (std::ferror(file_))
+                error_ = std::strerror(errno);
+        }
+    }
+
+    void fail(std::string message)
+    {
+        if (error_.empty())
+            error_ = std::move(message);
+        finished_ = true;
+    }
 
-            PRODUCTION_CHECK_BOUNDARIES(start > 0, "findEmailBoundaries backward scan start > 0", atPos);
-            unsigned char prevChar = static_cast<unsigned char>(data[start - 1]);
+    [[nodiscard]] size_t readPlain(char *out, size_t size)
+    {
+        size_t produced = std::min(size, inputEnd_ - inputPos_);
+        std::memcpy(out, input_.data() + inputPos_, produced);
+        inputPos_ += produced;
 
-            if (prevChar == '@')
+        if (produced < size && !inputEof_)
+        {
+            produced += std::fread(out + produced, 1, size - produced, file_);
+            if (std::ferror(file_))
+                fail(std::strerror(errno));
+        }
+        if (produced == 0)
+            finished_ = true;
+        return produced;
+    }
+
+#ifdef EMAIL_DETECTOR_WITH_ZLIB
+    [[nodiscard]] size_t readGzip(char *out, size_t size)
+    {
+        size_t produced = 0;
+        while (produced < size && !finished_)
+        {
+            fillInput();
+            if (inputPos_ == inputEnd_)
             {
+                if (midFrame_)
+                    fail("truncated gzip stream");
+                finished_ = true;
                 break;
             }
 
-            if (prevChar == '.' && start > 1 && start > effectiveMin + 1)
+            // Concatenated members (pigz, appended logs) are one stream; trailing padding after a
+            // member is ignored like gzip does
+            if (!midFrame_)
             {
-                if (data[start - 2] == '.')
+                if (static_cast<unsigned char>(input_[inputPos_]) != 0x1f)
                 {
-                    hitInvalidChar = true;
-                    invalidCharPos = start - 1;
+                    finished_ = true;
                     break;
                 }
+                midFrame_ = true;
             }
 
-            if (CharacterClassifier::isInvalidLocalChar(prevChar))
+            zlib_.next_in = reinterpret_cast<Bytef *>(input_.data() + inputPos_);
+            zlib_.avail_in = static_cast<uInt>(inputEnd_ - inputPos_);
+            const size_t room = std::min<size_t>(size - produced, UINT_MAX);
+            zlib_.next_out = reinterpret_cast<Bytef *>(out + produced);
+            zlib_.avail_out = static_cast<uInt>(room);
+
+            const int status = inflate(&zlib_, Z_NO_FLUSH);
+            inputPos_ = inputEnd_ - zlib_.avail_in;
+            produced += room - zlib_.avail_out;
+
+            if (status == Z_STREAM_END)
             {
-                if (prevChar == '@' && start > 1 && start > effectiveMin + 1)
-                {
-                    size_t lookback = start - 2;
-                    size_t validStart = start - 1;
-                    bool foundValid = false;
-                    const size_t lookbackLimit = effectiveMin;
-                    size_t lookbackIterations = 0;
-                    static constexpr size_t MAX_LOOKBACK_ITERATIONS = 100;
+                midFrame_ = false;
+                inflateReset(&zlib_);
+            }
+            else if (status != Z_OK && status != Z_BUF_ERROR)
+            {
+                fail(zlib_.msg != nullptr ? zlib_.msg : "invalid gzip data");
+            }
+        }
+        return produced;
+    }
+#endif
 
-                    while (lookback >= lookbackLimit && lookback < atPos &&
-                           lookback < len && lookbackIterations++ < MAX_LOOKBACK_ITERATIONS)
-                    {
-                        PRODUCTION_CHECK_BOUNDARIES(lookback < len, "findEmailBoundaries lookback", atPos);
+#ifdef EMAIL_DETECTOR_WITH_ZSTD
+    [[nodiscard]] size_t readZstd(char *out, size_t size)
+    {
+        size_t produced = 0;
+        while (produced < size && !finished_)
+        {
+            fillInput();
+            if (inputPos_ == inputEnd_)
+            {
+                if (midFrame_)
+                    fail("truncated zstd stream");
+                finished_ = true;
+                break;
+            }
 
-                        batcher.recordOperation(opCounter);
-                        if (opCounter.load(std::memory_order_relaxed) > MAX_TOTAL_OPERATIONS) [[unlikely]]
-                        {
-                            return {atPos, atPos, false, atPos, false};
-                        }
+            ZSTD_inBuffer in{input_.data(), inputEnd_, inputPos_};
+            ZSTD_outBuffer outBuffer{out + produced, size - produced, 0};
+            const size_t status = ZSTD_decompressStream(zstd_, &outBuffer, &in);
+            inputPos_ = in.pos;
+            produced += outBuffer.pos;
 
-                        unsigned char c = static_cast<unsigned char>(data[lookback]);
-                        if (CharacterClassifier::isAtext(c) && c != '.')
-                        {
-                            foundValid = true;
-                            validStart = lookback;
-                            if (lookback == lookbackLimit || lookback == 0)
-                                break;
-                            --lookback;
-                            continue;
-                        }
-                        break;
-                    }
+            if (ZSTD_isError(status))
+                fail(ZSTD_getErrorName(status));
+            else
+                midFrame_ = status != 0;
+        }
+        return produced;
+    }
+#endif
 
-                    if (foundValid)
-                    {
-                        start = validStart;
-                        ++charsScanned;
-                        continue;
-                    }
-                }
+public:
+    [[nodiscard]] static Compression detect(const char *bytes, size_t size) noexcept
+    {
+        const auto *u = reinterpret_cast<const unsigned char *>(bytes);
+        if (size >= 2 && u[0] == 0x1f && u[1] == 0x8b)
+            return Compression::GZIP;
+        if (size >= 4 && u[0] == 0x28 && u[1] == 0xb5 && u[2] == 0x2f && u[3] == 0xfd)
+            return Compression::ZSTD;
+        return Compression::NONE;
+    }
 
-                hitInvalidChar = true;
-                invalidCharPos = start;
-                break;
-            }
+    // Names that mark a file as compressed, so it is read as one stream rather than in chunks
+    [[nodiscard]] static bool hasCompressedExtension(std::string_view path) noexcept
+    {
+        auto endsWith = [path](std::string_view suffix)
+        {
+            return path.size() >= suffix.size() && path.substr(path.size() - suffix.size()) == suffix;
+        };
+        return endsWith(".gz") || endsWith(".tgz") || endsWith(".zst") || endsWith(".zstd");
+    }
 
-            if (CharacterClassifier::isQuoteChar(prevChar))
+    // "-" is standard input. With decompress false every input is read as is.
+    DecompressingReader(const std::string &path, bool decompress) : input_(INPUT_BUFFER_SIZE)
+    {
+        if (path == "-")
+        {
+            file_ = stdin;
+        }
+        else
+        {
+            file_ = std::fopen(path.c_str(), "rb");
+            ownsFile_ = file_ != nullptr;
+            if (file_ == nullptr)
             {
-                bool hasMatchingQuote = false;
+                fail(std::strerror(errno));
+                return;
+            }
+        }
 
-                if (start > 1 && start > effectiveMin + 1)
-                {
-                    if (data[start - 2] == prevChar)
-                    {
-                        --start;
-                        ++charsScanned;
-                        continue;
-                    }
-                }
+        fillInput();
+        if (decompress)
+            compression_ = detect(input_.data() + inputPos_, inputEnd_ - inputPos_);
 
-                if (end < len && data[end] == prevChar)
-                {
-                    if (end + 1 < len && data[end + 1] == prevChar)
-                    {
-                        --start;
-                        ++charsScanned;
-                        continue;
-                    }
-                    hasMatchingQuote = true;
-                }
+        if (compression_ == Compression::GZIP)
+        {
+#ifdef EMAIL_DETECTOR_WITH_ZLIB
+            // 16 + MAX_WBITS: gzip wrapper only
+            zlibReady_ = inflateInit2(&zlib_, 16 + MAX_WBITS) == Z_OK;
+            if (!zlibReady_)
+                fail("cannot initialise zlib");
+#else
+            fail("gzip input needs a build with -DEMAIL_DETECTOR_WITH_ZLIB -lz");
+#endif
+        }
+        else if (compression_ == Compression::ZSTD)
+        {
+#ifdef EMAIL_DETECTOR_WITH_ZSTD
+            zstd_ = ZSTD_createDStream();
+            if (zstd_ == nullptr || ZSTD_isError(ZSTD_initDStream(zstd_)))
+                fail("cannot initialise zstd");
+#else
+            fail("zstd input needs a build with -DEMAIL_DETECTOR_WITH_ZSTD -lzstd");
+#endif
+        }
+    }
 
-                if (hasMatchingQuote)
-                {
-                    break;
-                }
-                else
-                {
-                    if (start > 1 && start > effectiveMin + 1)
-                    {
-                        unsigned char prevPrevChar = static_cast<unsigned char>(data[start - 2]);
-                        if (prevPrevChar == '=' || prevPrevChar == ':' ||
-                            CharacterClassifier::isScanBoundary(prevPrevChar) ||
-                            CharacterClassifier::isQuoteChar(prevPrevChar))
-                        {
-                            --start;
-                            ++charsScanned;
-                            continue;
-                        }
-                    }
-                    else if (start == effectiveMin + 1)
-                    {
-                        --start;
-                        ++charsScanned;
-                        break;
-                    }
-                    --start;
-                    ++charsScanned;
-                    continue;
-                }
+    ~DecompressingReader()
+    {
+#ifdef EMAIL_DETECTOR_WITH_ZLIB
+        if (zlibReady_)
+            inflateEnd(&zlib_);
+#endif
+#ifdef EMAIL_DETECTOR_WITH_ZSTD
+        ZSTD_freeDStream(zstd_);
+#endif
+        if (ownsFile_)
+            std::fclose(file_);
+    }
+
+    DecompressingReader(const DecompressingReader &) = delete;
+    DecompressingReader &operator=(const DecompressingReader &) = delete;
+
+    // Fills out with up to size uncompressed bytes; 0 means end of stream or an error (see error())
+    [[nodiscard]] size_t read(char *out, size_t size)
+    {
+        if (finished_ || size == 0)
+            return 0;
+
+        switch (compression_)
+        {
+#ifdef EMAIL_DETECTOR_WITH_ZLIB
+        case Compression::GZIP:
+            return readGzip(out, size);
+#endif
+#ifdef EMAIL_DETECTOR_WITH_ZSTD
+        case Compression::ZSTD:
+            return readZstd(out, size);
+#endif
+        default:
+            return readPlain(out, size);
+        }
+    }
+
+    [[nodiscard]] Compression compression() const noexcept
+    {
+        return compression_;
+    }
+
+    [[nodiscard]] const std::string &error() const noexcept
+    {
+        return error_;
+    }
+};
+
+enum class ScanIoBackend
+{
+    AUTO,
+    URING,
+    READ
+};
+
+// --ignore-domains / --report-domains: comma-separated patterns, or @FILE with one per line.
+// Rules accumulate in one set shared by copies of the config.
+static void addDomainRules(std::shared_ptr<DomainRuleSet> &rules, ScanOptions &options, std::string_view list,
+                           DomainAction action)
+{
+    if (!rules)
+        rules = std::make_shared<DomainRuleSet>();
+    options.domainRules = rules.get();
+
+    if (!list.empty() && list.front() == '@')
+    {
+        const std::string path(list.substr(1));
+        std::ifstream file(path);
+        if (!file)
+            throw std::runtime_error("cannot read domain rules " + path);
+        rules->addRules(file, action);
+        return;
+    }
+
+    while (!list.empty())
+    {
+        const size_t comma = list.find(',');
+        rules->addRule(list.substr(0, comma), action);
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+    }
+}
+
+struct ScanConfig
+{
+    // Paths to scan; "-" is standard input. Directories are scanned recursively.
+    std::vector<std::string> inputs;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunkSize = 1024 * 1024;
+    // Per-file match counts instead of one JSON line per match
+    bool countOnly = false;
+    // How small files are read: io_uring when the kernel allows it, or plain reads
+    ScanIoBackend io = ScanIoBackend::AUTO;
+    // gzip/zstd inputs are decompressed while scanning; offsets are in uncompressed bytes
+    bool decompress = true;
+    ScanOptions scanOptions;
+    // Index behind scanOptions.knownEmails, shared by copies of the config
+    std::shared_ptr<const KnownEmailFilter> knownEmails;
+    // Rules behind scanOptions.domainRules, shared likewise
+    std::shared_ptr<DomainRuleSet> domainRules;
+    // Cache behind scanOptions.domainCache for --domain-cache, shared by every pool thread
+    std::shared_ptr<DomainValidationCache> domainCache;
+
+    static ScanConfig parse(const std::vector<std::string_view> &args)
+    {
+        ScanConfig config;
+        bool endOfOptions = false;
+
+        for (std::string_view arg : args)
+        {
+            if (endOfOptions || arg == "-" || arg.substr(0, 2) != "--")
+            {
+                config.inputs.emplace_back(arg);
+                continue;
+            }
+            if (arg == "--")
+            {
+                endOfOptions = true;
+                continue;
             }
 
-            if (prevChar == '.')
+            const size_t eq = arg.find('=');
+            const std::string_view name = arg.substr(0, eq);
+            const std::string_view value = eq == std::string_view::npos ? std::string_view() : arg.substr(eq + 1);
+            const bool hasValue = eq != std::string_view::npos;
+
+            if (name == "--count" && !hasValue)
             {
-                --start;
+                config.countOnly = true;
             }
-            else if (CharacterClassifier::isAtext(prevChar))
+            else if (name == "--no-decompress" && !hasValue)
             {
-                --start;
+                config.decompress = false;
+            }
+            else if (name == "--skip-binary" && !hasValue)
+            {
+                config.scanOptions.skipBinary = true;
+            }
+            else if (name == "--strict-tld" && !hasValue)
+            {
+                config.scanOptions.strictTld = true;
+            }
+            else if (name == "--min-run" && hasValue)
+            {
+                config.scanOptions.minPrintableRun = static_cast<size_t>(BenchmarkConfig::parseUnsigned(value, name));
+                if (config.scanOptions.minPrintableRun == 0)
+                    throw std::invalid_argument("--min-run must be at least 1");
+            }
+            else if (name == "--known" && hasValue)
+            {
+                config.knownEmails = KnownEmailFilter::load(std::string(value));
+                config.scanOptions.knownEmails = config.knownEmails.get();
+            }
+            else if (name == "--ignore-domains" && hasValue)
+            {
+                addDomainRules(config.domainRules, config.scanOptions, value, DomainAction::IGNORE);
+            }
+            else if (name == "--report-domains" && hasValue)
+            {
+                addDomainRules(config.domainRules, config.scanOptions, value, DomainAction::REPORT);
+            }
+            else if (name == "--domain-cache" && hasValue)
+            {
+                config.domainCache = std::make_shared<DomainValidationCache>(
+                    static_cast<size_t>(BenchmarkConfig::parseSize(value, name)));
+                config.scanOptions.domainCache = config.domainCache.get();
+            }
+            else if (name == "--threads" && hasValue)
+            {
+                config.threads = static_cast<size_t>(BenchmarkConfig::parseUnsigned(value, name));
+                if (config.threads == 0)
+                    throw std::invalid_argument("--threads must be at least 1");
+            }
+            else if (name == "--io" && hasValue)
+            {
+                if (value == "auto")
+                    config.io = ScanIoBackend::AUTO;
+                else if (value == "uring")
+                    config.io = ScanIoBackend::URING;
+                else if (value == "read")
+                    config.io = ScanIoBackend::READ;
+                else
+                    throw std::invalid_argument("--io must be auto, uring or read");
+            }
+            else if (name == "--chunk-size" && hasValue)
+            {
+                config.chunkSize = static_cast<size_t>(BenchmarkConfig::parseSize(value, name));
+                if (config.chunkSize < 4096)
+                    throw std::invalid_argument("--chunk-size must be at least 4K");
             }
             else
             {
-                break;
+                throw std::invalid_argument("unknown scan option '" + std::string(arg) + "'");
             }
-
-            ++charsScanned;
         }
 
-        if (hitInvalidChar)
-        {
-            size_t recoveryPos = findFirstAlnum(data, len, std::max(invalidCharPos, effectiveMin), atPos);
+        if (config.inputs.empty())
+            config.inputs.emplace_back("-");
+        return config;
+    }
 
-            if (recoveryPos != SIZE_MAX)
+    static void printUsage(std::ostream &out)
+    {
+        out << "Scan options:\n"
+            << "  --threads=N         work-stealing pool threads (default: hardware concurrency)\n"
+            << "  --chunk-size=SIZE   larger files are split into tasks of SIZE bytes, smaller ones are\n"
+            << "                      batched into tasks of about SIZE bytes (default: 1M)\n"
+            << "  --count             one {\"file\",\"count\"} line per input instead of every match\n"
+            << "  --io=MODE           auto, uring or read: small files are opened, read and closed through\n"
+            << "                      io_uring with many reads in flight, or with plain reads (default: auto,\n"
+            << "                      io_uring where the kernel supports it)\n"
+            << "  --no-decompress     scan .gz/.zst files and compressed stdin as raw bytes\n"
+            << "  --skip-binary       ignore '@'s in 4K blocks that look binary, except inside printable\n"
+            << "                      runs of at least --min-run bytes (default: 6)\n"
+            << "  --strict-tld        drop addresses whose TLD is not in the root zone (user@host.local1)\n"
+            << "  --known=INDEX       report only addresses listed in INDEX (see index build)\n"
+            << "  --ignore-domains=LIST\n"
+            << "                      skip addresses in these domains and their subdomains; LIST is\n"
+            << "                      comma-separated (ourcompany.com,*.internal.net,partner.*) or @FILE\n"
+            << "  --report-domains=LIST\n"
+            << "                      report only addresses in these domains; the most specific rule wins\n"
+            << "  --domain-cache=N    remember the validation result of about N recent domains and print\n"
+            << "                      the hit rate to stderr at the end (same matches, less work)\n"
+            << "  FILE... | -         files or directories (scanned recursively, symlinked directories\n"
+            << "                      are skipped); - or no argument reads standard input\n"
+            << "Output is JSON Lines: {\"file\":...,\"offset\":...,\"email\":...} with byte offsets into\n"
+            << "each input (uncompressed bytes for gzip/zstd), in argument order and sorted by path\n"
+            << "within a directory, whatever the thread count. Exit status is 1 if any input could\n"
+            << "not be read.\n";
+    }
+};
+
+// Fixed set of workers, each with its own deque: a worker pushes and pops at the back of its own
+// deque and steals from the front of the others when it runs dry, so tasks spawned by a task
+// (subdirectories of a directory) stay local while idle workers take the oldest, largest work.
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> nextWorker_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex idleMutex_;
+    std::condition_variable idle_;
+    std::condition_variable done_;
+
+    static inline thread_local const WorkStealingPool *currentPool_ = nullptr;
+    static inline thread_local size_t currentIndex_ = 0;
+
+    [[nodiscard]] bool tryRunOne(size_t self)
+    {
+        Task task;
+        {
+            Worker &own = *workers_[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty())
             {
-                start = recoveryPos;
-                didRecovery = true;
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
             }
-            else
+        }
+
+        for (size_t i = 1; !task && i < workers_.size(); ++i)
+        {
+            Worker &victim = *workers_[(self + i) % workers_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
             {
-                recoveryPos = findFirstAtext(data, len, std::max(invalidCharPos, effectiveMin), atPos);
-                if (recoveryPos != SIZE_MAX)
-                {
-                    start = recoveryPos;
-                    didRecovery = true;
-                }
-                else
-                {
-                    size_t skip = std::min(invalidCharPos + 1, len);
-                    return {atPos, atPos, false, skip, false};
-                }
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
             }
         }
 
-        while (start < atPos && data[start] == '.')
+        if (!task)
+            return false;
+
+        queued_.fetch_sub(1, std::memory_order_acq_rel);
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            ThreadSafeErrorCounter::recordError();
+        }
+
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
         {
-            PRODUCTION_CHECK_BOUNDARIES(start < len, "findEmailBoundaries leading dot removal", atPos);
-            ++start;
+            std::lock_guard<std::mutex> lock(idleMutex_);
+            done_.notify_all();
         }
+        return true;
+    }
 
-        if (start < atPos && start > effectiveMin && start > 0)
+    void workerLoop(size_t index)
+    {
+        currentPool_ = this;
+        currentIndex_ = index;
+
+        while (!stop_.load(std::memory_order_acquire))
         {
-            unsigned char charBeforeStart = static_cast<unsigned char>(data[start - 1]);
-            if (CharacterClassifier::isInvalidLocalChar(charBeforeStart))
-            {
-                size_t firstAlnum = findFirstAlnum(data, len, start, atPos);
-                if (firstAlnum != SIZE_MAX)
-                {
-                    start = firstAlnum;
-                }
-            }
+            if (tryRunOne(index))
+                continue;
+
+            std::unique_lock<std::mutex> lock(idleMutex_);
+            idle_.wait(lock, [this]()
+                       { return queued_.load(std::memory_order_acquire) > 0 || stop_.load(std::memory_order_acquire); });
         }
+    }
 
-        if (UNLIKELY(start >= atPos))
+public:
+    explicit WorkStealingPool(size_t threads)
+    {
+        const size_t count = std::max<size_t>(threads, 1);
+        workers_.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            workers_.push_back(std::make_unique<Worker>());
+
+        threads_.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            threads_.emplace_back([this, i]()
+                                  { workerLoop(i); });
+    }
+
+    ~WorkStealingPool()
+    {
         {
-            size_t skip = std::min(atPos + 1, len);
-            return {atPos, atPos, false, skip, false};
+            std::lock_guard<std::mutex> lock(idleMutex_);
+            stop_.store(true, std::memory_order_release);
         }
+        idle_.notify_all();
+        for (auto &thread : threads_)
+            thread.join();
+    }
 
-        static constexpr size_t MAX_LOCAL_PART = 64;
-        if ((atPos - start) > MAX_LOCAL_PART)
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    // From a pool worker the task goes to that worker's deque, otherwise round-robin
+    void submit(Task task)
+    {
+        const size_t index = currentPool_ == this
+                                 ? currentIndex_
+                                 : nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+
+        // Counted before the task is visible: a thief that takes it at once then never decrements
+        // below zero
+        pending_.fetch_add(1, std::memory_order_acq_rel);
+        queued_.fetch_add(1, std::memory_order_acq_rel);
         {
-            didTrim = true;
-            start = atPos - MAX_LOCAL_PART;
+            Worker &worker = *workers_[index];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.tasks.push_back(std::move(task));
+        }
 
-            while (start < atPos && data[start] == '.')
-            {
-                PRODUCTION_CHECK_BOUNDARIES(start < len, "findEmailBoundaries trimming dot removal", atPos);
-                ++start;
-            }
+        std::lock_guard<std::mutex> lock(idleMutex_);
+        idle_.notify_one();
+    }
 
-            if (start > effectiveMin && start > 0)
-            {
-                unsigned char prevChar = static_cast<unsigned char>(data[start - 1]);
+    // Blocks until every submitted task, including tasks submitted by tasks, has finished
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(idleMutex_);
+        done_.wait(lock, [this]()
+                   { return pending_.load(std::memory_order_acquire) == 0; });
+    }
 
-                if (!CharacterClassifier::isScanBoundary(prevChar) &&
-                    !CharacterClassifier::isInvalidLocalChar(prevChar) &&
-                    prevChar != '@' && prevChar != '.' && prevChar != '=' &&
-                    prevChar != '\'' && prevChar != '`' && prevChar != '"' &&
-                    prevChar != '/')
-                {
-                    size_t firstValid = findFirstAlnum(data, len, start, atPos);
-                    if (firstValid != SIZE_MAX && firstValid < atPos)
-                    {
-                        start = firstValid;
-                    }
-                    else
-                    {
-                        firstValid = findFirstAtext(data, len, start, atPos);
-                        if (firstValid != SIZE_MAX && firstValid < atPos)
-                        {
-                            start = firstValid;
-                        }
-                    }
-                }
-            }
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return workers_.size();
+    }
+};
 
-            if ((atPos - start) > MAX_LOCAL_PART)
-            {
-                start = atPos - MAX_LOCAL_PART;
-            }
+// Reads many small files with a deep queue in flight: each file is opened, read into one of
+// QUEUE_DEPTH registered buffers and closed through the ring, and the filled buffer is handed to
+// the caller while the other reads proceed. isAvailable() is false when the kernel lacks io_uring,
+// a needed opcode or buffer registration (seccomp, old kernel, memlock limit); callers then use
+// the plain read path.
+class IoUringReader
+{
+public:
+    static constexpr unsigned QUEUE_DEPTH = 32;
+    // Files larger than this are left to the read path
+    static constexpr size_t BUFFER_SIZE = 128 * 1024;
 
-            while (start < atPos && data[start] == '.')
-            {
-                ++start;
-            }
+#ifdef EMAIL_DETECTOR_HAS_IO_URING
+private:
+    enum Phase : uint64_t
+    {
+        OPEN = 0,
+        READ = 1,
+        CLOSE = 2
+    };
+
+    struct Slot
+    {
+        size_t file = 0;
+        int fd = -1;
+        size_t filled = 0;
+    };
+
+    int ringFd_ = -1;
+    void *sqRing_ = MAP_FAILED;
+    void *cqRing_ = MAP_FAILED;
+    size_t sqRingSize_ = 0;
+    size_t cqRingSize_ = 0;
+    io_uring_sqe *sqes_ = nullptr;
+    size_t sqesSize_ = 0;
+    unsigned *sqHead_ = nullptr;
+    unsigned *sqTail_ = nullptr;
+    unsigned *sqMask_ = nullptr;
+    unsigned *sqArray_ = nullptr;
+    unsigned *cqHead_ = nullptr;
+    unsigned *cqTail_ = nullptr;
+    unsigned *cqMask_ = nullptr;
+    io_uring_cqe *cqes_ = nullptr;
+    char *buffers_ = nullptr;
+    unsigned toSubmit_ = 0;
+    // Entries published to the kernel whose completions have not been reaped
+    unsigned inFlight_ = 0;
+    bool available_ = false;
+    bool failNextWait_ = false;
+
+    [[nodiscard]] bool setup() noexcept
+    {
+        io_uring_params params{};
+        // Opens, reads and closes can all be queued at once
+        ringFd_ = static_cast<int>(syscall(__NR_io_uring_setup, QUEUE_DEPTH * 2, &params));
+        if (ringFd_ < 0)
+            return false;
+
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap)
+            sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+        sqRing_ = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_,
+                       IORING_OFF_SQ_RING);
+        if (sqRing_ == MAP_FAILED)
+            return false;
+        cqRing_ = singleMmap ? sqRing_
+                             : mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                    ringFd_, IORING_OFF_CQ_RING);
+        if (cqRing_ == MAP_FAILED)
+            return false;
+
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_,
+                          IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+            return false;
+        sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+        auto *sq = static_cast<char *>(sqRing_);
+        auto *cq = static_cast<char *>(cqRing_);
+        sqHead_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sqMask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        cqHead_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cqMask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+        if (!supportsOpcodes())
+            return false;
+
+        buffers_ = static_cast<char *>(std::aligned_alloc(4096, QUEUE_DEPTH * BUFFER_SIZE));
+        if (buffers_ == nullptr)
+            return false;
+
+        std::array<iovec, QUEUE_DEPTH> iovecs{};
+        for (unsigned i = 0; i < QUEUE_DEPTH; ++i)
+            iovecs[i] = {buffers_ + i * BUFFER_SIZE, BUFFER_SIZE};
+        return syscall(__NR_io_uring_register, ringFd_, IORING_REGISTER_BUFFERS, iovecs.data(), QUEUE_DEPTH) == 0;
+    }
+
+    [[nodiscard]] bool supportsOpcodes() const noexcept
+    {
+        static constexpr unsigned PROBE_OPS = 64;
+        alignas(io_uring_probe) std::array<char, sizeof(io_uring_probe) + PROBE_OPS * sizeof(io_uring_probe_op)> storage{};
+        auto *probe = reinterpret_cast<io_uring_probe *>(storage.data());
+        if (syscall(__NR_io_uring_register, ringFd_, IORING_REGISTER_PROBE, probe, PROBE_OPS) != 0)
+            return false;
+
+        for (unsigned op : {unsigned(IORING_OP_OPENAT), unsigned(IORING_OP_READ_FIXED), unsigned(IORING_OP_CLOSE)})
+        {
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+                return false;
         }
+        return true;
+    }
 
-        bool validBoundaries = true;
+    [[nodiscard]] io_uring_sqe &nextSqe() noexcept
+    {
+        const unsigned tail = *sqTail_ + toSubmit_;
+        const unsigned index = tail & *sqMask_;
+        io_uring_sqe &sqe = sqes_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqArray_[index] = index;
+        ++toSubmit_;
+        return sqe;
+    }
 
-        if (start > effectiveMin && start > 0)
+    void queueOpen(unsigned slot, const char *path) noexcept
+    {
+        io_uring_sqe &sqe = nextSqe();
+        sqe.opcode = IORING_OP_OPENAT;
+        sqe.fd = AT_FDCWD;
+        sqe.addr = reinterpret_cast<uint64_t>(path);
+        sqe.open_flags = O_RDONLY | O_CLOEXEC;
+        sqe.user_data = (uint64_t{slot} << 2) | OPEN;
+    }
+
+    void queueRead(unsigned slot, const Slot &state) noexcept
+    {
+        io_uring_sqe &sqe = nextSqe();
+        sqe.opcode = IORING_OP_READ_FIXED;
+        sqe.fd = state.fd;
+        sqe.addr = reinterpret_cast<uint64_t>(buffers_ + slot * BUFFER_SIZE + state.filled);
+        sqe.len = static_cast<uint32_t>(BUFFER_SIZE - state.filled);
+        sqe.off = state.filled;
+        sqe.buf_index = static_cast<uint16_t>(slot);
+        sqe.user_data = (uint64_t{slot} << 2) | READ;
+    }
+
+    void queueClose(int fd) noexcept
+    {
+        io_uring_sqe &sqe = nextSqe();
+        sqe.opcode = IORING_OP_CLOSE;
+        sqe.fd = fd;
+        sqe.user_data = CLOSE;
+    }
+
+    // Publishes queued entries and waits for at least one completion
+    [[nodiscard]] bool submitAndWait() noexcept
+    {
+        __atomic_store_n(sqTail_, *sqTail_ + toSubmit_, __ATOMIC_RELEASE);
+        const unsigned count = toSubmit_;
+        inFlight_ += toSubmit_;
+        toSubmit_ = 0;
+
+        if (failNextWait_)
         {
-            PRODUCTION_CHECK_BOUNDARIES(start - 1 < len, "findEmailBoundaries boundary validation", atPos);
-            unsigned char prevChar = static_cast<unsigned char>(data[start - 1]);
+            // Submitted but not waited for, as when the wait itself fails
+            failNextWait_ = false;
+            (void)syscall(__NR_io_uring_enter, ringFd_, count, 0, 0, nullptr, 0);
+            errno = EIO;
+            return false;
+        }
 
-            if (didTrim)
-            {
-                validBoundaries = true;
-            }
-            else if (didRecovery)
-            {
-                validBoundaries = !CharacterClassifier::isAlphaNum(prevChar);
-            }
-            else if (CharacterClassifier::isInvalidLocalChar(prevChar))
-            {
-                validBoundaries = true;
-            }
-            else if (!CharacterClassifier::isScanBoundary(prevChar) &&
-                     prevChar != '@' && prevChar != '.' && prevChar != '=' &&
-                     prevChar != '\'' && prevChar != '`' && prevChar != '"' &&
-                     prevChar != '/')
-            {
-                validBoundaries = false;
-            }
+        for (;;)
+        {
+            const long result = syscall(__NR_io_uring_enter, ringFd_, count, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (result >= 0)
+                return true;
+            if (errno != EINTR)
+                return false;
+        }
+    }
 
-            if (!didTrim && CharacterClassifier::isQuoteChar(prevChar) && start > effectiveMin + 1 && start >= 2)
-            {
-                unsigned char prevPrevChar = static_cast<unsigned char>(data[start - 2]);
-                if (CharacterClassifier::isScanBoundary(prevPrevChar) ||
-                    prevPrevChar == '=' || prevPrevChar == ':' ||
-                    CharacterClassifier::isQuoteChar(prevPrevChar))
-                {
-                    validBoundaries = true;
-                }
-            }
+    // After a failed io_uring_enter: waits for every entry already published to complete, since
+    // reads may still be filling buffers_ and opens still return descriptors, closing each
+    // descriptor an open returns and then those the slots hold. The ring is then torn down, so
+    // later batches use read(). If the kernel stops answering with entries still in flight, the
+    // ring and buffers are left mapped rather than freed under a pending read.
+    void abandon(std::array<Slot, QUEUE_DEPTH> &slots) noexcept
+    {
+        static constexpr unsigned MAX_FAILED_WAITS = 8;
 
-            if (!didTrim && prevChar == '/' && start > effectiveMin + 1 && start >= 2)
+        unsigned unsubmitted = *sqTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+        unsigned failedWaits = 0;
+        while (inFlight_ > 0)
+        {
+            unsigned head = *cqHead_;
+            const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head)
             {
-                if (data[start - 2] == '/')
-                {
-                    validBoundaries = true;
-                }
+                const io_uring_cqe &cqe = cqes_[head & *cqMask_];
+                if ((cqe.user_data & 3) == OPEN && cqe.res >= 0)
+                    close(cqe.res);
+                --inFlight_;
             }
+            __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+
+            if (inFlight_ == 0)
+                break;
+            if (syscall(__NR_io_uring_enter, ringFd_, unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0) >= 0)
+                unsubmitted = 0;
+            else if (errno != EINTR && ++failedWaits >= MAX_FAILED_WAITS)
+                break;
         }
 
-        if (end < len && validBoundaries && !didTrimDomain)
+        for (Slot &state : slots)
         {
-            PRODUCTION_CHECK_BOUNDARIES(end < len, "findEmailBoundaries right boundary", atPos);
-            unsigned char nextChar = static_cast<unsigned char>(data[end]);
-            if (!CharacterClassifier::isScanRightBoundary(nextChar) &&
-                nextChar != '\'' && nextChar != '`' && nextChar != '"' &&
-                nextChar != '@' && nextChar != '\\' && !CharacterClassifier::isAtext(nextChar))
-            {
-                validBoundaries = false;
-            }
+            if (state.fd >= 0)
+                close(state.fd);
+            state.fd = -1;
         }
 
-        return {start, end, validBoundaries, 0, didTrimDomain};
+        available_ = false;
+        if (inFlight_ == 0)
+            release();
+    }
+
+    void release() noexcept
+    {
+        if (sqes_ != nullptr)
+            munmap(sqes_, sqesSize_);
+        if (cqRing_ != MAP_FAILED && cqRing_ != sqRing_)
+            munmap(cqRing_, cqRingSize_);
+        if (sqRing_ != MAP_FAILED)
+            munmap(sqRing_, sqRingSize_);
+        if (ringFd_ >= 0)
+            close(ringFd_);
+        std::free(buffers_);
+        sqes_ = nullptr;
+        sqRing_ = cqRing_ = MAP_FAILED;
+        ringFd_ = -1;
+        buffers_ = nullptr;
     }
 
 public:
-    [[nodiscard]] static bool contains(std::string_view text) noexcept
+    IoUringReader() noexcept
     {
-        try
-        {
-            const size_t len = text.length();
+        available_ = setup();
+        if (!available_)
+            release();
+    }
 
-            if (UNLIKELY(len > MAX_INPUT_SIZE || len < 5))
-                return false;
+    ~IoUringReader()
+    {
+        // An undrained ring may still write into buffers_, so it is left mapped
+        if (inFlight_ == 0)
+            release();
+    }
 
-            if (UNLIKELY(text.data() == nullptr && len > 0))
-                return false;
+    IoUringReader(const IoUringReader &) = delete;
+    IoUringReader &operator=(const IoUringReader &) = delete;
+
+    [[nodiscard]] bool isAvailable() const noexcept
+    {
+        return available_;
+    }
 
-            const char *data = text.data();
-            size_t pos = 0;
-            size_t minScannedIndex = 0;
-            size_t lastConsumedEnd = 0;
+    // For tests: the next wait for completions fails after its entries have been submitted
+    void failNextWait() noexcept
+    {
+        failNextWait_ = true;
+    }
+
+    // Reads every path whole, up to BUFFER_SIZE bytes, and calls onFile(index, data, error) as each
+    // finishes, in completion order. data points into a registered buffer and is only valid during
+    // the call; error is an errno value (0 on success). Returns false if the ring itself failed,
+    // in which case files not yet reported must be read another way; the reader then closes what
+    // it had open and stays unavailable.
+    template <typename OnFile>
+    [[nodiscard]] bool readFiles(const std::vector<const char *> &paths, OnFile &&onFile)
+    {
+        if (!available_)
+            return false;
 
-            std::atomic<size_t> totalOps{0};
-            OperationBatcher batcher;
-            batcher.local_count = 0;
+        std::array<Slot, QUEUE_DEPTH> slots{};
+        std::vector<unsigned> freeSlots;
+        freeSlots.reserve(QUEUE_DEPTH);
+        for (unsigned i = QUEUE_DEPTH; i > 0; --i)
+            freeSlots.push_back(i - 1);
 
-            static constexpr size_t MAX_TOTAL_CHARS_SCANNED = 1'000'000;
-            size_t totalCharsScanned = 0;
+        size_t nextFile = 0;
+        size_t finished = 0;
+        unsigned closesInFlight = 0;
 
-            while (pos < len)
+        while (finished < paths.size() || closesInFlight > 0)
+        {
+            while (nextFile < paths.size() && !freeSlots.empty())
             {
-                if (batcher.checkLimit(totalOps, MAX_TOTAL_OPERATIONS)) [[unlikely]]
-                    break;
+                const unsigned slot = freeSlots.back();
+                freeSlots.pop_back();
+                slots[slot] = Slot{nextFile, -1, 0};
+                queueOpen(slot, paths[nextFile++]);
+            }
 
-                auto atPosOpt = safe_memchr_index(data, pos, len, '@');
-                if (!atPosOpt)
-                    break;
+            if (!submitAndWait())
+            {
+                abandon(slots);
+                return false;
+            }
 
-                size_t atPos = *atPosOpt;
+            unsigned head = *cqHead_;
+            const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head)
+            {
+                const io_uring_cqe &cqe = cqes_[head & *cqMask_];
+                const auto phase = static_cast<Phase>(cqe.user_data & 3);
+                const auto slot = static_cast<unsigned>(cqe.user_data >> 2);
+                const int result = cqe.res;
+                --inFlight_;
 
-                if (UNLIKELY(atPos < 1 || atPos >= len - 3))
+                if (phase == CLOSE)
                 {
-                    pos = atPos + 1;
+                    --closesInFlight;
                     continue;
                 }
 
-                if (atPos < lastConsumedEnd)
+                Slot &state = slots[slot];
+                if (phase == OPEN && result >= 0)
                 {
-                    pos = atPos + 1;
+                    state.fd = result;
+                    queueRead(slot, state);
                     continue;
                 }
 
-                auto boundaries = findEmailBoundaries(text, atPos, minScannedIndex, totalOps, batcher);
-
-                size_t charsScanned = 0;
-                size_t temp = 0;
+                if (phase == READ && result > 0 && state.filled + static_cast<size_t>(result) < BUFFER_SIZE)
+                {
+                    // Short read: keep reading until end of file or a full buffer
+                    state.filled += static_cast<size_t>(result);
+                    queueRead(slot, state);
+                    continue;
+                }
 
-                if (!safe_add(safe_subtract(atPos, boundaries.start),
-                              safe_subtract(boundaries.end, atPos), temp))
-                    break;
+                if (phase == READ && result > 0)
+                    state.filled += static_cast<size_t>(result);
 
-                charsScanned = temp;
+                onFile(state.file, std::string_view(buffers_ + slot * BUFFER_SIZE, state.filled),
+                       result < 0 ? -result : 0);
 
-                if (charsScanned > MAX_BACKTRACK_PER_AT)
+                if (state.fd >= 0)
                 {
-                    pos = atPos + 1;
-                    continue;
+                    queueClose(state.fd);
+                    ++closesInFlight;
+                    state.fd = -1;
                 }
+                freeSlots.push_back(slot);
+                ++finished;
+            }
+            __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+        }
+
+        return true;
+    }
+#else
+public:
+    [[nodiscard]] bool isAvailable() const noexcept
+    {
+        return false;
+    }
+
+    void failNextWait() noexcept
+    {
+    }
+
+    template <typename OnFile>
+    [[nodiscard]] bool readFiles(const std::vector<const char *> &, OnFile &&)
+    {
+        return false;
+    }
+#endif
+};
+
+// Scans files, directory trees and standard input on a work-stealing pool. Directories are
+// crawled in parallel first; the files found are then sorted and planned into numbered tasks:
+// files larger than a chunk become one task per chunk, smaller files are batched into tasks of
+// about one chunk, and stdin and compressed files are read by the planner as a stream of chunks. Each chunk task reads its own byte range, owns [ownBegin, ownEnd) and reads
+// enough context on both sides that matches near a cut are found exactly once. The calling thread
+// writes results in task order, so output does not depend on scheduling.
+class ScanPipeline
+{
+public:
+    static constexpr size_t OVERLAP_BYTES = EmailStreamScanner::CONTEXT_BYTES + EmailStreamScanner::HOLDBACK_BYTES;
+    // Small files share one task until it holds this many files (or a chunk's worth of bytes)
+    static constexpr size_t MAX_BATCH_FILES = 256;
+
+private:
+    struct InputFile
+    {
+        std::string path;
+        uint64_t size = 0;
+        // Read front to back by the planner: standard input and compressed files
+        bool streamed = false;
+    };
+
+    // One file's share of a task: a byte range of a large file, a whole small file, or a piece of stdin
+    struct Segment
+    {
+        size_t input = 0;
+        uint64_t ownBegin = 0;
+        uint64_t ownEnd = 0;
+        bool wholeFile = false;
+        bool lastOfInput = false;
+        // Bytes of a streamed input, already read by the planner; data[0] sits at absolute offset dataOffset
+        std::string data;
+        uint64_t dataOffset = 0;
+    };
+
+    struct SegmentResult
+    {
+        size_t input = 0;
+        bool lastOfInput = false;
+        uint64_t count = 0;
+        std::vector<std::pair<uint64_t, std::string>> matches;
+    };
+
+    struct TaskResult
+    {
+        uint64_t sequence = 0;
+        std::vector<SegmentResult> segments;
+    };
 
-                if (!safe_add(totalCharsScanned, charsScanned, totalCharsScanned))
-                    break;
+    const ScanConfig &config_;
+    std::vector<InputFile> inputs_;
+    bool useUring_ = false;
+    bool failed_ = false;
+    std::mutex mutex_;
+    std::ostream &err_;
 
-                if (totalCharsScanned > MAX_TOTAL_CHARS_SCANNED)
-                    break;
+    void reportError(const std::string &path, const std::string &message)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        failed_ = true;
+        err_ << "scan: " << path << ": " << message << "\n";
+    }
 
-                if (!boundaries.validBoundaries)
-                {
-                    if (boundaries.skipTo > 0)
-                        pos = boundaries.skipTo;
-                    else
-                        pos = atPos + 1;
-                    continue;
-                }
+    [[nodiscard]] bool isStreamed(const std::string &path) const noexcept
+    {
+        return config_.decompress && DecompressingReader::hasCompressedExtension(path);
+    }
 
-                LocalPartValidator::ValidationMode mode = LocalPartValidator::ValidationMode::SCAN;
-                if (boundaries.start < atPos && boundaries.start < len &&
-                    text[boundaries.start] == '"')
-                {
-                    mode = LocalPartValidator::ValidationMode::EXACT;
-                }
+    // Recursive crawl on the pool; symlinked directories are not followed to avoid cycles
+    void crawl(WorkStealingPool &pool, const std::filesystem::path &directory, size_t argument,
+               std::vector<std::pair<size_t, InputFile>> &found)
+    {
+        std::error_code ec;
+        std::vector<std::pair<size_t, InputFile>> files;
+        for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+        {
+            std::error_code entryError;
+            const auto status = it->symlink_status(entryError);
+            if (std::filesystem::is_directory(status))
+            {
+                const std::filesystem::path child = it->path();
+                pool.submit([this, &pool, child, argument, &found]()
+                            { crawl(pool, child, argument, found); });
+            }
+            else if (it->is_regular_file(entryError))
+            {
+                const uint64_t size = it->file_size(entryError);
+                if (entryError)
+                    reportError(it->path().string(), entryError.message());
+                else
+                    files.push_back({argument, {it->path().string(), size, isStreamed(it->path().string())}});
+            }
+        }
 
-                bool localValid = LocalPartValidator::validate(text, boundaries.start, atPos, mode);
-                bool domainValid = boundaries.didTrimDomain ||
-                                   DomainPartValidator::validate(text, atPos + 1, boundaries.end);
+        if (ec)
+            reportError(directory.string(), ec.message());
 
-                if (localValid && domainValid)
-                {
-                    minScannedIndex = std::max(minScannedIndex, boundaries.start);
-                    lastConsumedEnd = std::max(lastConsumedEnd, boundaries.end);
-                    return true;
-                }
+        std::lock_guard<std::mutex> lock(mutex_);
+        found.insert(found.end(), std::make_move_iterator(files.begin()), std::make_move_iterator(files.end()));
+    }
 
-                pos = atPos + 1;
+    // Inputs in argument order; files found under one directory argument sorted by path
+    void discoverInputs(WorkStealingPool &pool)
+    {
+        std::vector<std::pair<size_t, InputFile>> found;
+
+        for (size_t argument = 0; argument < config_.inputs.size(); ++argument)
+        {
+            const std::string &input = config_.inputs[argument];
+            std::error_code ec;
+            if (input == "-")
+            {
+                found.push_back({argument, {input, 0, true}});
+            }
+            else if (std::filesystem::is_directory(input, ec))
+            {
+                pool.submit([this, &pool, input, argument, &found]()
+                            { crawl(pool, input, argument, found); });
+            }
+            else
+            {
+                const uint64_t size = std::filesystem::file_size(input, ec);
+                if (ec)
+                    reportError(input, ec.message());
+                else
+                    found.push_back({argument, {input, size, isStreamed(input)}});
             }
+        }
+        pool.wait();
 
+        std::stable_sort(found.begin(), found.end(), [](const auto &a, const auto &b)
+                         { return a.first != b.first ? a.first < b.first : a.second.path < b.second.path; });
+
+        for (auto &entry : found)
+            inputs_.push_back(std::move(entry.second));
+    }
+
+    // Reads [begin, end) of a file; short reads (a file that shrank) just return less
+    [[nodiscard]] bool readRange(size_t input, uint64_t begin, uint64_t end, std::string &data)
+    {
+        std::ifstream file(inputs_[input].path, std::ios::binary);
+        if (!file)
+        {
+            reportError(inputs_[input].path, std::strerror(errno));
             return false;
         }
-        catch (...)
+
+        data.resize(static_cast<size_t>(end - begin));
+        file.seekg(static_cast<std::streamoff>(begin));
+        file.read(data.data(), static_cast<std::streamsize>(data.size()));
+        data.resize(static_cast<size_t>(file.gcount()));
+        if (file.bad())
         {
+            reportError(inputs_[input].path, "read error");
             return false;
         }
+        return true;
     }
 
-    [[nodiscard]] static std::vector<std::string> extract(std::string_view text) noexcept
+    [[nodiscard]] SegmentResult scanSegment(Segment &segment, EmailStreamScanner &scanner)
     {
-        std::vector<std::string> emails;
+        SegmentResult result;
+        result.input = segment.input;
+        result.lastOfInput = segment.lastOfInput;
 
-        try
+        uint64_t dataOffset = segment.dataOffset;
+        if (!inputs_[segment.input].streamed)
         {
-            const size_t len = text.length();
-
-            if (UNLIKELY(len > MAX_INPUT_SIZE || len < 5))
-                return emails;
+            const uint64_t size = inputs_[segment.input].size;
+            const uint64_t end = segment.wholeFile ? UINT64_MAX : std::min(size, segment.ownEnd + OVERLAP_BYTES);
+            dataOffset = segment.ownBegin - std::min<uint64_t>(segment.ownBegin, OVERLAP_BYTES);
+            if (segment.wholeFile)
+            {
+                std::error_code ec;
+                const uint64_t current = std::filesystem::file_size(inputs_[segment.input].path, ec);
+                segment.ownEnd = ec ? size : current;
+            }
+            if (!readRange(segment.input, dataOffset, std::min(end, segment.ownEnd + OVERLAP_BYTES), segment.data))
+                return result;
+        }
 
-            if (UNLIKELY(text.data() == nullptr && len > 0))
-                return emails;
+        scanBytes(segment, segment.data, dataOffset, scanner, result);
+        std::string().swap(segment.data);
+        return result;
+    }
 
-            size_t initial_reserve = std::min({MAX_INITIAL_RESERVE,
-                                               len / 30,
-                                               static_cast<size_t>(10)});
+    // data[0] sits at absolute offset dataOffset; only matches starting inside the segment's own
+    // range are kept
+    void scanBytes(const Segment &segment, std::string_view data, uint64_t dataOffset, EmailStreamScanner &scanner,
+                   SegmentResult &result)
+    {
+        auto onMatch = [&](std::string_view email, uint64_t offset)
+        {
+            const uint64_t absolute = dataOffset + offset;
+            if (absolute < segment.ownBegin || absolute >= segment.ownEnd)
+                return;
+            ++result.count;
+            if (!config_.countOnly)
+                result.matches.emplace_back(absolute, std::string(email));
+        };
 
-            emails.reserve(initial_reserve);
+        scanner.feed(data, onMatch);
+        scanner.finish(onMatch);
+    }
 
-            std::unordered_set<std::string> seen;
-            size_t expected_unique = std::min({len / 30,
-                                               MAX_EMAILS_EXTRACT,
-                                               MAX_SEEN_SET_SIZE});
+    // One ring per pool worker, set up on first use and torn down when the worker exits
+    [[nodiscard]] static IoUringReader &threadReader()
+    {
+        static thread_local IoUringReader reader;
+        return reader;
+    }
 
-            size_t reserve_size = 0;
-            if (safe_add(expected_unique * 13 / 10, 1, reserve_size))
+    // Reads the batch's small whole files through io_uring and scans each buffer as it completes.
+    // Files it did not handle (too large, grown past a buffer, ring failure) are left unmarked
+    // for the read path.
+    void scanWithUring(std::vector<Segment> &segments, std::vector<SegmentResult> &results, std::vector<bool> &done,
+                       EmailStreamScanner &scanner)
+    {
+        std::vector<size_t> indices;
+        std::vector<const char *> paths;
+        for (size_t i = 0; i < segments.size(); ++i)
+        {
+            const InputFile &file = inputs_[segments[i].input];
+            if (segments[i].wholeFile && file.size < IoUringReader::BUFFER_SIZE)
             {
-                reserve_size = std::min(reserve_size, MAX_SEEN_SET_SIZE);
-                seen.reserve(reserve_size);
+                indices.push_back(i);
+                paths.push_back(file.path.c_str());
             }
+        }
 
-            const char *data = text.data();
-            size_t pos = 0;
-            size_t minScannedIndex = 0;
-            size_t lastConsumedEnd = 0;
-            size_t extractedCount = 0;
-            size_t atSymbolsProcessed = 0;
-
-            std::atomic<size_t> totalOps{0};
-            OperationBatcher batcher;
-            batcher.local_count = 0;
+        IoUringReader &reader = threadReader();
+        if (indices.empty() || !reader.isAvailable())
+            return;
 
-            static constexpr size_t MAX_SCAN_ITERATIONS = 100'000;
-            size_t iterations = 0;
-            static constexpr size_t MAX_TOTAL_CHARS_SCANNED = 1'000'000;
-            size_t totalCharsScanned = 0;
-            size_t estimatedMemory = 0;
+        (void)reader.readFiles(paths, [&](size_t k, std::string_view data, int error)
+                               {
+            const size_t i = indices[k];
+            Segment &segment = segments[i];
+            SegmentResult &result = results[i];
+            result.input = segment.input;
+            result.lastOfInput = segment.lastOfInput;
 
-            while (pos < len && iterations++ < MAX_SCAN_ITERATIONS)
+            if (error != 0)
             {
-                if (batcher.checkLimit(totalOps, MAX_TOTAL_OPERATIONS)) [[unlikely]]
-                    break;
-
-                if (UNLIKELY(extractedCount >= MAX_EMAILS_EXTRACT))
-                    break;
-
-                if (UNLIKELY(atSymbolsProcessed >= MAX_AT_SYMBOLS))
-                    break;
-
-                auto atPosOpt = safe_memchr_index(data, pos, len, '@');
-                if (!atPosOpt)
-                    break;
+                reportError(inputs_[segment.input].path, std::strerror(error));
+                done[i] = true;
+                return;
+            }
+            if (data.size() >= IoUringReader::BUFFER_SIZE)
+                return;
 
-                size_t atPos = *atPosOpt;
-                ++atSymbolsProcessed;
+            segment.ownEnd = data.size();
+            scanBytes(segment, data, 0, scanner, result);
+            done[i] = true; });
+    }
 
-                if (UNLIKELY(atPos < 1 || atPos >= len - 3))
-                {
-                    pos = atPos + 1;
-                    continue;
-                }
+    // Turns the sorted inputs into numbered tasks and submits them as credits allow
+    void planTasks(WorkStealingPool &pool, BoundedQueue<TaskResult> &results, BoundedQueue<bool> &credits)
+    {
+        uint64_t sequence = 0;
+        std::vector<Segment> batch;
+        uint64_t batchBytes = 0;
 
-                if (atPos < lastConsumedEnd)
+        auto submit = [&](std::vector<Segment> segments)
+        {
+            if (segments.empty())
+                return;
+            credits.push(true);
+            const uint64_t id = sequence++;
+            pool.submit([this, &results, id, segments = std::move(segments)]() mutable
+                        {
+                EmailStreamScanner scanner(EmailStreamScanner::DEFAULT_WINDOW_SIZE, config_.scanOptions);
+                TaskResult result;
+                result.sequence = id;
+                result.segments.resize(segments.size());
+                std::vector<bool> done(segments.size(), false);
+                if (useUring_)
+                    scanWithUring(segments, result.segments, done, scanner);
+                for (size_t i = 0; i < segments.size(); ++i)
                 {
-                    pos = atPos + 1;
-                    continue;
+                    if (!done[i])
+                        result.segments[i] = scanSegment(segments[i], scanner);
                 }
+                results.push(std::move(result)); });
+        };
 
-                auto boundaries = findEmailBoundaries(text, atPos, minScannedIndex, totalOps, batcher);
+        auto flushBatch = [&]()
+        {
+            submit(std::move(batch));
+            batch.clear();
+            batchBytes = 0;
+        };
 
-                size_t charsScanned = 0;
-                size_t temp = 0;
+        for (size_t input = 0; input < inputs_.size(); ++input)
+        {
+            const InputFile &file = inputs_[input];
 
-                if (!safe_add(safe_subtract(atPos, boundaries.start),
-                              safe_subtract(boundaries.end, atPos), temp))
-                    break;
+            if (file.streamed)
+            {
+                flushBatch();
+                planStream(input, submit);
+                continue;
+            }
 
-                charsScanned = temp;
+            if (file.size <= config_.chunkSize)
+            {
+                Segment segment;
+                segment.input = input;
+                segment.ownEnd = file.size;
+                segment.wholeFile = true;
+                segment.lastOfInput = true;
+                batch.push_back(std::move(segment));
+                batchBytes += file.size;
+                if (batchBytes >= config_.chunkSize || batch.size() >= MAX_BATCH_FILES)
+                    flushBatch();
+                continue;
+            }
 
-                if (charsScanned > MAX_BACKTRACK_PER_AT)
-                {
-                    pos = atPos + 1;
-                    continue;
-                }
+            flushBatch();
+            for (uint64_t begin = 0; begin < file.size; begin += config_.chunkSize)
+            {
+                Segment segment;
+                segment.input = input;
+                segment.ownBegin = begin;
+                segment.ownEnd = std::min<uint64_t>(file.size, begin + config_.chunkSize);
+                segment.lastOfInput = segment.ownEnd == file.size;
+                std::vector<Segment> single;
+                single.push_back(std::move(segment));
+                submit(std::move(single));
+            }
+        }
+        flushBatch();
 
-                if (!safe_add(totalCharsScanned, charsScanned, totalCharsScanned))
-                    break;
+        pool.wait();
+        results.close();
+    }
 
-                if (totalCharsScanned > MAX_TOTAL_CHARS_SCANNED)
-                    break;
+    // Standard input and compressed files cannot be read at an offset, so they are read (and
+    // inflated) here, sequentially, and each chunk travels with its task. Decompression thus
+    // overlaps the scanning on the pool, and the credits bound the memory held in chunks.
+    template <typename Submit>
+    void planStream(size_t input, Submit &submit)
+    {
+        DecompressingReader reader(inputs_[input].path, config_.decompress);
+        std::string pending;
+        uint64_t pendingOffset = 0;
+        size_t lead = 0;
+        bool eof = false;
 
-                if (!boundaries.validBoundaries)
+        while (true)
+        {
+            const size_t want = lead + config_.chunkSize + OVERLAP_BYTES;
+            while (!eof && pending.size() < want)
+            {
+                const size_t before = pending.size();
+                pending.resize(want);
+                const size_t got = reader.read(&pending[before], want - before);
+                pending.resize(before + got);
+                if (got == 0)
                 {
-                    if (boundaries.skipTo > 0)
-                        pos = boundaries.skipTo;
-                    else
-                        pos = atPos + 1;
-                    continue;
+                    if (!reader.error().empty())
+                        reportError(inputs_[input].path, reader.error());
+                    eof = true;
                 }
+            }
 
-                LocalPartValidator::ValidationMode mode = LocalPartValidator::ValidationMode::SCAN;
-                if (boundaries.start < atPos && boundaries.start < len &&
-                    text[boundaries.start] == '"')
-                {
-                    mode = LocalPartValidator::ValidationMode::EXACT;
-                }
+            Segment segment;
+            segment.input = input;
+            segment.dataOffset = pendingOffset;
+            segment.ownBegin = pendingOffset + lead;
+            const size_t ownEnd = eof ? pending.size() : lead + config_.chunkSize;
+            segment.ownEnd = pendingOffset + ownEnd;
+            segment.lastOfInput = eof;
+
+            const size_t keepFrom = ownEnd - std::min(ownEnd, OVERLAP_BYTES);
+            std::string next = pending.substr(keepFrom);
+            segment.data = std::move(pending);
+            pending = std::move(next);
+            pendingOffset += keepFrom;
+            lead = ownEnd - keepFrom;
+
+            std::vector<Segment> single;
+            single.push_back(std::move(segment));
+            submit(std::move(single));
+            if (eof)
+                break;
+        }
+    }
 
-                bool localValid = LocalPartValidator::validate(text, boundaries.start, atPos, mode);
-                bool domainValid = boundaries.didTrimDomain ||
-                                   DomainPartValidator::validate(text, atPos + 1, boundaries.end);
+public:
+    ScanPipeline(const ScanConfig &config, std::ostream &err) : config_(config), err_(err) {}
 
-                if (localValid && domainValid)
-                {
-                    if (UNLIKELY(boundaries.start >= text.length() ||
-                                 boundaries.end > text.length() ||
-                                 boundaries.start >= boundaries.end))
-                    {
-                        pos = atPos + 1;
-                        continue;
-                    }
+    // Returns the process exit status: 0 on success, 1 if any input failed
+    int run(std::ostream &out)
+    {
+        if (config_.io != ScanIoBackend::READ)
+        {
+            useUring_ = IoUringReader().isAvailable();
+            if (!useUring_ && config_.io == ScanIoBackend::URING)
+                err_ << "scan: io_uring is not available here; using plain reads\n";
+        }
 
-                    std::string email(text.substr(boundaries.start, boundaries.end - boundaries.start));
+        WorkStealingPool pool(config_.threads);
+        discoverInputs(pool);
 
-                    size_t emailMemory = email.length() + sizeof(std::string) +
-                                         sizeof(void *) * 2;
-                    size_t newMemory = 0;
+        // Tasks between planner and writer; bounds memory while the writer waits for a slow task
+        BoundedQueue<TaskResult> results(pool.size() * 4);
+        BoundedQueue<bool> credits(pool.size() * 4);
+        std::thread planner([&]()
+                            { planTasks(pool, results, credits); });
 
-                    if (!safe_add(estimatedMemory, emailMemory, newMemory) ||
-                        newMemory > MAX_MEMORY_BUDGET)
-                        break;
+        static constexpr size_t FLUSH_BYTES = 64 * 1024;
+        std::string buffer;
+        buffer.reserve(FLUSH_BYTES * 2);
+        std::map<uint64_t, TaskResult> pendingResults;
+        uint64_t nextSequence = 0;
+        uint64_t inputCount = 0;
+        uint64_t total = 0;
 
-                    if (seen.size() >= MAX_SEEN_SET_SIZE)
-                        break;
+        auto write = [&](const SegmentResult &segment)
+        {
+            const std::string file = jsonEscape(inputs_[segment.input].path);
+            for (const auto &[offset, email] : segment.matches)
+            {
+                buffer += "{\"file\":\"";
+                buffer += file;
+                buffer += "\",\"offset\":";
+                buffer += std::to_string(offset);
+                buffer += ",\"email\":\"";
+                buffer += jsonEscape(email);
+                buffer += "\"}\n";
+            }
 
-                    if (emails.size() >= emails.capacity())
-                    {
-                        size_t new_capacity = emails.size() + 1;
-                        size_t additional_memory = new_capacity * sizeof(std::string);
+            inputCount += segment.count;
+            total += segment.count;
+            if (segment.lastOfInput)
+            {
+                if (config_.countOnly)
+                    buffer += "{\"file\":\"" + file + "\",\"count\":" + std::to_string(inputCount) + "}\n";
+                inputCount = 0;
+            }
 
-                        if (!safe_add(newMemory, additional_memory, newMemory) ||
-                            newMemory > MAX_MEMORY_BUDGET)
-                            break;
+            if (buffer.size() >= FLUSH_BYTES)
+            {
+                out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        };
 
-                        emails.reserve(new_capacity);
-                    }
+        while (auto result = results.pop())
+        {
+            pendingResults.emplace(result->sequence, std::move(*result));
+            for (auto it = pendingResults.find(nextSequence); it != pendingResults.end();
+                 it = pendingResults.find(nextSequence))
+            {
+                for (const auto &segment : it->second.segments)
+                    write(segment);
+                pendingResults.erase(it);
+                ++nextSequence;
+                (void)credits.pop();
+            }
+        }
 
-                    auto [it, inserted] = seen.insert(email);
+        planner.join();
 
-                    if (inserted)
-                    {
-                        try
-                        {
-                            emails.push_back(std::move(email));
-                            estimatedMemory = newMemory;
-                            ++extractedCount;
-                        }
-                        catch (...)
-                        {
-                            seen.erase(it);
-                            break;
-                        }
-                    }
+        if (config_.countOnly)
+            buffer += "{\"files\":" + std::to_string(inputs_.size()) + ",\"total\":" + std::to_string(total) + "}\n";
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        out.flush();
 
-                    minScannedIndex = std::max(minScannedIndex, boundaries.start);
-                    lastConsumedEnd = std::max(lastConsumedEnd, boundaries.end);
+        return failed_ ? 1 : 0;
+    }
+};
 
-                    if (boundaries.end < len)
-                    {
-                        unsigned char nextChar = static_cast<unsigned char>(data[boundaries.end]);
+// ====================================================================================================
+// REDACT FILTER (Standard input to standard output)
+// ====================================================================================================
 
-                        if (CharacterClassifier::isAtext(nextChar) || nextChar == '.')
-                        {
-                            bool foundNearbyAt = false;
-                            size_t lookLimit = std::min(boundaries.end + 65, len);
+struct RedactConfig
+{
+    RedactionMode mode = RedactionMode::TOKEN;
+    char maskChar = '*';
+    std::string token = "[EMAIL]";
+    std::string hashPrefix = "email:";
+    // Window of the stream redactor: input is read in blocks of up to this size, at most one
+    // redaction pass (EmailScanner::getRedactWindow())
+    size_t blockSize = 256 * 1024;
+    ScanOptions scanOptions;
+    // Tenant key and cache for --pseudonymize, shared by copies of the config
+    std::shared_ptr<EmailPseudonymizer> pseudonymizer;
+    // Index behind scanOptions.knownEmails for --known, shared likewise
+    std::shared_ptr<const KnownEmailFilter> knownEmails;
+    // Rules behind scanOptions.domainRules for --ignore-domains / --report-domains
+    std::shared_ptr<DomainRuleSet> domainRules;
+
+    static constexpr const char *KEY_VARIABLE = "EMAIL_DETECTOR_PSEUDONYM_KEY";
+
+    // First line of the file, surrounding whitespace ignored
+    [[nodiscard]] static PseudonymKey readKeyFile(const std::string &path)
+    {
+        std::ifstream file(path);
+        std::string line;
+        if (!file || !std::getline(file, line))
+            throw std::runtime_error("cannot read key file " + path);
+
+        const size_t first = line.find_first_not_of(" \t\r");
+        const size_t last = line.find_last_not_of(" \t\r");
+        return PseudonymKey::fromHex(first == std::string::npos ? std::string_view()
+                                                                : std::string_view(line).substr(first, last - first + 1));
+    }
 
-                            for (size_t look = boundaries.end; look < lookLimit; ++look)
-                            {
-                                if (data[look] == '@')
-                                {
-                                    foundNearbyAt = true;
-                                    break;
-                                }
-                            }
+    // Views this config's strings; valid while the config is
+    [[nodiscard]] RedactionPolicy policy() const noexcept
+    {
+        RedactionPolicy policy;
+        policy.mode = mode;
+        policy.maskChar = maskChar;
+        policy.token = token;
+        policy.hashPrefix = hashPrefix;
+        policy.pseudonymizer = pseudonymizer.get();
+        return policy;
+    }
 
-                            if (foundNearbyAt)
-                            {
-                                pos = boundaries.end;
-                                continue;
-                            }
-                        }
-                    }
+    static RedactConfig parse(const std::vector<std::string_view> &args)
+    {
+        RedactConfig config;
+        std::string pseudonymPrefix = "user:";
+        std::string keyFile;
+        size_t cacheEntries = 0;
 
-                    pos = boundaries.end;
-                    continue;
-                }
+        for (std::string_view arg : args)
+        {
+            const size_t eq = arg.find('=');
+            const std::string_view name = arg.substr(0, eq);
+            const std::string_view value = eq == std::string_view::npos ? std::string_view() : arg.substr(eq + 1);
+            const bool hasValue = eq != std::string_view::npos;
 
-                pos = atPos + 1;
+            if (name == "--token" && hasValue)
+            {
+                config.mode = RedactionMode::TOKEN;
+                config.token = std::string(value);
+            }
+            else if (name == "--mask")
+            {
+                if (hasValue && value.size() != 1)
+                    throw std::invalid_argument("--mask takes a single character");
+                config.mode = RedactionMode::MASK;
+                if (hasValue)
+                    config.maskChar = value.front();
+            }
+            else if (name == "--shape")
+            {
+                if (hasValue && value.size() != 1)
+                    throw std::invalid_argument("--shape takes a single character");
+                config.mode = RedactionMode::SHAPE;
+                if (hasValue)
+                    config.maskChar = value.front();
+            }
+            else if (name == "--hash")
+            {
+                config.mode = RedactionMode::HASH;
+                if (hasValue)
+                    config.hashPrefix = std::string(value);
+            }
+            else if (name == "--pseudonymize")
+            {
+                config.mode = RedactionMode::PSEUDONYM;
+                if (hasValue)
+                    pseudonymPrefix = std::string(value);
+            }
+            else if (name == "--key-file" && hasValue)
+            {
+                keyFile = std::string(value);
+            }
+            else if (name == "--pseudonym-cache" && hasValue)
+            {
+                cacheEntries = static_cast<size_t>(BenchmarkConfig::parseSize(value, name));
+            }
+            else if (name == "--block-size" && hasValue)
+            {
+                config.blockSize = static_cast<size_t>(BenchmarkConfig::parseSize(value, name));
+                if (config.blockSize < EmailStreamRedactor::MIN_WINDOW_SIZE)
+                    throw std::invalid_argument("--block-size must be at least 4K");
+                if (config.blockSize > EmailScanner::getRedactWindow())
+                    throw std::invalid_argument("--block-size must be at most 256K");
+            }
+            else if (name == "--skip-binary" && !hasValue)
+            {
+                config.scanOptions.skipBinary = true;
+            }
+            else if (name == "--strict-tld" && !hasValue)
+            {
+                config.scanOptions.strictTld = true;
+            }
+            else if (name == "--min-run" && hasValue)
+            {
+                config.scanOptions.minPrintableRun = static_cast<size_t>(BenchmarkConfig::parseUnsigned(value, name));
+                if (config.scanOptions.minPrintableRun == 0)
+                    throw std::invalid_argument("--min-run must be at least 1");
+            }
+            else if (name == "--known" && hasValue)
+            {
+                config.knownEmails = KnownEmailFilter::load(std::string(value));
+                config.scanOptions.knownEmails = config.knownEmails.get();
+            }
+            else if (name == "--ignore-domains" && hasValue)
+            {
+                addDomainRules(config.domainRules, config.scanOptions, value, DomainAction::IGNORE);
+            }
+            else if (name == "--report-domains" && hasValue)
+            {
+                addDomainRules(config.domainRules, config.scanOptions, value, DomainAction::REPORT);
+            }
+            else
+            {
+                throw std::invalid_argument("unknown redact option '" + std::string(arg) + "'");
             }
         }
-        catch (const std::bad_alloc &)
-        {
-            emails.clear();
-        }
-        catch (const std::length_error &)
-        {
-            emails.clear();
-        }
-        catch (...)
+
+        if (config.mode == RedactionMode::PSEUDONYM)
         {
-            emails.clear();
+            // The key never goes on the command line, where other users could read it
+            const char *variable = std::getenv(KEY_VARIABLE);
+            if (keyFile.empty() && (variable == nullptr || *variable == '\0'))
+                throw std::invalid_argument(std::string("--pseudonymize needs a key: set ") + KEY_VARIABLE +
+                                            " or pass --key-file=PATH");
+
+            const PseudonymKey key = keyFile.empty() ? PseudonymKey::fromHex(variable) : readKeyFile(keyFile);
+            config.pseudonymizer = std::make_shared<EmailPseudonymizer>(key, pseudonymPrefix, cacheEntries);
         }
 
-        return emails;
+        return config;
     }
-};
 
-// ====================================================================================================
-// EMAIL SCANNER SERVICE (With Statistics)
-// ====================================================================================================
+    static void printUsage(std::ostream &out)
+    {
+        out << "Redact options:\n"
+            << "  --token=TEXT        replace each address with TEXT (default: [EMAIL])\n"
+            << "  --mask[=C]          overwrite each address byte with C (default: *), keeping offsets\n"
+            << "  --shape[=C]         like --mask, but keep '.', '@', the first byte of each local-part\n"
+            << "                      segment and domain label over one byte, and the TLD:\n"
+            << "                      j***.d**@e******.com, a@b.co becomes *@*.co\n"
+            << "  --hash[=PREFIX]     replace each address with PREFIX and 16 hex digits of its hash,\n"
+            << "                      the same for the same address (default prefix: email:)\n"
+            << "  --pseudonymize[=PREFIX]\n"
+            << "                      replace each address with PREFIX and 16 hex digits of its SipHash-2-4\n"
+            << "                      under the tenant key (default prefix: user:); the key is 32 hex digits\n"
+            << "                      from $EMAIL_DETECTOR_PSEUDONYM_KEY or the first line of --key-file=PATH\n"
+            << "  --pseudonym-cache=N keep about N recent address -> pseudonym pairs (default: 0, off)\n"
+            << "  --block-size=SIZE   read and redact in blocks of SIZE bytes, 4K to 256K (default: 256K)\n"
+            << "  --skip-binary       ignore '@'s in 4K blocks that look binary, except inside printable\n"
+            << "                      runs of at least --min-run bytes (default: 6)\n"
+            << "  --strict-tld        leave addresses whose TLD is not in the root zone as they are\n"
+            << "  --known=INDEX       redact only addresses listed in INDEX (see index build)\n"
+            << "  --ignore-domains=LIST, --report-domains=LIST\n"
+            << "                      leave or redact addresses by domain, as for scan\n"
+            << "Copies standard input to standard output with every address replaced. Complete lines\n"
+            << "are written out as soon as input goes quiet, so the filter can sit in a live log pipe.\n"
+            << "If scan limits cut a block short, output stops after the last address redacted and the\n"
+            << "filter exits with status 1; the rest of the input is never written.\n";
+    }
+};
 
-class EmailScannerService final
+// Drives an EmailStreamRedactor from a file descriptor to another. Input is read straight into the
+// redactor's window and output is written with writev() from the window and the rendered
+// replacements, so untouched bytes are copied once on the way in and never again in user space.
+// Each read that drains the input releases the complete lines buffered so far, so a quiet pipe
+// waits for at most one block's redaction, not for the window to fill.
+class RedactFilter
 {
 private:
-    ValidationStats stats_;
-
-public:
-    EmailScannerService() = default;
+    const RedactConfig &config_;
+    std::ostream &errors_;
+#if defined(__linux__)
+    std::vector<iovec> pending_;
+#endif
+    bool writeFailed_ = false;
 
-    EmailScannerService(const EmailScannerService &) = delete;
-    EmailScannerService &operator=(const EmailScannerService &) = delete;
+#if defined(__linux__)
+    // Sends pending_ with as few writev() calls as IOV_MAX allows, resuming after short writes
+    void writePending(int out)
+    {
+        size_t next = 0;
+        while (next < pending_.size() && !writeFailed_)
+        {
+            const int count = static_cast<int>(std::min<size_t>(pending_.size() - next, IOV_MAX));
+            const ssize_t written = ::writev(out, pending_.data() + next, count);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                errors_ << "Error: cannot write output: " << std::strerror(errno) << "\n";
+                writeFailed_ = true;
+                break;
+            }
 
-    EmailScannerService(EmailScannerService &&) noexcept = default;
-    EmailScannerService &operator=(EmailScannerService &&) noexcept = default;
+            auto left = static_cast<size_t>(written);
+            while (next < pending_.size() && left >= pending_[next].iov_len)
+                left -= pending_[next++].iov_len;
+            if (left > 0)
+            {
+                pending_[next].iov_base = static_cast<char *>(pending_[next].iov_base) + left;
+                pending_[next].iov_len -= left;
+            }
+        }
+        pending_.clear();
+    }
 
-    [[nodiscard]] bool contains(std::string_view text) noexcept
+    [[nodiscard]] static bool inputPending(int in) noexcept
     {
-        stats_.recordScan();
-
-        bool result = EmailScanner::contains(text);
-
-        if (!result)
-            stats_.recordError();
+        pollfd descriptor{in, POLLIN, 0};
+        return ::poll(&descriptor, 1, 0) > 0;
+    }
+#endif
 
-        return result;
+public:
+    RedactFilter(const RedactConfig &config, std::ostream &errors) : config_(config), errors_(errors)
+    {
     }
 
-    [[nodiscard]] std::vector<std::string> extract(std::string_view text) noexcept
+    // Copies in to out with addresses redacted; returns the exit status, 1 if reading or writing
+    // failed or scan limits cut the output short
+    int run(int in, int out)
     {
-        stats_.recordExtract();
+        EmailStreamRedactor redactor(config_.policy(), config_.blockSize, config_.scanOptions);
+        bool readFailed = false;
 
-        auto result = EmailScanner::extract(text);
+#if defined(__linux__)
+        // Consecutive pieces (a hash prefix and its digits) share one iovec
+        auto sink = [this, out](std::string_view piece)
+        {
+            if (piece.empty())
+            {
+                writePending(out);
+                return;
+            }
+            if (!pending_.empty() &&
+                static_cast<const char *>(pending_.back().iov_base) + pending_.back().iov_len == piece.data())
+            {
+                pending_.back().iov_len += piece.size();
+                return;
+            }
+            pending_.push_back({const_cast<char *>(piece.data()), piece.size()});
+        };
 
-        if (result.empty())
-            stats_.recordError();
+        while (!writeFailed_ && !redactor.getReport().wasTruncated())
+        {
+            const size_t room = redactor.writableSize();
+            const ssize_t got = ::read(in, redactor.writableData(), room);
+            if (got < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                errors_ << "Error: cannot read input: " << std::strerror(errno) << "\n";
+                readFailed = true;
+                break;
+            }
+            if (got == 0)
+                break;
 
-        return result;
-    }
+            redactor.commit(static_cast<size_t>(got), sink);
+            if (static_cast<size_t>(got) < room && !inputPending(in))
+                redactor.flushLines(sink);
+        }
+#else
+        (void)in;
+        (void)out;
+        auto sink = [this](std::string_view piece)
+        {
+            if (!writeFailed_ && std::fwrite(piece.data(), 1, piece.size(), stdout) != piece.size())
+            {
+                errors_ << "Error: cannot write output\n";
+                writeFailed_ = true;
+            }
+            if (piece.empty())
+                std::fflush(stdout);
+        };
 
-    [[nodiscard]] const ValidationStats &getStats() const noexcept
-    {
-        return stats_;
-    }
+        while (!writeFailed_ && !redactor.getReport().wasTruncated())
+        {
+            const size_t got = std::fread(redactor.writableData(), 1, redactor.writableSize(), stdin);
+            redactor.commit(got, sink);
+            if (got == 0)
+            {
+                readFailed = std::ferror(stdin) != 0;
+                break;
+            }
+        }
+#endif
 
-    void resetStats() noexcept
-    {
-        stats_.reset();
+        redactor.finish(sink);
+
+        const ScanReport &report = redactor.getReport();
+        if (report.wasTruncated())
+            errors_ << "Error: " << scanLimitName(report.truncatedBy)
+                    << " cut a block short; output stops after the last address redacted\n";
+
+        return readFailed || writeFailed_ || report.wasTruncated() ? 1 : 0;
     }
 };
 
 // ====================================================================================================
-// FACTORY (Dependency Inversion Principle)
+// KNOWN EMAIL INDEX TOOL (CLI: address list -> index file)
 // ====================================================================================================
 
-class EmailServiceFactory
+struct IndexConfig
 {
-public:
-    // Create service instances with independent statistics
-    [[nodiscard]] static EmailValidationService createValidationService()
+    // One address per line; "-" is standard input
+    std::string listPath;
+    std::string indexPath;
+    PseudonymKey seed = KnownEmailIndex::DEFAULT_SEED;
+    // Skip lines that are not valid addresses instead of indexing them as they are
+    bool validate = true;
+
+    static IndexConfig parse(const std::vector<std::string_view> &args)
     {
-        return EmailValidationService{};
+        if (args.empty() || args.front() != "build")
+            throw std::invalid_argument("index needs a subcommand: index build LIST INDEX");
+
+        IndexConfig config;
+        std::vector<std::string_view> paths;
+        for (size_t i = 1; i < args.size(); ++i)
+        {
+            const std::string_view arg = args[i];
+            const size_t eq = arg.find('=');
+            const std::string_view name = arg.substr(0, eq);
+            const std::string_view value = eq == std::string_view::npos ? std::string_view() : arg.substr(eq + 1);
+            const bool hasValue = eq != std::string_view::npos;
+
+            if (arg == "-" || arg.substr(0, 2) != "--")
+                paths.push_back(arg);
+            else if (name == "--seed" && hasValue)
+                config.seed = PseudonymKey::fromHex(value);
+            else if (name == "--no-validate" && !hasValue)
+                config.validate = false;
+            else
+                throw std::invalid_argument("unknown index option '" + std::string(arg) + "'");
+        }
+
+        if (paths.size() != 2)
+            throw std::invalid_argument("index build takes an address list and an output path");
+        config.listPath = std::string(paths[0]);
+        config.indexPath = std::string(paths[1]);
+        return config;
     }
 
-    [[nodiscard]] static EmailScannerService createScannerService()
+    static void printUsage(std::ostream &out)
     {
-        return EmailScannerService{};
+        out << "Index options:\n"
+            << "  --seed=HEX          32 hex digits seeding the fingerprints (default: a fixed seed)\n"
+            << "  --no-validate       index every non-blank line as it is, valid address or not\n"
+            << "Builds a read-only index of the addresses in LIST (one per line, - for stdin) for\n"
+            << "scan --known and redact --known: 64-bit fingerprints in cache-line buckets, about 9\n"
+            << "bytes per address, mapped rather than loaded. Domains match case-insensitively.\n";
     }
+};
 
-    // Get thread-local service instances (for convenience)
-    [[nodiscard]] static EmailValidationService &getThreadLocalValidationService()
+static int runIndexBuild(const IndexConfig &config, std::ostream &out)
+{
+    KnownEmailIndexBuilder builder(config.seed, config.validate);
+    if (config.listPath == "-")
     {
-        thread_local EmailValidationService instance;
-        return instance;
+        builder.addLines(std::cin);
     }
-
-    [[nodiscard]] static EmailScannerService &getThreadLocalScannerService()
+    else
     {
-        thread_local EmailScannerService instance;
-        return instance;
+        std::ifstream list(config.listPath);
+        if (!list)
+            throw std::runtime_error("cannot read " + config.listPath);
+        builder.addLines(list);
     }
-};
+
+    const KnownEmailIndexBuilder::Summary summary = builder.write(config.indexPath);
+    out << config.indexPath << ": " << summary.entries << " addresses in " << summary.bucketCount
+        << " buckets, " << summary.fileBytes << " bytes (" << summary.duplicates << " duplicates, "
+        << summary.invalid << " invalid lines skipped)\n";
+    return 0;
+}
 
 // ====================================================================================================
 // TEST SUITE
@@ -1918,6 +10776,31 @@ public:
 
 class EmailValidatorTest
 {
+private:
+    // Named checks for the suites that are not a TestCase table: one ✓/✗ line per check, then
+    // the tally
+    class CheckTally
+    {
+    private:
+        int passed_ = 0;
+        int total_ = 0;
+
+    public:
+        void operator()(bool condition, const std::string &description)
+        {
+            ++total_;
+            if (condition)
+                ++passed_;
+            std::cout << (condition ? "✓" : "✗") << " " << description << std::endl;
+        }
+
+        void printSummary() const
+        {
+            std::cout << "Result: " << passed_ << "/" << total_ << " passed\n"
+                      << std::endl;
+        }
+    };
+
 public:
     static void runExactValidationTests()
     {
@@ -2560,333 +11443,1343 @@ public:
         std::cout << "✓ All adversarial tests passed\n";
     }
 
-    static void runPerformanceBenchmark()
+    static void runComplexityTests()
     {
-        std::cout << "\n"
-                  << std::string(100, '=') << "\n";
-        std::cout << "=== COMPREHENSIVE PERFORMANCE BENCHMARK ===\n";
-        std::cout << std::string(100, '=') << "\n";
+        std::cout << "\n=== PATHOLOGICAL INPUT COMPLEXITY TESTS ===\n";
 
-        EmailValidator validator;
-        EmailScanner scanner;
+        CheckTally check;
 
-        std::vector<std::string> testCases = {
-            "Simple email: user@example.com in text",
-            "Multiple emails: first@domain.com and second@another.org",
-            "user..double@domain.com",
-            "Complex: john.doe+filter@sub.domain.co.uk mixed with text",
-            "No emails in this text at all",
-            "Edge case: a@b.co minimal email",
-            "review-team@geeksforgeeks.org",
-            "user..double@domain.com",
-            "user.@domain.com",
-            "27 age and alpha@gmail.com and other data",
-            "adfdgifldj@fk458439678 4krf8956 346 alpha@gmail.com r90wjk kf433@8958ifdjkks fgkl548765gr",
-            "27 age and alphatyicbnkdleoxkthes123fd56569565@gmail.com and othere data missing...!",
-            "any aged group and alphatyic(b)nkdleoxk%t/hes123fd56569565@gmail.com and othere data missing...!",
-            "27 age and alphatyicbnk.?'.,dleoxkthes123fd56569565@gmail.com and othere data missing...! other@email.co",
-            "27 age and alphatyicbnkdleo$#-=+xkthes123fd56569565@gmail.com and othere data missing...!",
-            "No email here",
-            "test@domain",
-            "invalid@.com",
-            "valid.email+tag@example.co.uk",
-            "Contact us at support@company.com for help",
-            "Multiple: first@test.com, second@demo.org",
-            "invalid@.com and test@domain",
-            std::string(1000, 'x') + "hidden@email.com" + std::string(1000, 'y'),
+        // Each family at a size well past every per-'@' window
+        for (auto family : EmailBenchmark::ALL_PATHOLOGICAL_FAMILIES)
+        {
+            const std::string text = EmailBenchmark::generatePathological(family, 256 * 1024);
+            ScanReport containsReport;
+            ScanReport extractReport;
+            ScanReport visitReport;
+            (void)EmailScanner::contains(text, containsReport);
+            const auto emails = EmailScanner::extract(text, extractReport);
+            size_t visited = 0;
+            EmailScanner::forEachMatch(text, visitReport, [&visited](size_t, size_t)
+                                       {
+                                           ++visited;
+                                           return true; });
+            check(!containsReport.rejectedOversize && !extractReport.rejectedOversize &&
+                      extractReport.emailsFound == emails.size() && visitReport.emailsFound == visited &&
+                      visited >= emails.size(),
+                  std::string("Pathological ") + EmailBenchmark::pathologicalFamilyName(family) + " (256 KiB): " +
+                      std::to_string(emails.size()) + " extracted, stopped by " +
+                      scanLimitName(extractReport.truncatedBy) + "; forEachMatch stopped by " +
+                      scanLimitName(visitReport.truncatedBy));
+        }
 
-            "user@example.com",
-            "a@b.co",
-            "test.user@example.com",
-            "user+tag@gmail.com",
+        // Timer noise can push a single fit past MAX_LINEAR_EXPONENT; real superlinear growth fails
+        // every attempt
+        BenchmarkConfig config;
+        config.complexity = true;
+        config.jsonOutput = true;
+        config.minSize = 1024;
+        config.maxSize = 256 * 1024;
+        bool linear = false;
+        int attempts = 0;
+        while (!linear && attempts < 3)
+        {
+            std::ostringstream suiteOutput;
+            linear = EmailBenchmark::runComplexitySuite(config, suiteOutput);
+            ++attempts;
+        }
+        check(linear, "No family grows superlinearly from 1K to 256K in contains, extract or forEachMatch (" +
+                          std::to_string(attempts) + (attempts == 1 ? " attempt)" : " attempts)"));
 
-            "user!test@example.com",
-            "user#tag@example.com",
-            "user$admin@example.com",
-            "user%percent@example.com",
-            "user&name@example.com",
-            "user'quote@example.com",
-            "user*star@example.com",
-            "user=equal@example.com",
-            "user?question@example.com",
-            "user^caret@example.com",
-            "user_underscore@example.com",
-            "user`backtick@example.com",
-            "userbrace@example.com",
-            "user|pipe@example.com",
-            "user}brace@example.com",
-            "user~tilde@example.com",
+        check.printSummary();
+    }
 
-            "\"user\"@example.com",
-            "\"user name\"@example.com",
-            "\"user@internal\"@example.com",
-            "\"user.name\"@example.com",
-            "\"user\\\"name\"@example.com",
-            "\"user\\\\name\"@example.com",
+    static void runStatisticsTests()
+    {
+        std::cout << "\n=== SCAN OUTCOME STATISTICS TESTS ===\n";
 
-            "user@[192.168.1.1]",
-            "user@[2001:db8::1]",
-            "test@[10.0.0.1]",
-            "user@[fe80::1]",
-            "user@[::1]",
+        CheckTally check;
 
-            "first.last@sub.domain.co.uk",
-            "user@domain-name.com",
-            "user@123.456.789.012",
-            "user@domain.x",
-            "user@domain.123",
+        EmailScannerService scanner;
 
-            "user..double@domain.com",
-            ".user@domain.com",
-            "user.@domain.com",
-            "user@domain..com",
-            "@example.com",
-            "user@",
-            "userexample.com",
-            "user@@example.com",
-            "user@domain",
-            "user@.domain.com",
-            "user@domain.com.",
-            "user@-domain.com",
-            "user@domain-.com",
-            "user name@example.com",
-            "user@domain .com",
-            "\"unclosed@example.com",
-            "\"user\"name@example.com",
-            "user@[192.168.1]",
-            "user@[999.168.1.1]",
-            "user@[192.168.1.256]",
-            "user@[gggg::1]",
+        const std::string matchText = "Contact: user@example.com";
+        const std::string noMatchText = "no emails here";
+        (void)scanner.contains(matchText);
+        (void)scanner.contains(noMatchText);
+        (void)scanner.extract(matchText);
+        (void)scanner.extract(noMatchText);
+
+        auto snapshot = scanner.getStats().getSnapshot();
+        check(snapshot.matches == 2, "Matched contains/extract counted as matches");
+        check(snapshot.noMatches == 2, "Clean input counted as no-match, not error");
+        check(snapshot.errors == 0, "No internal check failures on ordinary input");
+        check(snapshot.getErrorRate() == 0.0, "Error rate stays zero when nothing is found");
+        check(snapshot.emailsFound == 2, "Emails found counted per email");
+        check(snapshot.bytesScanned == 2 * (matchText.size() + noMatchText.size()), "Bytes scanned counted per call");
+
+        scanner.resetStats();
+        std::string oversize(11 * 1024 * 1024, 'a');
+        (void)scanner.contains(oversize);
+        (void)scanner.extract(oversize);
+        snapshot = scanner.getStats().getSnapshot();
+        check(snapshot.oversize == 2 && snapshot.noMatches == 0, "Oversize input counted as rejected-oversize");
+        check(snapshot.bytesScanned == 0, "Rejected input does not count as scanned bytes");
+
+        scanner.resetStats();
+        std::string manyAts;
+        for (int i = 0; i < 2000; ++i)
+        {
+            manyAts += "a@ ";
+        }
+        ScanReport report;
+        (void)EmailScanner::extract(manyAts, report);
+        check(report.truncatedBy == ScanLimit::AT_SYMBOLS,
+              std::string("Bare '@' flood stopped by ") + scanLimitName(report.truncatedBy));
+
+        std::string manyEmails;
+        for (int i = 0; i < 2000; ++i)
+        {
+            manyEmails += "u" + std::to_string(i) + "@d.com ";
+        }
+        auto emails = EmailScanner::extract(manyEmails, report);
+        check(report.truncatedBy == ScanLimit::MEMORY_BUDGET && report.emailsFound == emails.size(),
+              std::string("Email flood stopped by ") + scanLimitName(report.truncatedBy));
+
+        (void)scanner.extract(manyAts);
+        (void)scanner.extract(manyEmails);
+        snapshot = scanner.getStats().getSnapshot();
+        check(snapshot.getTruncationCount(ScanLimit::AT_SYMBOLS) == 1 &&
+                  snapshot.getTruncationCount(ScanLimit::MEMORY_BUDGET) == 1 &&
+                  snapshot.getTotalTruncations() == 2,
+              "Per-limit truncation recorded in service statistics");
+
+        check.printSummary();
+    }
+
+    static void runStreamScannerTests()
+    {
+        std::cout << "\n=== STREAM SCANNER TESTS ===\n";
+
+        CheckTally check;
+
+        std::string document;
+        std::vector<std::pair<std::string, uint64_t>> expected;
+        for (int i = 0; i < 3000; ++i)
+        {
+            document += "line " + std::to_string(i) + " filler text without addresses; ";
+            if (i % 7 == 0)
+            {
+                std::string email = "user" + std::to_string(i) + "@host" + std::to_string(i % 13) + ".example.com";
+                expected.emplace_back(email, document.size());
+                document += email;
+            }
+            document += '\n';
+        }
+
+        for (size_t chunkSize : {1u, 7u, 4096u, 1u << 20})
+        {
+            EmailStreamScanner stream(EmailStreamScanner::MIN_WINDOW_SIZE);
+            std::vector<std::pair<std::string, uint64_t>> found;
+            auto onMatch = [&found](std::string_view email, uint64_t offset)
+            { found.emplace_back(std::string(email), offset); };
+
+            for (size_t pos = 0; pos < document.size(); pos += chunkSize)
+                stream.feed(std::string_view(document).substr(pos, chunkSize), onMatch);
+            stream.finish(onMatch);
+
+            check(found == expected && stream.getReport().bytesScanned == document.size(),
+                  "Chunks of " + std::to_string(chunkSize) + " bytes: " + std::to_string(found.size()) +
+                      " matches at exact offsets");
+        }
+
+        EmailStreamScanner stream;
+        std::vector<uint64_t> offsets;
+        auto onOffset = [&offsets](std::string_view, uint64_t offset)
+        { offsets.push_back(offset); };
+        stream.feed("first a@b.co", onOffset);
+        stream.finish(onOffset);
+        stream.feed("x@y.io second", onOffset);
+        stream.finish(onOffset);
+        check(offsets == std::vector<uint64_t>{6, 0}, "finish() restarts offsets for the next stream");
+
+        check.printSummary();
+    }
+
+    static void runCorpusGeneratorTests()
+    {
+        std::cout << "\n=== CORPUS GENERATOR TESTS ===\n";
+
+        CheckTally check;
+
+        CorpusOptions options;
+        options.documentSize = 64 * 1024;
+
+        for (CorpusType type : ALL_CORPUS_TYPES)
+        {
+            CorpusGenerator first(options);
+            CorpusGenerator second(options);
+            const std::string a = first.generateDocument(type);
+            const std::string b = second.generateDocument(type);
+            const size_t emails = EmailScanner::extract(a).size();
+
+            check(a == b && a.size() == options.documentSize && emails > 0,
+                  std::string(corpusTypeName(type)) + ": deterministic, exact size, " +
+                      std::to_string(emails) + " unique emails");
+        }
+
+        CorpusOptions noEmails = options;
+        noEmails.emailDensity = 0.0;
+        CorpusGenerator clean(noEmails);
+        check(!EmailScanner::contains(clean.generateDocument(CorpusType::SYSLOG).substr(0, 8192)),
+              "Zero email density yields no emails (near misses only)");
+
+        check.printSummary();
+    }
+
+    static void runBinarySkipTests()
+    {
+        std::cout << "\n=== BINARY SKIPPING TESTS ===\n";
+
+        CheckTally check;
+
+        // Every byte value, at every alignment and tail length the SIMD loops can see
+        std::string bytes;
+        for (int i = 0; i < 1024 + 37; ++i)
+            bytes += static_cast<char>((i * 151 + 7) & 0xFF);
+        bool countsAgree = true;
+        for (size_t offset = 0; offset < 40; ++offset)
+        {
+            size_t expected = 0;
+            for (size_t i = offset; i < bytes.size(); ++i)
+                expected += CharacterClassifier::isInvalidLocalChar(static_cast<unsigned char>(bytes[i])) ? 1 : 0;
+            countsAgree = countsAgree &&
+                          CharacterClassifier::countInvalidLocal(bytes.data() + offset, bytes.size() - offset) == expected;
+        }
+        check(countsAgree, "SIMD count of CHAR_INVALID_LOCAL bytes matches charTable");
+
+        // Random bytes with an '@' every 16 bytes, and one address per 2 KiB in a printable run
+        std::string blob;
+        std::vector<std::string> planted;
+        uint64_t state = 42;
+        for (int block = 0; block < 64; ++block)
+        {
+            for (int i = 0; i < 2048; ++i)
+            {
+                state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                blob += (i % 16 == 0) ? '@' : static_cast<char>(state >> 56);
+            }
+            planted.push_back("user" + std::to_string(block) + "@binary.example.com");
+            blob += std::string("\0 ", 2) + planted.back() + std::string(" \0", 2);
+        }
+
+        ScanOptions skip;
+        skip.skipBinary = true;
+        ScanReport report;
+        const auto skipped = EmailScanner::extract(blob, report, skip);
+        const size_t plantedFound = static_cast<size_t>(std::count_if(
+            planted.begin(), planted.end(), [&skipped](const std::string &email)
+            { return std::find(skipped.begin(), skipped.end(), email) != skipped.end(); }));
+        check(plantedFound == planted.size(), "Addresses in long printable runs are found in binary data (" +
+                                                  std::to_string(plantedFound) + "/" +
+                                                  std::to_string(planted.size()) + ")");
+
+        std::vector<uint64_t> skipOffsets;
+        EmailScanner::forEachMatch(blob, report, [&skipOffsets](size_t start, size_t)
+                                   { skipOffsets.push_back(start); return true; }, skip);
+        size_t everyMatch = 0;
+        EmailScanner::forEachMatch(blob, report, [&everyMatch](size_t, size_t)
+                                   { ++everyMatch; return true; });
+        check(skipOffsets.size() < everyMatch, "Skipping drops junk matches in binary garbage (" +
+                                                   std::to_string(everyMatch) + " -> " +
+                                                   std::to_string(skipOffsets.size()) + ")");
+
+        std::vector<uint64_t> streamed;
+        EmailStreamScanner stream(EmailStreamScanner::MIN_WINDOW_SIZE, skip);
+        auto collect = [&streamed](std::string_view, uint64_t offset)
+        { streamed.push_back(offset); };
+        for (size_t at = 0; at < blob.size(); at += 1000)
+            stream.feed(std::string_view(blob).substr(at, 1000), collect);
+        stream.finish(collect);
+        check(streamed == skipOffsets, "Stream scanner with skipBinary reports the same matches");
+
+        ScanOptions longRuns = skip;
+        longRuns.minPrintableRun = 40;
+        check(EmailScanner::extract(blob, report, longRuns).empty(),
+              "Runs shorter than minPrintableRun are skipped");
+
+        CorpusOptions corpusOptions;
+        corpusOptions.documentSize = 256 * 1024;
+        const std::string text = CorpusGenerator(corpusOptions).generateDocument(CorpusType::SYSLOG);
+        check(EmailScanner::extract(text, report, skip) == EmailScanner::extract(text),
+              "Text is scanned exactly as without skipping");
+
+        check.printSummary();
+    }
+
+    static void runRedactionTests()
+    {
+        std::cout << "\n=== REDACTION TESTS ===\n";
+
+        CheckTally check;
+
+        std::string document;
+        for (int i = 0; i < 3000; ++i)
+        {
+            document += "line " + std::to_string(i) + " filler text without addresses; ";
+            if (i % 7 == 0)
+                document += "user" + std::to_string(i) + "@host" + std::to_string(i % 13) + ".example.com";
+            document += '\n';
+        }
+        document += "last a@b.co";
+
+        // Reference: find/replace over forEachMatch offsets
+        auto replaceAll = [&document](std::string_view replacement)
+        {
+            std::string expected;
+            size_t copied = 0;
+            ScanReport report;
+            EmailScanner::forEachMatch(document, report, [&](size_t start, size_t end)
+                                       {
+                                           expected.append(document, copied, start - copied);
+                                           expected.append(replacement.empty() ? std::string(end - start, '#')
+                                                                               : std::string(replacement));
+                                           copied = end;
+                                           return true; });
+            expected.append(document, copied, std::string::npos);
+            return expected;
         };
 
-        const int numThreads = std::thread::hardware_concurrency();
-        const int iterationsPerThread = 100000;
+        RedactionPolicy token;
+        std::string redacted;
+        ScanReport report;
+        EmailScanner::redact(document, redacted, token, report);
+        check(redacted == replaceAll("[EMAIL]") && report.emailsFound == 430 && !report.wasTruncated(),
+              "Token redaction matches find/replace over the scan (" + std::to_string(report.emailsFound) +
+                  " addresses)");
+
+        RedactionPolicy mask;
+        mask.mode = RedactionMode::MASK;
+        mask.maskChar = '#';
+        std::string masked;
+        EmailScanner::redact(document, masked, mask);
+        check(masked == replaceAll("") && masked.size() == document.size(), "Masking keeps every offset");
+
+        RedactionPolicy hash;
+        hash.mode = RedactionMode::HASH;
+        std::string first;
+        std::string second;
+        EmailScanner::redact("from Alice@Example.COM today", first, hash);
+        EmailScanner::redact("from Alice@example.com today", second, hash);
+        std::string other;
+        EmailScanner::redact("from alice@example.com today", other, hash);
+        check(first == second && first != other && first.size() == std::string("from  today").size() + 6 + 16 &&
+                  first.compare(0, 11, "from email:") == 0,
+              "Hash pseudonyms ignore domain case only: " + first);
+
+        const PseudonymKey referenceKey{0x0706050403020100ULL, 0x0f0e0d0c0b0a0908ULL};
+        const char referenceMessage[15] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14};
+        check(EmailPseudonymizer::siphash24(referenceKey, referenceMessage, 0) == 0x726fdb47dd0e0e31ULL &&
+                  EmailPseudonymizer::siphash24(referenceKey, referenceMessage, 15) == 0xa129ca6149be45e5ULL &&
+                  PseudonymKey::fromHex("000102030405060708090a0b0c0d0e0f").k1 == referenceKey.k1,
+              "SipHash-2-4 matches the reference vectors");
+
+        const EmailPseudonymizer tenantA(referenceKey);
+        const EmailPseudonymizer tenantB(PseudonymKey::fromHex("f0e0d0c0b0a090807060504030201000"));
+        check(tenantA.pseudonym("Bob@Example.org") == tenantA.pseudonym("Bob@example.org") &&
+                  tenantA.pseudonym("Bob@example.org") != tenantA.pseudonym("bob@example.org") &&
+                  tenantA.pseudonym("Bob@example.org") != tenantB.pseudonym("Bob@example.org") &&
+                  tenantA.pseudonym("Bob@example.org").size() == 5 + 16,
+              "Pseudonyms are stable per tenant key and differ across tenants: " + tenantA.pseudonym("Bob@example.org"));
+
+        RedactionPolicy pseudonyms;
+        pseudonyms.mode = RedactionMode::PSEUDONYM;
+        pseudonyms.pseudonymizer = &tenantA;
+        std::string uncached;
+        EmailScanner::redact(document, uncached, pseudonyms);
+
+        // 256 slots for 430 distinct addresses, each seen by 4 threads: hits, misses and evictions
+        const EmailPseudonymizer cachedA(referenceKey, "user:", 256);
+        RedactionPolicy cachedPolicy = pseudonyms;
+        cachedPolicy.pseudonymizer = &cachedA;
+        std::vector<std::string> threadOutputs(4);
+        std::vector<std::thread> workers;
+        for (auto &output : threadOutputs)
+            workers.emplace_back([&document, &cachedPolicy, &output]()
+                                 { EmailScanner::redact(document, output, cachedPolicy); });
+        for (auto &worker : workers)
+            worker.join();
+        const auto cacheStats = cachedA.getCacheStats();
+        check(std::all_of(threadOutputs.begin(), threadOutputs.end(), [&uncached](const std::string &output)
+                          { return output == uncached; }) &&
+                  cacheStats.hits > 0 && cacheStats.hits + cacheStats.misses == 4 * 430,
+              "Shared pseudonym cache gives uncached results on 4 threads (" + std::to_string(cacheStats.hits) +
+                  " hits, " + std::to_string(cacheStats.misses) + " misses)");
+
+        ScanReport pseudonymReport;
+        const auto extracted = EmailScanner::extract(document);
+        const auto pseudonymized = EmailScanner::extractPseudonyms(document, pseudonymReport, cachedA);
+        bool mapped = extracted.size() == pseudonymized.size() && !extracted.empty();
+        for (size_t i = 0; mapped && i < extracted.size(); ++i)
+            mapped = pseudonymized[i] == tenantA.pseudonym(extracted[i]);
+        check(mapped, "extractPseudonyms() maps each extracted address to its pseudonym");
+
+        RedactionPolicy shape;
+        shape.mode = RedactionMode::SHAPE;
+        std::string shaped;
+        EmailScanner::redact("to john.doe@example.com, first.middle.last@mail.corp.example.co.uk and "
+                             "\"j doe\"@x-y.org.",
+                             shaped, shape);
+        std::string shapedDocument = document;
+        EmailScanner::redactInPlace(shapedDocument, shape, report);
+        check(shaped == "to j***.d**@e******.com, f****.m*****.l***@m***.c***.e******.c*.uk and \"j****\"@x**.org." &&
+                  shapedDocument.size() == document.size() && report.emailsFound == 430,
+              "Shape masking keeps length, delimiters, segment starts and the TLD: " + shaped.substr(3, 20));
+
+        std::string oneByte;
+        EmailScanner::redact("a@b.co x.y@z.io \"q\"@d.org ab@cd.com", oneByte, shape);
+        check(oneByte == "*@*.co *.*@*.io \"*\"@*.org a*@c*.com",
+              "Shape masks one-byte segments and labels instead of passing them through: " + oneByte);
+
+        std::string inPlace = document;
+        RedactionPolicy shortToken;
+        shortToken.token = "<e>";
+        EmailScanner::redactInPlace(inPlace, shortToken, report);
+        std::string outOfPlace;
+        EmailScanner::redact(document, outOfPlace, shortToken);
+        check(inPlace == outOfPlace && report.emailsFound == 430, "In-place redaction equals the copying one");
+
+        std::string tight = "to a@b.co and someone.long@example.org";
+        EmailScanner::redactInPlace(tight, token, report);
+        check(tight == "to ****** and [EMAIL]", "In place, a match shorter than the token is masked: " + tight);
+
+        std::string expected;
+        EmailScanner::redact(document, expected, token);
+        bool streamsMatch = true;
+        for (size_t chunkSize : {1u, 7u, 4096u, 1u << 20})
+        {
+            EmailStreamRedactor stream(token, EmailStreamRedactor::MIN_WINDOW_SIZE);
+            std::string output;
+            auto sink = [&output](std::string_view piece)
+            { output.append(piece); };
+
+            for (size_t pos = 0; pos < document.size(); pos += chunkSize)
+                stream.feed(std::string_view(document).substr(pos, chunkSize), sink);
+            stream.finish(sink);
+            streamsMatch = streamsMatch && output == expected && stream.getReport().emailsFound == 430;
+        }
+        check(streamsMatch, "Stream redaction in 1, 7, 4096 and 1M byte chunks equals one-shot redaction");
+
+        EmailStreamRedactor lines(token);
+        std::string early;
+        auto collect = [&early](std::string_view piece)
+        { early.append(piece); };
+        lines.feed("login x@y.com ok\npartial z@w", collect);
+        const bool flushed = lines.flushLines(collect);
+        const std::string settled = early;
+        lines.feed(".org done\n", collect);
+        lines.finish(collect);
+        check(flushed && settled == "login [EMAIL] ok\n" && early == "login [EMAIL] ok\npartial [EMAIL] done\n",
+              "flushLines() releases complete lines and keeps the partial one whole");
+
+        // Addresses alone add up to well over MAX_TOTAL_CHARS_SCANNED
+        std::string crowded;
+        std::string crowdedExpected;
+        for (int i = 0; i < 100000; ++i)
+        {
+            crowded += "user" + std::to_string(i) + "@host" + std::to_string(i % 97) + ".example.com ";
+            crowdedExpected += "[EMAIL] ";
+        }
+        std::string crowdedRedacted;
+        EmailScanner::redact(crowded, crowdedRedacted, token, report);
+        std::string crowdedInPlace = crowded;
+        ScanReport inPlaceReport;
+        EmailScanner::redactInPlace(crowdedInPlace, token, inPlaceReport);
+        check(crowdedRedacted == crowdedExpected && crowdedInPlace == crowdedExpected &&
+                  report.emailsFound == 100000 && !report.wasTruncated() && !inPlaceReport.wasTruncated(),
+              "All 100000 addresses in " + std::to_string(crowded.size()) + " bytes redacted, none left");
+
+        EmailStreamRedactor wide(token, 4 * 1024 * 1024);
+        std::string wideOutput;
+        auto wideSink = [&wideOutput](std::string_view piece)
+        { wideOutput.append(piece); };
+        for (size_t pos = 0; pos < crowded.size(); pos += 64 * 1024)
+            wide.feed(std::string_view(crowded).substr(pos, 64 * 1024), wideSink);
+        wide.finish(wideSink);
+        check(wideOutput == crowdedExpected && wide.getWindowSize() == EmailStreamRedactor::MAX_WINDOW_SIZE,
+              "A 4M stream window is clamped to one redaction pass and redacts every address");
+
+        EmailStreamRedactor flooded(token, EmailStreamRedactor::MAX_WINDOW_SIZE);
+        std::string floodedOutput;
+        auto floodedSink = [&floodedOutput](std::string_view piece)
+        { floodedOutput.append(piece); };
+        flooded.feed("lead a@b.co\n" + std::string(200 * 1024, '@') + "\ntail c@d.co", floodedSink);
+        flooded.finish(floodedSink);
+        check(floodedOutput == "lead [EMAIL]" && flooded.getReport().wasTruncated(),
+              "A truncated window fails closed: nothing after the last redacted address is written");
+
+#if defined(__linux__)
+        const auto inputPath = std::filesystem::temp_directory_path() / "email_detector_redact_in.txt";
+        const auto outputPath = std::filesystem::temp_directory_path() / "email_detector_redact_out.txt";
+        std::ofstream(inputPath, std::ios::binary) << document;
+
+        RedactConfig filterConfig;
+        filterConfig.blockSize = 4096;
+        const int in = ::open(inputPath.c_str(), O_RDONLY);
+        const int out = ::open(outputPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        std::ostringstream filterErrors;
+        const int status = in >= 0 && out >= 0 ? RedactFilter(filterConfig, filterErrors).run(in, out) : -1;
+        if (in >= 0)
+            ::close(in);
+        if (out >= 0)
+            ::close(out);
+
+        std::ifstream written(outputPath, std::ios::binary);
+        const std::string filtered((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>());
+        check(status == 0 && filtered == expected && filterErrors.str().empty(),
+              "redact filter writes the one-shot redaction through 4K blocks and writev()");
+
+        std::ofstream(inputPath, std::ios::binary) << "lead a@b.co\n" << std::string(200 * 1024, '@') << "\ntail c@d.co";
+        const int floodIn = ::open(inputPath.c_str(), O_RDONLY);
+        const int floodOut = ::open(outputPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        std::ostringstream floodErrors;
+        const int floodStatus =
+            floodIn >= 0 && floodOut >= 0 ? RedactFilter(RedactConfig{}, floodErrors).run(floodIn, floodOut) : -1;
+        if (floodIn >= 0)
+            ::close(floodIn);
+        if (floodOut >= 0)
+            ::close(floodOut);
+
+        std::ifstream floodWritten(outputPath, std::ios::binary);
+        const std::string floodFiltered((std::istreambuf_iterator<char>(floodWritten)),
+                                        std::istreambuf_iterator<char>());
+        bool oversizeBlockRejected = false;
+        try
+        {
+            (void)RedactConfig::parse({"--block-size=4M"});
+        }
+        catch (const std::invalid_argument &)
+        {
+            oversizeBlockRejected = true;
+        }
+        check(floodStatus == 1 && floodFiltered == "lead [EMAIL]" && !floodErrors.str().empty() &&
+                  oversizeBlockRejected,
+              "redact filter fails closed with status 1 when limits cut a block; --block-size=4M is rejected");
+        std::filesystem::remove(inputPath);
+        std::filesystem::remove(outputPath);
+#endif
+
+        const std::string binary("no addresses\0\xff here @ all\n", 26);
+        std::string copy;
+        EmailScanner::redact(binary, copy, token);
+        std::string tiny;
+        EmailScanner::redact("x@y", tiny, token);
+        check(copy == binary && tiny == "x@y", "Text without addresses passes through byte for byte");
+
+        check.printSummary();
+    }
+
+    static void runKnownEmailTests()
+    {
+        std::cout << "\n=== KNOWN EMAIL INDEX TESTS ===\n";
+
+        CheckTally check;
+
+        const auto indexPath = std::filesystem::temp_directory_path() / "email_detector_known.idx";
+        constexpr int LISTED = 20000;
+
+        std::stringstream list;
+        for (int i = 0; i < LISTED; ++i)
+            list << "customer" << i << "@Shop" << i % 17 << ".example.com\n";
+        list << "\n  customer7@shop7.example.com\r\nnot an address\ncustomer8@shop8.EXAMPLE.com\n";
+
+        KnownEmailIndexBuilder builder;
+        builder.addLines(list);
+        const KnownEmailIndexBuilder::Summary summary = builder.write(indexPath.string());
+        check(summary.entries == LISTED && summary.duplicates == 2 && summary.invalid == 1 && summary.lines == LISTED + 3,
+              "Builder deduplicates case variants of a domain and skips invalid lines");
+        check(summary.fileBytes == sizeof(KnownEmailIndex::Header) + summary.bucketCount * KnownEmailIndex::BUCKET_BYTES &&
+                  summary.bucketCount * KnownEmailIndex::SLOTS < LISTED * 1.25,
+              "Index holds 64-byte buckets at close to 90% load");
+
+        const KnownEmailFilter filter(indexPath.string());
+        bool allListed = filter.isOpen() && filter.size() == LISTED;
+        for (int i = 0; i < LISTED && allListed; ++i)
+            allListed = filter.contains("customer" + std::to_string(i) + "@shop" + std::to_string(i % 17) + ".example.com");
+        check(allListed, "Every listed address is found after mapping the index");
+
+        check(filter.contains("customer3@SHOP3.Example.COM") && !filter.contains("Customer3@shop3.example.com"),
+              "Domains match case-insensitively, local parts exactly");
+
+        int falsePositives = 0;
+        for (int i = 0; i < 100000; ++i)
+            falsePositives += filter.contains("customer" + std::to_string(i) + "@shop" + std::to_string((i + 1) % 17) +
+                                              ".example.com");
+        check(falsePositives == 0, "No unlisted address is reported as known");
+
+        const std::string text = "from customer5@shop5.example.com to stranger@shop5.example.com, "
+                                 "cc customer6@shop6.example.com.";
+        ScanOptions known;
+        known.knownEmails = &filter;
+        ScanReport report;
+        const std::vector<std::string> found = EmailScanner::extract(text, report, known);
+        check(found == std::vector<std::string>{"customer5@shop5.example.com", "customer6@shop6.example.com"} &&
+                  EmailScanner::extract(text).size() == 3,
+              "ScanOptions::knownEmails reports only listed addresses");
+
+        std::string redacted;
+        ScanReport redactReport;
+        EmailScanner::redact(text, redacted, RedactionPolicy{}, redactReport, known);
+        check(redacted == "from [EMAIL] to stranger@shop5.example.com, cc [EMAIL].",
+              "Redaction with an index leaves unlisted addresses alone");
+
+        KnownEmailIndexBuilder emptyBuilder;
+        const auto emptyPath = std::filesystem::temp_directory_path() / "email_detector_known_empty.idx";
+        emptyBuilder.write(emptyPath.string());
+        const KnownEmailFilter empty(emptyPath.string());
+        check(empty.isOpen() && empty.size() == 0 && !empty.contains("customer5@shop5.example.com"),
+              "An empty list builds an index that matches nothing");
+
+        std::ofstream(emptyPath, std::ios::binary) << "EMLIDX\r\n but not really an index";
+        const KnownEmailFilter corrupt(emptyPath.string());
+        std::ofstream(emptyPath, std::ios::binary) << "plain text";
+        const KnownEmailFilter notIndex(emptyPath.string());
+        const KnownEmailFilter missing((std::filesystem::temp_directory_path() / "email_detector_no_such.idx").string());
+        bool loadThrew = false;
+        try
+        {
+            (void)KnownEmailFilter::load(emptyPath.string());
+        }
+        catch (const std::runtime_error &)
+        {
+            loadThrew = true;
+        }
+        check(!corrupt.isOpen() && !notIndex.isOpen() && !missing.isOpen() && !corrupt.error().empty() &&
+                  !corrupt.contains("customer5@shop5.example.com") && loadThrew,
+              "Truncated, foreign and missing files are rejected, not trusted");
+
+        std::filesystem::remove(indexPath);
+        std::filesystem::remove(emptyPath);
+
+        check.printSummary();
+    }
+
+    static void runDomainRuleTests()
+    {
+        std::cout << "\n=== DOMAIN RULE TESTS ===\n";
+
+        CheckTally check;
+
+        DomainRuleSet ignore;
+        ignore.addRule("ourcompany.com", DomainAction::IGNORE);
+        check(!ignore.shouldReport("ourcompany.com") && !ignore.shouldReport("Mail.OurCompany.COM") &&
+                  ignore.shouldReport("notourcompany.com") && ignore.shouldReport("ourcompany.com.evil.net") &&
+                  ignore.shouldReport("ourcompany.co"),
+              "Ignore rules cover the domain and its subdomains, label by label");
+
+        DomainRuleSet report;
+        report.addRule("competitor.*", DomainAction::REPORT);
+        check(report.shouldReport("competitor.com") && report.shouldReport("competitor.co.uk") &&
+                  report.shouldReport("eu.competitor.de") && !report.shouldReport("competitors.com") &&
+                  !report.shouldReport("competitor") && !report.shouldReport("example.com"),
+              "competitor.* matches under any suffix; only covered domains are reported");
+
+        DomainRuleSet nested;
+        nested.addRule("example.com", DomainAction::IGNORE);
+        nested.addRule("leaks.example.com", DomainAction::REPORT);
+        nested.addRule("*.internal.example.org", DomainAction::IGNORE);
+        nested.addRule("example.*", DomainAction::REPORT);
+        check(nested.match("example.com") == DomainAction::IGNORE &&
+                  nested.match("x.leaks.example.com") == DomainAction::REPORT &&
+                  nested.match("example.net") == DomainAction::REPORT &&
+                  nested.match("internal.example.org") == DomainAction::REPORT &&
+                  nested.match("db.internal.example.org") == DomainAction::IGNORE &&
+                  nested.match("[192.168.1.1]") == DomainAction::NONE,
+              "The most specific rule wins; *.domain covers subdomains only");
+
+        bool rejected = true;
+        for (std::string_view bad : {"", "*", "a..b", "a.*.b", "*", ".com", "com.", "*.*", "ex*ample.com"})
+        {
+            try
+            {
+                nested.addRule(bad, DomainAction::IGNORE);
+                rejected = false;
+            }
+            catch (const std::invalid_argument &)
+            {
+            }
+        }
+        check(rejected, "Malformed patterns are rejected");
+
+        std::stringstream file("# comment\n\n@ourcompany.com\n  partner.org \r\n");
+        DomainRuleSet fromFile;
+        fromFile.addRules(file, DomainAction::IGNORE);
+        check(fromFile.size() == 2 && !fromFile.shouldReport("partner.org") && !fromFile.shouldReport("ourcompany.com"),
+              "Rule files skip comments and blank lines");
+
+        DomainRuleSet large;
+        for (int i = 0; i < 1'000'000; ++i)
+            large.addRule("tenant" + std::to_string(i) + ".example.com", DomainAction::IGNORE);
+        bool allIgnored = true;
+        for (int i = 0; i < 1'000'000 && allIgnored; i += 997)
+            allIgnored = !large.shouldReport("mail.tenant" + std::to_string(i) + ".example.com");
+        check(allIgnored && large.shouldReport("tenant1000000.example.com") && large.shouldReport("example.com") &&
+                  large.memoryBytes() <= 64u << 20,
+              "1M rules fit in a flat table of at most 64 MB");
+
+        const std::string text = "cc bob@ourcompany.com, eve@competitor.io, ann@mail.ourcompany.com and joe@ourcompany.company";
+        ScanOptions options;
+        options.domainRules = &ignore;
+        ScanReport scanReport;
+        check(EmailScanner::extract(text, scanReport, options) ==
+                      std::vector<std::string>{"eve@competitor.io", "joe@ourcompany.company"} &&
+                  (options.domainRules = &report, EmailScanner::extract(text, scanReport, options)) ==
+                      std::vector<std::string>{"eve@competitor.io"},
+              "ScanOptions::domainRules filters extraction");
+
+        check.printSummary();
+    }
+
+    static void runStrictTldTests()
+    {
+        std::cout << "\n=== STRICT TLD TESTS ===\n";
+
+        CheckTally check;
+
+        check(TldTable::size() > 1400 && TldTable::contains("com") && TldTable::contains("COM") &&
+                  TldTable::contains("uk") && TldTable::contains("museum") && TldTable::contains("xn--p1ai") &&
+                  TldTable::contains("xn--vermgensberatung-pwb"),
+              "Root zone TLDs are found, case-insensitively, IDN TLDs as xn--");
+        check(!TldTable::contains("local1") && !TldTable::contains("c0") && !TldTable::contains("") &&
+                  !TldTable::contains("comm") && !TldTable::contains("coo") &&
+                  !TldTable::contains("localhost") && !TldTable::contains("xn--vermgensberatung-pwbx"),
+              "Made-up TLDs miss");
+
+        const std::string text = "user@host.local1, a@b.c0, ok@example.COM, bob@localhost, "
+                                 "and x@sub.example.co.uk";
+        ScanOptions strict;
+        strict.strictTld = true;
+        ScanReport report;
+        const std::vector<std::string> kept = EmailScanner::extract(text, report, strict);
+        const std::vector<std::string> loose = EmailScanner::extract(text);
+        check(kept == std::vector<std::string>{"ok@example.COM", "x@sub.example.co.uk"} &&
+                  std::find(loose.begin(), loose.end(), "user@host.local1") != loose.end() &&
+                  std::find(loose.begin(), loose.end(), "a@b.c0") != loose.end(),
+              "strictTld drops candidates with unknown TLDs; the default keeps them");
+
+        std::vector<std::string> streamed;
+        EmailStreamScanner stream(EmailStreamScanner::DEFAULT_WINDOW_SIZE, strict);
+        for (size_t i = 0; i < text.size(); i += 7)
+            stream.feed(std::string_view(text).substr(i, 7), [&](std::string_view email, uint64_t)
+                        { streamed.emplace_back(email); });
+        stream.finish([&](std::string_view email, uint64_t)
+                      { streamed.emplace_back(email); });
+        check(streamed == kept, "The stream scanner applies strictTld across chunk boundaries");
+
+        std::string redacted;
+        EmailScanner::redact("mail a@b.c0 or c@d.io", redacted, RedactionPolicy{}, report, strict);
+        check(redacted == "mail a@b.c0 or [EMAIL]", "Strict redaction leaves unknown-TLD candidates alone");
+
+        check.printSummary();
+    }
+
+    static void runDomainCacheTests()
+    {
+        std::cout << "\n=== DOMAIN CACHE TESTS ===\n";
 
-        std::cout << "Configuration:\n";
-        std::cout << "  Threads: " << numThreads << "\n";
-        std::cout << "  Iterations per thread: " << iterationsPerThread << "\n";
-        std::cout << "  Test cases: " << testCases.size() << "\n";
-        std::cout << "  Total operations per method: "
-                  << (numThreads * iterationsPerThread * testCases.size()) << "\n\n";
+        CheckTally check;
 
-        // ============================================================================
-        // BENCHMARK 1: isValid() - Exact Email Validation
-        // ============================================================================
-        std::cout << std::string(100, '-') << "\n";
-        std::cout << "BENCHMARK 1: isValid() - Exact Email Validation\n";
-        std::cout << std::string(100, '-') << "\n";
+        const std::vector<std::string> domains = {
+            "gmail.com", "outlook.com", "example.co.uk", "-bad.com", "bad-.com", "a..b", ".com", "com.",
+            "x", "host.local1", "b.c0", "[192.168.1.1]", "[IPv6:2001:db8::1]", "[300.1.1.1]", "ex_ample.com",
+            "GMAIL.COM", "a-b.c-d.e", std::string(63, 'a') + ".com", std::string(64, 'a') + ".com",
+            "sub." + std::string(60, 'x') + ".example.com"};
 
+        DomainValidationCache cache(64);
+        bool identical = true;
+        for (int round = 0; round < 3; ++round)
         {
-            auto start = std::chrono::high_resolution_clock::now();
-            std::atomic<long long> validCount{0};
-            std::vector<std::thread> threads;
-
-            for (int t = 0; t < numThreads; ++t)
+            for (const std::string &domain : domains)
+                identical &= cache.validate(domain) == DomainPartValidator::validate(domain, 0, domain.size());
+        }
+        check(identical, "Cached results match DomainPartValidator for valid, invalid and IP-literal domains");
+
+        const DomainValidationCache::Stats stats = cache.getStats();
+        check(stats.capacity == 64 && stats.bypassed == 3 * 3 && stats.hits + stats.misses == 3 * (domains.size() - 3) &&
+                  stats.hits >= stats.misses,
+              "Counters split lookups into hits, misses and bypassed long domains");
+        cache.resetStats();
+        check(cache.getStats().hits == 0 && cache.validate("gmail.com") && cache.getStats().hits == 1,
+              "resetStats() zeroes the counters and keeps the entries");
+
+        // Two slots for many domains: entries are overwritten constantly while four threads read them
+        DomainValidationCache tiny(2);
+        std::atomic<bool> threadsIdentical{true};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, t]()
+                                 {
+                for (int i = 0; i < 20000; ++i)
+                {
+                    const std::string &domain = domains[static_cast<size_t>(i * 7 + t) % domains.size()];
+                    if (tiny.validate(domain) != DomainPartValidator::validate(domain, 0, domain.size()))
+                        threadsIdentical.store(false);
+                } });
+        }
+        for (auto &thread : threads)
+            thread.join();
+        check(threadsIdentical.load() && tiny.getStats().misses > 0,
+              "Concurrent readers and writers never see a torn entry");
+
+        const auto corpus = EmailBenchmark::defaultCorpus();
+        DomainValidationCache shared;
+        ScanOptions cached;
+        cached.domainCache = &shared;
+        bool sameMatches = true;
+        for (int round = 0; round < 2; ++round)
+        {
+            for (const auto &text : corpus)
             {
-                threads.emplace_back(
-                    [&testCases, &validCount, iterationsPerThread]()
-                    {
-                        EmailValidator localValidator;
-                        long long localValid = 0;
-
-                        for (int i = 0; i < iterationsPerThread; ++i)
-                        {
-                            for (const auto &test : testCases)
-                            {
-                                if (localValidator.isValid(test))
-                                {
-                                    ++localValid;
-                                }
-                            }
-                        }
-
-                        validCount.fetch_add(localValid, std::memory_order_relaxed);
-                    });
+                ScanReport report;
+                sameMatches &= EmailScanner::extract(text, report, cached) == EmailScanner::extract(text);
             }
+        }
+        check(sameMatches && shared.getStats().hits > 0, "extract() finds the same addresses with the cache");
 
-            for (auto &thread : threads)
-            {
-                thread.join();
-            }
+        check.printSummary();
+    }
 
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    static void runValidationCacheTests()
+    {
+        std::cout << "\n=== VALIDATION CACHE TESTS ===\n";
 
-            long long totalOps = static_cast<long long>(numThreads) * iterationsPerThread * testCases.size();
+        CheckTally check;
 
-            std::cout << "Time: " << duration.count() << " ms\n";
-            std::cout << "Operations: " << totalOps << "\n";
-            std::cout << "Throughput: " << (totalOps * 1000 / duration.count()) << " ops/sec\n";
-            std::cout << "Valid emails found: " << validCount.load() << "\n";
-            std::cout << "Avg latency: " << (duration.count() * 1000000.0 / totalOps) << " ns/op\n\n";
-        }
+        const std::vector<std::string> addresses = {
+            "a@b.co", "user@example.com", "first.last@subdomain.example.co.uk", "\"john doe\"@example.com",
+            "\"a\"@b.co", "user@[192.168.1.1]", "u@[1.1.1.1]", "user@[IPv6:2001:db8::1]", "user@[300.1.1.1]",
+            "user..name@example.com", "user@-bad.example.com", "no-at-sign.example.com", "user@@example.com",
+            "\"unterminated@example.com", std::string(64, 'a') + "@example.com", std::string(65, 'a') + "@example.com",
+            "user@" + std::string(250, 'x') + ".com", std::string(330, 'a') + "@example.com", "user+tag@example.org"};
 
-        // ============================================================================
-        // BENCHMARK 2: contains() - Fast Email Detection
-        // ============================================================================
-        std::cout << std::string(100, '-') << "\n";
-        std::cout << "BENCHMARK 2: contains() - Fast Email Detection\n";
-        std::cout << std::string(100, '-') << "\n";
+        ValidationResultCache cache(256);
+        bool identical = true;
+        for (int round = 0; round < 3; ++round)
+        {
+            for (const std::string &address : addresses)
+                identical &= cache.isValid(address) == EmailValidator::isValid(address);
+        }
+        check(identical, "Cached results match isValid for valid, invalid, quoted and IP-literal addresses");
 
+        // Short unquoted addresses bypass; "a"@b.co and u@[1.1.1.1] are short but cached
+        size_t bypassedPerRound = 0;
+        for (const std::string &address : addresses)
+        {
+            const bool slowForm = address.front() == '"' || address.back() == ']';
+            if ((address.size() < cache.getMinLength() && !slowForm) ||
+                address.size() > ValidationResultCache::MAX_CACHED_LENGTH)
+                ++bypassedPerRound;
+        }
+        const ValidationResultCache::Stats stats = cache.getStats();
+        check(bypassedPerRound > 0 && stats.bypassed == 3 * bypassedPerRound &&
+                  stats.misses == addresses.size() - bypassedPerRound &&
+                  stats.hits == 2 * (addresses.size() - bypassedPerRound),
+              "Short addresses bypass, quoted and IP-literal ones are cached at any length");
+        cache.resetStats();
+        check(cache.getStats().hits == 0 && cache.isValid("user@example.com") && cache.getStats().hits == 1,
+              "resetStats() zeroes the counters and keeps the entries");
+
+        // One bucket: an address hit between insertions is never the CLOCK victim
+        ValidationResultCache single(ValidationResultCache::WAYS);
+        const std::string hot = "hot.address@example.com";
+        (void)single.isValid(hot);
+        bool hotKept = true;
+        for (int i = 0; i < 20; ++i)
         {
-            auto start = std::chrono::high_resolution_clock::now();
-            std::atomic<long long> foundCount{0};
-            std::vector<std::thread> threads;
+            (void)single.isValid("cold" + std::to_string(i) + "@example.com");
+            hotKept &= single.isValid(hot);
+        }
+        const ValidationResultCache::Stats singleStats = single.getStats();
+        check(singleStats.capacity == ValidationResultCache::WAYS && hotKept && singleStats.hits == 20 &&
+                  singleStats.evictions == 20 - (ValidationResultCache::WAYS - 1),
+              "CLOCK eviction keeps referenced entries and counts evictions");
+
+        // Two buckets for many addresses: ways are replaced constantly while four threads read them
+        ValidationResultCache tiny(2 * ValidationResultCache::WAYS, 0);
+        std::atomic<bool> threadsIdentical{true};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, t]()
+                                 {
+                for (int i = 0; i < 20000; ++i)
+                {
+                    const std::string &address = addresses[static_cast<size_t>(i * 7 + t) % addresses.size()];
+                    if (tiny.isValid(address) != EmailValidator::isValid(address))
+                        threadsIdentical.store(false);
+                } });
+        }
+        for (auto &thread : threads)
+            thread.join();
+        check(threadsIdentical.load() && tiny.getStats().evictions > 0,
+              "Concurrent lookups and evictions always return the validator's result");
+
+        auto shared = std::make_shared<ValidationResultCache>();
+        EmailValidationService first = EmailServiceFactory::createValidationService(shared);
+        EmailValidationService second = EmailServiceFactory::createValidationService(shared);
+        bool sameResults = true;
+        for (const std::string &address : addresses)
+            sameResults &= first.validate(address) == EmailValidator::isValid(address) &&
+                           second.validate(address) == EmailValidator::isValid(address);
+        check(sameResults && first.getCache() == shared.get() && shared->getStats().hits > 0 &&
+                  first.getStats().getValidationCount() == addresses.size(),
+              "Services given one cache share its results and keep their own statistics");
+
+        check.printSummary();
+    }
 
-            for (int t = 0; t < numThreads; ++t)
-            {
-                threads.emplace_back(
-                    [&testCases, &foundCount, iterationsPerThread]()
-                    {
-                        EmailScanner localScanner;
-                        long long localFound = 0;
+    static void runDocumentCacheTests()
+    {
+        std::cout << "\n=== DOCUMENT CACHE TESTS ===\n";
 
-                        for (int i = 0; i < iterationsPerThread; ++i)
-                        {
-                            for (const auto &test : testCases)
-                            {
-                                if (localScanner.contains(test))
-                                {
-                                    ++localFound;
-                                }
-                            }
-                        }
+        CheckTally check;
 
-                        foundCount.fetch_add(localFound, std::memory_order_relaxed);
-                    });
-            }
+        const std::string padding(300, ' ');
+        const std::vector<std::string> documents = {
+            "Hi team, please contact john.doe@example.com or jane@corp.example.org." + padding,
+            "Nothing to see here, just a long status line without any address at all." + padding,
+            "@Override\npublic void run() { log(\"@handle\"); } // user@localhost, a@b.c0" + padding,
+            "Reply to \"quoted person\"@example.com or admin@[192.168.1.1] today." + padding,
+            padding + "tail.address@example.net"};
+
+        auto sameReport = [](const ScanReport &a, const ScanReport &b)
+        {
+            return a.bytesScanned == b.bytesScanned && a.emailsFound == b.emailsFound &&
+                   a.rejectedOversize == b.rejectedOversize && a.truncatedBy == b.truncatedBy;
+        };
 
-            for (auto &thread : threads)
+        DocumentResultCache cache;
+        bool identical = true;
+        for (int round = 0; round < 3; ++round)
+        {
+            for (const std::string &document : documents)
             {
-                thread.join();
+                ScanReport cachedReport;
+                ScanReport report;
+                identical &= cache.extract(document, cachedReport) == EmailScanner::extract(document, report) &&
+                             sameReport(cachedReport, report);
             }
+        }
+        const DocumentResultCache::Stats stats = cache.getStats();
+        size_t documentBytes = 0;
+        for (const std::string &document : documents)
+            documentBytes += document.size();
+        check(identical && stats.misses == documents.size() && stats.hits == 2 * documents.size() &&
+                  stats.bytesSaved == 2 * documentBytes && stats.entries == documents.size(),
+              "Repeated documents return the same addresses and report, and count the bytes not scanned");
+
+        const std::string shortDocument = "short note to a@example.com";
+        ScanReport report;
+        (void)cache.extract(shortDocument, report);
+        (void)cache.extract(std::string(EmailScanner::getMaxInputSize() + 1, 'a'), report);
+        check(shortDocument.size() < cache.getMinBytes() && cache.getStats().bypassed == 2 &&
+                  cache.getStats().entries == documents.size(),
+              "Documents below minBytes or over MAX_INPUT_SIZE are scanned directly");
+
+        ScanOptions strict;
+        strict.strictTld = true;
+        ScanReport strictReport;
+        check(cache.extract(documents[2], strictReport, strict) ==
+                      EmailScanner::extract(documents[2], report, strict) &&
+                  cache.extract(documents[2], report) != cache.extract(documents[2], strictReport, strict),
+              "ScanOptions that change results are part of the key");
+
+        DomainRuleSet rules;
+        rules.addRule("example.org", DomainAction::IGNORE);
+        ScanOptions filtered;
+        filtered.domainRules = &rules;
+        const auto beforeRule = cache.extract(documents[0], report, filtered);
+        rules.addRule("example.com", DomainAction::IGNORE);
+        const auto afterRule = cache.extract(documents[0], report, filtered);
+        DomainRuleSet otherRules;
+        check(beforeRule == std::vector<std::string>{"john.doe@example.com"} && afterRule.empty() &&
+                  afterRule == EmailScanner::extract(documents[0], report, filtered) &&
+                  otherRules.generation() != rules.generation(),
+              "addRule() after caching changes the key instead of serving the old result");
+
+        DocumentResultCache expiring(64, 1024 * 1024, std::chrono::milliseconds(1));
+        (void)expiring.extract(documents[0], report);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        const bool stillCorrect = expiring.extract(documents[0], report) == EmailScanner::extract(documents[0], report);
+        check(stillCorrect && expiring.getStats().hits == 0 && expiring.getStats().misses == 2 &&
+                  expiring.getStats().expirations == 1 && expiring.getStats().entries == 1,
+              "Entries older than the TTL are misses and get replaced");
+
+        // Eight entries per shard but bytes for about two results: the byte budget binds first
+        DocumentResultCache bounded(DocumentResultCache::SHARDS * 8, DocumentResultCache::SHARDS * 256);
+        for (int i = 0; i < 200; ++i)
+            (void)bounded.extract(std::to_string(i) + documents[static_cast<size_t>(i) % documents.size()], report);
+        const DocumentResultCache::Stats boundedStats = bounded.getStats();
+        check(boundedStats.entries < boundedStats.capacity &&
+                  boundedStats.resultBytes <= DocumentResultCache::SHARDS * 256 && boundedStats.evictions > 0,
+              "Entry and result-byte budgets are enforced by eviction");
+
+        std::atomic<bool> threadsIdentical{true};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, t]()
+                                 {
+                ScanReport local;
+                for (int i = 0; i < 2000; ++i)
+                {
+                    const std::string document =
+                        std::to_string((i * 7 + t) % 40) + documents[static_cast<size_t>(i) % documents.size()];
+                    if (bounded.extract(document, local) != EmailScanner::extract(document, local))
+                        threadsIdentical.store(false);
+                } });
+        }
+        for (auto &thread : threads)
+            thread.join();
+        check(threadsIdentical.load(), "Concurrent lookups, stores and evictions return the scanner's result");
+
+        auto shared = std::make_shared<DocumentResultCache>();
+        EmailScannerService cachedService = EmailServiceFactory::createScannerService(shared);
+        EmailScannerService plainService;
+        bool sameResults = true;
+        for (int round = 0; round < 2; ++round)
+        {
+            for (const std::string &document : documents)
+                sameResults &= cachedService.extract(document) == plainService.extract(document) &&
+                               cachedService.contains(document) == plainService.contains(document);
+        }
+        const auto &cachedStats = cachedService.getStats();
+        const auto &plainStats = plainService.getStats();
+        check(sameResults && cachedService.getCache() == shared.get() && shared->getStats().hits == documents.size() &&
+                  cachedStats.getEmailsFound() == plainStats.getEmailsFound() &&
+                  cachedStats.getBytesScanned() == plainStats.getBytesScanned(),
+              "A service with the cache keeps the same results and statistics");
+
+        check.printSummary();
+    }
 
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-
-            long long totalOps = static_cast<long long>(numThreads) * iterationsPerThread * testCases.size();
+    static void runAllocationTests()
+    {
+        std::cout << "\n=== ALLOCATION TESTS ===\n";
 
-            std::cout << "Time: " << duration.count() << " ms\n";
-            std::cout << "Operations: " << totalOps << "\n";
-            std::cout << "Throughput: " << (totalOps * 1000 / duration.count()) << " ops/sec\n";
-            std::cout << "Texts with emails: " << foundCount.load() << "\n";
-            std::cout << "Avg latency: " << (duration.count() * 1000000.0 / totalOps) << " ns/op\n\n";
+        if (!AllocationTracker::isAvailable())
+        {
+            std::cout << "Skipped: built with EMAIL_DETECTOR_NO_ALLOCATION_HOOKS\n"
+                      << std::endl;
+            return;
         }
 
-        // ============================================================================
-        // BENCHMARK 3: extract() - Full Email Extraction
-        // ============================================================================
-        std::cout << std::string(100, '-') << "\n";
-        std::cout << "BENCHMARK 3: extract() - Full Email Extraction\n";
-        std::cout << std::string(100, '-') << "\n";
+        CheckTally check;
 
+        auto countAllocations = [](auto &&operation)
         {
-            auto start = std::chrono::high_resolution_clock::now();
-            std::atomic<long long> extractedCount{0};
-            std::vector<std::thread> threads;
-
-            for (int t = 0; t < numThreads; ++t)
-            {
-                threads.emplace_back(
-                    [&testCases, &extractedCount, iterationsPerThread]()
-                    {
-                        EmailScanner localScanner;
-                        long long localExtracted = 0;
+            AllocationTracker::Scope tracking;
+            const auto before = AllocationTracker::getThreadCounts();
+            operation();
+            return AllocationTracker::getThreadCounts() - before;
+        };
 
-                        for (int i = 0; i < iterationsPerThread; ++i)
-                        {
-                            for (const auto &test : testCases)
-                            {
-                                auto emails = localScanner.extract(test);
-                                localExtracted += emails.size();
-                            }
-                        }
+        const auto corpus = EmailBenchmark::defaultCorpus();
+        EmailValidationService validator;
+        EmailScannerService scanner;
 
-                        extractedCount.fetch_add(localExtracted, std::memory_order_relaxed);
-                    });
-            }
+        auto counts = countAllocations([&]()
+                                       {
+            for (const auto &text : corpus)
+                (void)validator.validate(text); });
+        check(counts.allocations == 0, "isValid() allocates nothing (" + std::to_string(counts.allocations) + ")");
 
-            for (auto &thread : threads)
+        counts = countAllocations([&]()
+                                  {
+            for (const auto &text : corpus)
             {
-                thread.join();
-            }
+                (void)EmailScanner::contains(text);
+                (void)scanner.contains(text);
+            } });
+        check(counts.allocations == 0, "contains() allocates nothing (" + std::to_string(counts.allocations) + ")");
+
+        DomainRuleSet rules;
+        rules.addRule("example.com", DomainAction::IGNORE);
+        rules.addRule("competitor.*", DomainAction::REPORT);
+        ScanOptions filtered;
+        filtered.domainRules = &rules;
+        counts = countAllocations([&]()
+                                  {
+            ScanReport report;
+            for (const auto &text : corpus)
+                EmailScanner::forEachMatch(text, report, [](size_t, size_t) { return true; }, filtered); });
+        check(counts.allocations == 0,
+              "Domain rule matching allocates nothing (" + std::to_string(counts.allocations) + ")");
+
+        EmailStreamScanner stream;
+        const std::string chunk = EmailBenchmark::joinCorpus(corpus);
+        stream.feed(chunk, [](std::string_view, uint64_t) {});
+        counts = countAllocations([&]()
+                                  {
+            for (int i = 0; i < 16; ++i)
+                stream.feed(chunk, [](std::string_view, uint64_t) {}); });
+        check(counts.allocations == 0,
+              "EmailStreamScanner::feed() allocates nothing once warm (" + std::to_string(counts.allocations) + ")");
+
+        // extract() pays for its result vector and seen-set buckets even when nothing matches
+        const std::string noEmails = "plain log line with a near miss @Override and no addresses";
+        counts = countAllocations([&]()
+                                  { (void)EmailScanner::extract(noEmails); });
+        check(counts.allocations <= 2,
+              "extract() without matches: " + std::to_string(counts.allocations) + " allocations (limit 2)");
+
+        // Addresses longer than the small-string buffer: one copy for the result, one for the
+        // seen set plus its node, and a result-vector regrowth (capacity grows one at a time)
+        static constexpr size_t EMAILS = 200;
+        std::string document;
+        for (size_t i = 0; i < EMAILS; ++i)
+            document += "contact firstname.lastname" + std::to_string(i) + "@mail.example.com, ";
+
+        std::vector<std::string> extracted;
+        counts = countAllocations([&]()
+                                  { extracted = EmailScanner::extract(document); });
+        const double perEmail = static_cast<double>(counts.allocations) / EMAILS;
+        check(extracted.size() == EMAILS && perEmail <= 4.0,
+              "extract() of " + std::to_string(EMAILS) + " long emails: " + std::to_string(perEmail) +
+                  " allocations/email, " + std::to_string(counts.bytes / EMAILS) + " bytes/email (limit 4)");
+
+        check.printSummary();
+    }
+
+    static void runScanPipelineTests()
+    {
+        std::cout << "\n=== SCAN PIPELINE TESTS ===\n";
 
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        CheckTally check;
 
-            long long totalOps = static_cast<long long>(numThreads) * iterationsPerThread * testCases.size();
+        // Emails land on and around every 4 KiB chunk cut
+        std::string document;
+        std::vector<uint64_t> expectedOffsets;
+        for (int i = 0; document.size() < 64 * 1024; ++i)
+        {
+            document += std::string(4096 - (i % 40) - 12, 'x') + ' ';
+            expectedOffsets.push_back(document.size());
+            document += "u" + std::to_string(i) + "@cut.example.com";
+            document += (i % 3 == 0) ? "\n" : " \"q\\\"";
+        }
 
-            std::cout << "Time: " << duration.count() << " ms\n";
-            std::cout << "Operations: " << totalOps << "\n";
-            std::cout << "Throughput: " << (totalOps * 1000 / duration.count()) << " ops/sec\n";
-            std::cout << "Emails extracted: " << extractedCount.load() << "\n";
-            std::cout << "Avg latency: " << (duration.count() * 1000000.0 / totalOps) << " ns/op\n\n";
+        const auto path = std::filesystem::temp_directory_path() / "email_detector_scan_test.txt";
+        {
+            std::ofstream file(path, std::ios::binary);
+            file << document;
         }
 
-        // ============================================================================
-        // BENCHMARK 4: Combined Workload (Real-world scenario)
-        // ============================================================================
-        std::cout << std::string(100, '-') << "\n";
-        std::cout << "BENCHMARK 4: Combined Workload (Real-world)\n";
-        std::cout << std::string(100, '-') << "\n";
+        ScanConfig config;
+        config.inputs = {path.string()};
+        config.threads = 3;
+        config.chunkSize = 4096;
+
+        std::ostringstream out;
+        std::ostringstream err;
+        const int status = ScanPipeline(config, err).run(out);
 
+        std::vector<uint64_t> offsets;
+        std::istringstream lines(out.str());
+        bool wellFormed = true;
+        for (std::string line; std::getline(lines, line);)
         {
-            auto start = std::chrono::high_resolution_clock::now();
-            std::atomic<long long> totalOperations{0};
-            std::vector<std::thread> threads;
+            const size_t at = line.find("\"offset\":");
+            wellFormed = wellFormed && line.front() == '{' && line.back() == '}' && at != std::string::npos;
+            if (at != std::string::npos)
+                offsets.push_back(std::stoull(line.substr(at + 9)));
+        }
 
-            for (int t = 0; t < numThreads; ++t)
+        check(status == 0 && err.str().empty(), "Scan of a readable file succeeds");
+        check(wellFormed && offsets == expectedOffsets,
+              "Every match reported once, in order, with its byte offset (" + std::to_string(offsets.size()) +
+                  " across 4K chunks)");
+
+        config.countOnly = true;
+        config.inputs = {path.string(), path.string() + ".missing"};
+        std::ostringstream counts;
+        std::ostringstream countErr;
+        const int countStatus = ScanPipeline(config, countErr).run(counts);
+        check(counts.str().find("\"count\":" + std::to_string(expectedOffsets.size()) + "}") != std::string::npos &&
+                  counts.str().find("\"total\":" + std::to_string(expectedOffsets.size()) + "}") != std::string::npos,
+              "--count reports per-file and total counts");
+        check(countStatus == 1 && !countErr.str().empty(), "Unreadable input is reported and sets exit status 1");
+
+        check(jsonEscape("\"a\\b\"\n") == "\\\"a\\\\b\\\"\\u000a", "JSON escaping of quotes, backslashes, controls");
+
+        // The document as two concatenated gzip members, split inside an address
+        const auto gzPath = std::filesystem::temp_directory_path() / "email_detector_scan_test.log.gz";
+#ifdef EMAIL_DETECTOR_WITH_ZLIB
+        {
+            std::ofstream file(gzPath, std::ios::binary);
+            const size_t split = expectedOffsets[5] + 3;
+            for (std::string_view member : {std::string_view(document).substr(0, split),
+                                            std::string_view(document).substr(split)})
             {
-                threads.emplace_back(
-                    [&testCases, &totalOperations, iterationsPerThread]()
-                    {
-                        EmailValidator localValidator;
-                        EmailScanner localScanner;
-                        long long localOps = 0;
+                z_stream deflater{};
+                (void)deflateInit2(&deflater, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+                std::string compressed(deflateBound(&deflater, static_cast<uLong>(member.size())), '\0');
+                deflater.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(member.data()));
+                deflater.avail_in = static_cast<uInt>(member.size());
+                deflater.next_out = reinterpret_cast<Bytef *>(compressed.data());
+                deflater.avail_out = static_cast<uInt>(compressed.size());
+                (void)deflate(&deflater, Z_FINISH);
+                file.write(compressed.data(), static_cast<std::streamsize>(deflater.total_out));
+                deflateEnd(&deflater);
+            }
+        }
 
-                        for (int i = 0; i < iterationsPerThread; ++i)
-                        {
-                            for (const auto &test : testCases)
-                            {
-                                // Real-world pattern: check first, extract if found
-                                if (localScanner.contains(test))
-                                {
-                                    auto emails = localScanner.extract(test);
-                                    localOps += emails.size();
-                                }
+        ScanConfig gzConfig;
+        gzConfig.inputs = {gzPath.string()};
+        gzConfig.chunkSize = 4096;
+        std::ostringstream gzOut;
+        std::ostringstream gzErr;
+        const int gzStatus = ScanPipeline(gzConfig, gzErr).run(gzOut);
+        std::vector<uint64_t> gzOffsets;
+        std::istringstream gzLines(gzOut.str());
+        for (std::string line; std::getline(gzLines, line);)
+            gzOffsets.push_back(std::stoull(line.substr(line.find("\"offset\":") + 9)));
+        check(gzStatus == 0 && gzOffsets == expectedOffsets,
+              "gzip input is scanned in uncompressed offsets across members and chunks");
+#else
+        {
+            std::ofstream file(gzPath, std::ios::binary);
+            file << "\x1f\x8b\x08" << std::string(64, '\0');
+        }
 
-                                // Or validate exact emails
-                                if (localValidator.isValid(test))
-                                {
-                                    ++localOps;
-                                }
-                            }
-                        }
+        ScanConfig gzConfig;
+        gzConfig.inputs = {gzPath.string()};
+        std::ostringstream gzOut;
+        std::ostringstream gzErr;
+        const int gzStatus = ScanPipeline(gzConfig, gzErr).run(gzOut);
+        check(gzStatus == 1 && gzErr.str().find("EMAIL_DETECTOR_WITH_ZLIB") != std::string::npos,
+              "gzip input without zlib support is reported, not scanned as raw bytes");
+#endif
+        std::filesystem::remove(gzPath);
 
-                        totalOperations.fetch_add(localOps, std::memory_order_relaxed);
-                    });
-            }
+        std::filesystem::remove(path);
 
-            for (auto &thread : threads)
+        // Tasks spawning tasks: every one runs exactly once and wait() covers the spawned ones
+        {
+            WorkStealingPool pool(4);
+            std::atomic<int> ran{0};
+            std::function<void(int)> spawn = [&](int depth)
             {
-                thread.join();
-            }
+                ran.fetch_add(1, std::memory_order_relaxed);
+                if (depth < 6)
+                {
+                    pool.submit([&, depth]()
+                                { spawn(depth + 1); });
+                    pool.submit([&, depth]()
+                                { spawn(depth + 1); });
+                }
+            };
+            pool.submit([&]()
+                        { spawn(0); });
+            pool.wait();
+            check(ran.load() == 127, "Work-stealing pool runs nested tasks exactly once (" +
+                                         std::to_string(ran.load()) + "/127)");
+        }
 
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        // A tree of small files plus one file large enough to be split into many chunk tasks
+        const auto root = std::filesystem::temp_directory_path() / "email_detector_scan_tree";
+        std::filesystem::remove_all(root);
+        size_t expectedTotal = 0;
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            const auto sub = root / ("d" + std::to_string(dir)) / "nested";
+            std::filesystem::create_directories(sub);
+            for (int f = 0; f < 20; ++f)
+            {
+                std::ofstream file(sub / ("f" + std::to_string(f) + ".log"), std::ios::binary);
+                for (int line = 0; line < f; ++line, ++expectedTotal)
+                    file << "line " << line << " from u" << dir << "_" << f << "@tree.example.org\n";
+            }
+        }
+        {
+            std::ofstream large(root / "large.log", std::ios::binary);
+            large << document;
+            expectedTotal += expectedOffsets.size();
+        }
 
-            long long totalOps = static_cast<long long>(numThreads) * iterationsPerThread * testCases.size();
+        auto scanTree = [&root](size_t threads, bool countOnly, ScanIoBackend io = ScanIoBackend::AUTO)
+        {
+            ScanConfig treeConfig;
+            treeConfig.inputs = {root.string()};
+            treeConfig.threads = threads;
+            treeConfig.chunkSize = 4096;
+            treeConfig.countOnly = countOnly;
+            treeConfig.io = io;
+            std::ostringstream treeOut;
+            std::ostringstream treeErr;
+            (void)ScanPipeline(treeConfig, treeErr).run(treeOut);
+            return treeOut.str();
+        };
 
-            std::cout << "Time: " << duration.count() << " ms\n";
-            std::cout << "Operations: " << totalOps << "\n";
-            std::cout << "Throughput: " << (totalOps * 1000 / duration.count()) << " ops/sec\n";
-            std::cout << "Results produced: " << totalOperations.load() << "\n";
-            std::cout << "Avg latency: " << (duration.count() * 1000000.0 / totalOps) << " ns/op\n\n";
+        const std::string serial = scanTree(1, false);
+        const std::string parallel = scanTree(4, false);
+        check(serial == parallel && !serial.empty(), "Recursive scan output is identical with 1 and 4 threads");
+        check(static_cast<size_t>(std::count(parallel.begin(), parallel.end(), '\n')) == expectedTotal,
+              "Recursive scan finds every email across " + std::to_string(4 * 20 + 1) + " files (" +
+                  std::to_string(expectedTotal) + ")");
+        const std::string treeCounts = scanTree(4, true);
+        check(treeCounts.find("\"files\":81,\"total\":" + std::to_string(expectedTotal)) != std::string::npos &&
+                  treeCounts.find("d0/nested/f0.log") < treeCounts.find("d0/nested/f1.log") &&
+                  treeCounts.find("d3/nested/f9.log") < treeCounts.find("large.log"),
+              "Files are reported in sorted path order");
+
+        const bool uringAvailable = IoUringReader().isAvailable();
+        check(scanTree(2, false, ScanIoBackend::URING) == scanTree(2, false, ScanIoBackend::READ),
+              std::string("io_uring and plain reads give identical output") +
+                  (uringAvailable ? "" : " (io_uring unavailable, both used plain reads)"));
+
+        if (uringAvailable)
+        {
+            auto openDescriptors = []
+            {
+                std::error_code ec;
+                size_t count = 0;
+                for (std::filesystem::directory_iterator it("/proc/self/fd", ec), last; !ec && it != last;
+                     it.increment(ec))
+                    ++count;
+                return count;
+            };
+
+            std::vector<std::string> treeFiles;
+            for (const auto &entry : std::filesystem::recursive_directory_iterator(root))
+                if (entry.is_regular_file())
+                    treeFiles.push_back(entry.path().string());
+            std::vector<const char *> treePaths;
+            for (const std::string &file : treeFiles)
+                treePaths.push_back(file.c_str());
+
+            const size_t descriptorsBefore = openDescriptors();
+            bool readerFailed = false;
+            bool readerRetired = false;
+            {
+                IoUringReader reader;
+                reader.failNextWait();
+                readerFailed = !reader.readFiles(treePaths, [](size_t, std::string_view, int) {});
+                readerRetired = !reader.isAvailable() && !reader.readFiles(treePaths, [](size_t, std::string_view, int) {});
+            }
+            check(readerFailed && readerRetired && openDescriptors() == descriptorsBefore,
+                  "A failed io_uring wait retires the ring and leaves no descriptor open (" +
+                      std::to_string(treePaths.size()) + " opens in flight)");
         }
 
-        std::cout << std::string(100, '=') << "\n";
-        std::cout << "✓ Performance Benchmark Complete\n";
-        std::cout << std::string(100, '=') << "\n\n";
+        std::filesystem::remove_all(root);
+
+        check.printSummary();
+    }
+
+    static void runPerformanceBenchmark(bool withHardwareCounters = false)
+    {
+        BenchmarkConfig config;
+        config.hardwareCounters = withHardwareCounters;
+        (void)EmailBenchmark::run(config, EmailBenchmark::defaultCorpus(), std::cout);
     }
 };
 
@@ -2894,143 +12787,195 @@ public:
 // MAIN
 // ====================================================================================================
 
-int main()
+static void runCorrectnessTests()
 {
-    try
-    {
-        EmailValidatorTest::runExactValidationTests();
-        std::cout << std::string(100, '=') << "\n"
-                  << std::endl;
+    EmailValidatorTest::runExactValidationTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
 
-        EmailValidatorTest::runTextScanningTests();
-        std::cout << std::string(100, '=') << "\n"
-                  << std::endl;
+    EmailValidatorTest::runTextScanningTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
 
-        EmailValidatorTest::runAdversarialTests();
-        std::cout << std::string(100, '=') << "\n"
-                  << std::endl;
+    EmailValidatorTest::runAdversarialTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
 
-        std::cout << "\n"
-                  << std::string(100, '=') << "\n";
-        std::cout << "=== EMAIL DETECTION TEST ===\n";
-        std::cout << std::string(100, '=') << "\n";
-        std::cout << "Testing both exact validation and text scanning\n"
-                  << std::endl;
+    EmailValidatorTest::runComplexityTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
 
-        EmailValidationService validator;
-        EmailScannerService scanner;
+    EmailValidatorTest::runStatisticsTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
 
-        std::vector<std::string> testCases = {
-            "Simple email: user@example.com in text",
-            "Multiple emails: first@domain.com and second@another.org",
-            "user..double@domain.com",
-            "Complex: john.doe+filter@sub.domain.co.uk mixed with text",
-            "No emails in this text at all",
-            "Edge case: a@b.co minimal email",
-            "review-team@geeksforgeeks.org",
-            "user..double@domain.com",
-            "user.@domain.com",
-            "27 age and alpha@gmail.com and other data",
-            "adfdgifldj@fk458439678 4krf8956 346 alpha@gmail.com r90wjk kf433@8958ifdjkks fgkl548765gr",
-            "27 age and alphatyicbnkdleoxkthes123fd56569565@gmail.com and othere data missing...!",
-            "any aged group and alphatyic(b)nkdleoxk%t/hes123fd56569565@gmail.com and othere data missing...!",
-            "27 age and alphatyicbnk.?'.,dleoxkthes123fd56569565@gmail.com and othere data missing...! other@email.co",
-            "27 age and alphatyicbnkdleo$#-=+xkthes123fd56569565@gmail.com and othere data missing...!",
-            "No email here",
-            "test@domain",
-            "invalid@.com",
-            "valid.email+tag@example.co.uk",
-            "Contact us at support@company.com for help",
-            "Multiple: first@test.com, second@demo.org",
-            "invalid@.com and test@domain",
-            std::string(1000, 'x') + "hidden@email.com" + std::string(1000, 'y'),
+    EmailValidatorTest::runStreamScannerTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
 
-            "user@example.com",
-            "a@b.co",
-            "test.user@example.com",
-            "user+tag@gmail.com",
+    EmailValidatorTest::runCorpusGeneratorTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
 
-            "user!test@example.com",
-            "user#tag@example.com",
-            "user$admin@example.com",
-            "user%percent@example.com",
-            "user&name@example.com",
-            "user'quote@example.com",
-            "user*star@example.com",
-            "user=equal@example.com",
-            "user?question@example.com",
-            "user^caret@example.com",
-            "user_underscore@example.com",
-            "user`backtick@example.com",
-            "userbrace@example.com",
-            "user|pipe@example.com",
-            "user}brace@example.com",
-            "user~tilde@example.com",
+    EmailValidatorTest::runBinarySkipTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
 
-            "\"user\"@example.com",
-            "\"user name\"@example.com",
-            "\"user@internal\"@example.com",
-            "\"user.name\"@example.com",
-            "\"user\\\"name\"@example.com",
-            "\"user\\\\name\"@example.com",
+    EmailValidatorTest::runRedactionTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
 
-            "user@[192.168.1.1]",
-            "user@[2001:db8::1]",
-            "test@[10.0.0.1]",
-            "user@[fe80::1]",
-            "user@[::1]",
+    EmailValidatorTest::runKnownEmailTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
 
-            "first.last@sub.domain.co.uk",
-            "user@domain-name.com",
-            "user@123.456.789.012",
-            "user@domain.x",
-            "user@domain.123",
+    EmailValidatorTest::runDomainRuleTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
 
-            "user..double@domain.com",
-            ".user@domain.com",
-            "user.@domain.com",
-            "user@domain..com",
-            "@example.com",
-            "user@",
-            "userexample.com",
-            "user@@example.com",
-            "user@domain",
-            "user@.domain.com",
-            "user@domain.com.",
-            "user@-domain.com",
-            "user@domain-.com",
-            "user name@example.com",
-            "user@domain .com",
-            "\"unclosed@example.com",
-            "\"user\"name@example.com",
-            "user@[192.168.1]",
-            "user@[999.168.1.1]",
-            "user@[192.168.1.256]",
-            "user@[gggg::1]"};
+    EmailValidatorTest::runStrictTldTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
+
+    EmailValidatorTest::runDomainCacheTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
+
+    EmailValidatorTest::runValidationCacheTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
+
+    EmailValidatorTest::runDocumentCacheTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
+
+    EmailValidatorTest::runAllocationTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
+
+    EmailValidatorTest::runScanPipelineTests();
+    std::cout << std::string(100, '=') << "\n"
+              << std::endl;
+}
+
+static void runDetectionDemo()
+{
+    std::cout << "\n"
+              << std::string(100, '=') << "\n";
+    std::cout << "=== EMAIL DETECTION TEST ===\n";
+    std::cout << std::string(100, '=') << "\n";
+    std::cout << "Testing both exact validation and text scanning\n"
+              << std::endl;
+
+    EmailScannerService scanner;
+
+    for (const auto &test : EmailBenchmark::defaultCorpus())
+    {
+        bool found = scanner.contains(test);
+        std::cout << (found ? "SENSITIVE" : "CLEAN    ") << ": \"" << test << "\"" << std::endl;
+
+        if (found)
+        {
+            auto emails = scanner.extract(test);
+            std::cout << "  => Found emails: ";
+            for (const auto &email : emails)
+            {
+                std::cout << email << " ";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << std::endl;
+    }
 
-        for (const auto &test : testCases)
+    std::cout << std::string(100, '=') << std::endl;
+    std::cout << "✓ Email Detection Complete" << std::endl;
+    std::cout << std::string(100, '=') << std::endl;
+}
+
+static void printUsage(std::ostream &out)
+{
+    out << "Usage:\n"
+        << "  EmailDetector                    run tests, detection demo and the default benchmark\n"
+        << "  EmailDetector test               run the correctness tests only\n"
+        << "  EmailDetector bench [options]    run only the benchmark\n"
+        << "  EmailDetector scan [options] [FILE...|-]\n"
+        << "                                   print every email in the inputs as JSON Lines\n"
+        << "  EmailDetector redact [options] < in > out\n"
+        << "                                   copy stdin to stdout with every email redacted\n"
+        << "  EmailDetector index build [options] LIST INDEX\n"
+        << "                                   compile an address list into a known-email index\n\n";
+    BenchmarkConfig::printUsage(out);
+    out << "\n";
+    ScanConfig::printUsage(out);
+    out << "\n";
+    RedactConfig::printUsage(out);
+    out << "\n";
+    IndexConfig::printUsage(out);
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        const std::vector<std::string_view> args(argv + 1, argv + argc);
+
+        if (!args.empty())
         {
-            bool found = scanner.contains(test);
-            std::cout << (found ? "SENSITIVE" : "CLEAN    ") << ": \"" << test << "\"" << std::endl;
+            const std::string_view command = args.front();
+            const std::vector<std::string_view> options(args.begin() + 1, args.end());
+
+            if (command == "bench")
+            {
+                const BenchmarkConfig config = BenchmarkConfig::parse(options);
+                return EmailBenchmark::runConfigured(config, std::cout) ? 0 : 1;
+            }
 
-            if (found)
+            if (command == "scan")
             {
-                auto emails = scanner.extract(test);
-                std::cout << "  => Found emails: ";
-                for (const auto &email : emails)
+                const ScanConfig config = ScanConfig::parse(options);
+                const int status = ScanPipeline(config, std::cerr).run(std::cout);
+                if (config.domainCache)
                 {
-                    std::cout << email << " ";
+                    const DomainValidationCache::Stats stats = config.domainCache->getStats();
+                    std::cerr << "Domain cache: " << stats.getHitRate() * 100.0 << "% hits (" << stats.hits
+                              << " hits, " << stats.misses << " misses, " << stats.bypassed << " bypassed)\n";
                 }
-                std::cout << std::endl;
+                return status;
             }
-            std::cout << std::endl;
+
+            if (command == "index")
+            {
+                const IndexConfig config = IndexConfig::parse(options);
+                return runIndexBuild(config, std::cout);
+            }
+
+            if (command == "redact")
+            {
+                const RedactConfig config = RedactConfig::parse(options);
+                return RedactFilter(config, std::cerr).run(0, 1);
+            }
+
+            if (command == "test" && options.empty())
+            {
+                runCorrectnessTests();
+                return 0;
+            }
+
+            if (command == "help" || command == "--help" || command == "-h")
+            {
+                printUsage(std::cout);
+                return 0;
+            }
+
+            throw std::invalid_argument("unknown command '" + std::string(command) + "'");
         }
 
-        std::cout << std::string(100, '=') << std::endl;
-        std::cout << "✓ Email Detection Complete" << std::endl;
-        std::cout << std::string(100, '=') << std::endl;
+        runCorrectnessTests();
+        runDetectionDemo();
 
-        EmailValidatorTest::runPerformanceBenchmark();
+        const char *perfCounters = std::getenv("EMAIL_DETECTOR_PERF_COUNTERS");
+        EmailValidatorTest::runPerformanceBenchmark(perfCounters != nullptr && *perfCounters != '\0' &&
+                                                    *perfCounters != '0');
 
         std::cout << "\n"
                   << std::string(100, '=') << std::endl;
@@ -3050,6 +12995,12 @@ int main()
         std::cout << "  • Proper word boundary detection (no false positives)" << std::endl;
         std::cout << std::string(100, '=') << std::endl;
     }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n\n";
+        printUsage(std::cerr);
+        return 2;
+    }
     catch (const std::exception &e)
     {
         std::cerr << "Error: " << e.what() << std::endl;